@@ -0,0 +1,77 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "empyrical/alpha_beta.h"
+#include "empyrical/down_side_risk.h"
+#include "empyrical/excess_sharpe.h"
+#include "empyrical/stats.h"
+#include "empyrical/var.h"
+#include "epoch_folio/empyrical_all.h"
+#include "synthetic.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <format>
+
+using namespace epoch_folio;
+using namespace epoch_folio::bench;
+
+namespace {
+std::string Name(std::string_view label, int64_t rows, int64_t chunks) {
+  return std::format("{}/rows={}/chunks={}", label, rows, chunks);
+}
+} // namespace
+
+TEST_CASE("Empyrical Stats", "[benchmark][empyrical]") {
+  for (auto rows : BenchmarkRows()) {
+    for (auto chunks : BenchmarkChunks()) {
+      const auto returns = MakeReturns(rows, chunks);
+      const auto factors = MakeFactorReturns(rows, chunks);
+      const auto strategy = factors["strategy"];
+      const auto benchmark = factors["benchmark"];
+
+      for (auto const &[stat, func] : ep::get_simple_stats()) {
+        BENCHMARK(Name(ep::get_stat_name(stat), rows, chunks)) {
+          return func(returns);
+        };
+      }
+      for (auto const &[stat, func] : ep::get_factor_stats()) {
+        BENCHMARK(Name(ep::get_stat_name(stat), rows, chunks)) {
+          return func(factors);
+        };
+      }
+
+      // functors the tear sheet does not list in the stat tables
+      BENCHMARK(Name("AlphaBeta", rows, chunks)) {
+        return ep::AlphaBeta{}(factors);
+      };
+      BENCHMARK(Name("DownsideRisk", rows, chunks)) {
+        return ep::DownsideRisk{}(returns);
+      };
+      BENCHMARK(Name("ExcessSharpe", rows, chunks)) {
+        return ep::ExcessSharpe{}(strategy, benchmark);
+      };
+      BENCHMARK(Name("ValueAtRisk", rows, chunks)) {
+        return ep::ValueAtRisk{}(returns);
+      };
+      BENCHMARK(Name("ConditionalValueAtRisk", rows, chunks)) {
+        return ep::ConditionalValueAtRisk{}(returns);
+      };
+      BENCHMARK(Name("CumReturns", rows, chunks)) {
+        return ep::CumReturns(returns);
+      };
+      BENCHMARK(Name("DrawDownSeries", rows, chunks)) {
+        return ep::DrawDownSeries(returns);
+      };
+      for (auto period : {epoch_core::EmpyricalPeriods::weekly,
+                          epoch_core::EmpyricalPeriods::monthly,
+                          epoch_core::EmpyricalPeriods::yearly}) {
+        const auto label = std::format(
+            "AggregateReturns[{}]",
+            epoch_core::EmpyricalPeriodsWrapper::ToString(period));
+        BENCHMARK(Name(label, rows, chunks)) {
+          return ep::AggregateReturns(returns, period);
+        };
+      }
+    }
+  }
+}
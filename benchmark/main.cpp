@@ -0,0 +1,19 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include <arrow/compute/api.h>
+#include <catch2/catch_session.hpp>
+#include <sstream>
+#include <stdexcept>
+
+int main(int argc, char *argv[]) {
+  auto arrowComputeStatus = arrow::compute::Initialize();
+  if (!arrowComputeStatus.ok()) {
+    std::stringstream errorMsg;
+    errorMsg << "arrow compute initialized failed: " << arrowComputeStatus
+             << std::endl;
+    throw std::runtime_error(errorMsg.str());
+  }
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,74 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "empyrical/periods.h"
+#include "portfolio/pos.h"
+#include "portfolio/round_trip.h"
+#include "portfolio/timeseries.h"
+#include "portfolio/txn.h"
+#include "synthetic.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <format>
+
+using namespace epoch_folio;
+using namespace epoch_folio::bench;
+
+namespace {
+constexpr int64_t kAssets = 50;
+constexpr int64_t kWindow = 6 * ep::APPROX_BDAYS_PER_MONTH;
+
+std::string Name(std::string_view label, int64_t rows, int64_t chunks) {
+  return std::format("{}/rows={}/chunks={}", label, rows, chunks);
+}
+} // namespace
+
+TEST_CASE("Returns Helpers", "[benchmark][portfolio]") {
+  for (auto rows : BenchmarkRows()) {
+    for (auto chunks : BenchmarkChunks()) {
+      const auto returns = MakeReturns(rows, chunks);
+      const auto factors = MakeFactorReturns(rows, chunks);
+      const auto cumReturns = ep::CumReturns(returns, 1.0);
+
+      BENCHMARK(Name("RollingBeta", rows, chunks)) {
+        return RollingBeta(factors, kWindow);
+      };
+      BENCHMARK(Name("RollingVolatility", rows, chunks)) {
+        return RollingVolatility(returns, kWindow);
+      };
+      BENCHMARK(Name("RollingSharpe", rows, chunks)) {
+        return RollingSharpe(returns, kWindow);
+      };
+      BENCHMARK(Name("GetTopDrawDownsFromCumReturns", rows, chunks)) {
+        return GetTopDrawDownsFromCumReturns(cumReturns, 10);
+      };
+    }
+  }
+}
+
+// rows are days of positions, with as many transactions and round trips
+TEST_CASE("Positions And Trades", "[benchmark][portfolio]") {
+  const auto sectors = MakeSectorMapping(kAssets);
+  for (auto rows : BenchmarkRows()) {
+    for (auto chunks : BenchmarkChunks()) {
+      const auto positions = MakePositions(rows, kAssets, chunks);
+      const auto transactions = MakeTransactions(rows, rows, kAssets);
+      const auto roundTrips = MakeRoundTrips(rows, kAssets, chunks);
+
+      BENCHMARK(Name("GetTurnover[AGB]", rows, chunks)) {
+        return GetTurnover(positions, transactions,
+                           epoch_core::TurnoverDenominator::AGB);
+      };
+      BENCHMARK(Name("GetTurnover[PortfolioValue]", rows, chunks)) {
+        return GetTurnover(positions, transactions,
+                           epoch_core::TurnoverDenominator::PortfolioValue);
+      };
+      BENCHMARK(Name("GetSectorExposure", rows, chunks)) {
+        return GetSectorExposure(positions, sectors);
+      };
+      BENCHMARK(Name("GetRoundTripStats", rows, chunks)) {
+        return GetRoundTripStats(roundTrips, 25);
+      };
+    }
+  }
+}
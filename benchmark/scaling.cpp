@@ -0,0 +1,334 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+/*
+End-to-end scaling of MakeTearSheet over synthetic portfolios.
+
+  epoch_folio_scaling --days 252,2520 --assets 10,100 --trades 1000,100000
+                      [--sparsity 0.5] [--reps 3] [--output scaling.csv]
+                      [--baseline baseline.csv] [--tolerance 0.15]
+
+Every point of the days x assets x trades grid times the factory
+construction, the full tear sheet and each category on its own, the median of
+`reps` builds. Throughput counts position cells plus trades per second, the
+peak is the sampled peak of live arrow memory (see
+MemoryUsage::sampledPeakBytes), a lower bound of the true one.
+
+With --baseline, rows slower or larger than the baseline by more than
+`tolerance` are reported and the exit code is 1. Every baseline row must carry
+its measurements; grid points missing from the baseline are listed but do
+not fail the run.
+*/
+
+#include "common/memory_tracker.h"
+#include "epoch_folio/tearsheet.h"
+#include "synthetic.h"
+#include <algorithm>
+#include <arrow/compute/api.h>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+using namespace epoch_folio;
+
+namespace {
+struct ScalingOption {
+  std::vector<int64_t> days{252, 2'520};
+  std::vector<int64_t> assets{10, 100};
+  std::vector<int64_t> trades{1'000, 100'000};
+  double sparsity{0.5};
+  int reps{3};
+  std::string output{};
+  std::string baseline{};
+  double tolerance{0.15};
+};
+
+struct Sample {
+  int64_t days{};
+  int64_t assets{};
+  int64_t trades{};
+  std::string section;
+  double latencyMs{};
+  double cellsPerSecond{};
+  int64_t sampledPeakBytes{};
+};
+
+using SampleKey = std::tuple<int64_t, int64_t, int64_t, std::string>;
+
+constexpr std::string_view kHeader =
+    "days,assets,trades,section,latency_ms,cells_per_s,sampled_peak_bytes";
+
+template <typename T>
+T ParseNumber(std::string_view flag, std::string_view text) {
+  T result{};
+  auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), result);
+  if (ec != std::errc{} || end != text.data() + text.size()) {
+    throw std::runtime_error(std::format("invalid {} {}", flag, text));
+  }
+  return result;
+}
+
+std::vector<int64_t> ParseList(std::string_view flag, std::string_view text) {
+  std::vector<int64_t> values;
+  while (!text.empty()) {
+    const auto comma = text.find(',');
+    const auto value = ParseNumber<int64_t>(flag, text.substr(0, comma));
+    if (value <= 0) {
+      throw std::runtime_error(std::format("invalid {} {}", flag, value));
+    }
+    values.push_back(value);
+    text = comma == std::string_view::npos ? "" : text.substr(comma + 1);
+  }
+  return values;
+}
+
+ScalingOption ParseArgs(int argc, char **argv) {
+  ScalingOption option;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string_view flag{argv[i]};
+    const std::string_view value{argv[i + 1]};
+    if (flag == "--days") {
+      option.days = ParseList(flag, value);
+    } else if (flag == "--assets") {
+      option.assets = ParseList(flag, value);
+    } else if (flag == "--trades") {
+      option.trades = ParseList(flag, value);
+    } else if (flag == "--sparsity") {
+      option.sparsity = ParseNumber<double>(flag, value);
+    } else if (flag == "--reps") {
+      option.reps = std::max(ParseNumber<int>(flag, value), 1);
+    } else if (flag == "--output") {
+      option.output = value;
+    } else if (flag == "--baseline") {
+      option.baseline = value;
+    } else if (flag == "--tolerance") {
+      option.tolerance = ParseNumber<double>(flag, value);
+    } else {
+      throw std::runtime_error(std::format("unknown flag {}", flag));
+    }
+  }
+  return option;
+}
+
+int64_t PeakOf(TrackingMemoryPool const &pool, std::string_view scope) {
+  for (auto const &usage : pool.Report()) {
+    if (usage.scope == scope) {
+      return usage.sampledPeakBytes;
+    }
+  }
+  return 0;
+}
+
+double Median(std::vector<double> values) {
+  std::ranges::sort(values);
+  return values[values.size() / 2];
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// each build gets its own factory, a second MakeTearSheet on one factory
+// would reuse the widgets of the first
+std::vector<Sample> Measure(ScalingOption const &option,
+                            bench::SyntheticPortfolio const &shape) {
+  const auto data = bench::MakePortfolio(shape);
+  const auto cells = static_cast<double>(shape.days * shape.assets +
+                                         shape.trades);
+  auto sample = [&](std::string section, std::vector<double> latencies,
+                    int64_t peak) {
+    const auto latency = Median(std::move(latencies));
+    return Sample{.days = shape.days,
+                  .assets = shape.assets,
+                  .trades = shape.trades,
+                  .section = std::move(section),
+                  .latencyMs = latency,
+                  .cellsPerSecond = cells * 1e3 / latency,
+                  .sampledPeakBytes = peak};
+  };
+
+  std::vector<Sample> samples;
+  {
+    std::vector<double> latencies;
+    int64_t peak{};
+    for (int rep = 0; rep < option.reps; ++rep) {
+      TrackingMemoryPool pool;
+      {
+        InstallMemoryPool install{pool};
+        MemoryScope scope{"construct"};
+        const auto start = std::chrono::steady_clock::now();
+        PortfolioTearSheetFactory factory{data};
+        latencies.push_back(ElapsedMs(start));
+      }
+      peak = std::max(peak, PeakOf(pool, "construct"));
+    }
+    samples.push_back(sample("construct", std::move(latencies), peak));
+  }
+
+  const std::vector<std::string> sections{
+      "all",
+      categories::StrategyBenchmark,
+      categories::RiskAnalysis,
+      categories::ReturnsDistribution,
+      categories::Positions,
+      categories::Transactions,
+      categories::RoundTripPerformance,
+      categories::RoundTripAnalysis};
+  for (auto const &section : sections) {
+    std::vector<double> latencies;
+    int64_t peak{};
+    for (int rep = 0; rep < option.reps; ++rep) {
+      PortfolioTearSheetFactory factory{data};
+      TearSheetOption options;
+      if (section != "all") {
+        options.selection.categories = {section};
+      }
+      options.memoryTracker = std::make_shared<TrackingMemoryPool>();
+      const auto start = std::chrono::steady_clock::now();
+      (void)factory.MakeTearSheet(options);
+      latencies.push_back(ElapsedMs(start));
+      peak = std::max(peak, PeakOf(*options.memoryTracker, "tearsheet"));
+    }
+    samples.push_back(sample(section, std::move(latencies), peak));
+  }
+  return samples;
+}
+
+std::string ToCsv(Sample const &sample) {
+  return std::format("{},{},{},{},{:.3f},{:.0f},{}", sample.days,
+                     sample.assets, sample.trades, sample.section,
+                     sample.latencyMs, sample.cellsPerSecond,
+                     sample.sampledPeakBytes);
+}
+
+std::map<SampleKey, Sample> ReadBaseline(std::string const &path) {
+  std::ifstream file{path};
+  if (!file) {
+    throw std::runtime_error(std::format("cannot open baseline {}", path));
+  }
+  std::map<SampleKey, Sample> baseline;
+  std::string line;
+  std::getline(file, line);
+  if (line != kHeader) {
+    throw std::runtime_error(std::format("{} is not a scaling csv", path));
+  }
+  while (std::getline(file, line)) {
+    std::vector<std::string> fields;
+    std::stringstream stream{line};
+    for (std::string field; std::getline(stream, field, ',');) {
+      fields.push_back(field);
+    }
+    if (fields.size() != 7 ||
+        std::ranges::any_of(fields, [](auto const &f) { return f.empty(); })) {
+      throw std::runtime_error(std::format(
+          "bad baseline row '{}', every row needs its measurements", line));
+    }
+    Sample sample{ParseNumber<int64_t>("days", fields[0]),
+                  ParseNumber<int64_t>("assets", fields[1]),
+                  ParseNumber<int64_t>("trades", fields[2]),
+                  fields[3]};
+    sample.latencyMs = ParseNumber<double>("latency_ms", fields[4]);
+    sample.cellsPerSecond = ParseNumber<double>("cells_per_s", fields[5]);
+    sample.sampledPeakBytes =
+        ParseNumber<int64_t>("sampled_peak_bytes", fields[6]);
+    baseline.emplace(SampleKey{sample.days, sample.assets, sample.trades,
+                               sample.section},
+                     std::move(sample));
+  }
+  return baseline;
+}
+
+// rows over `tolerance` in latency or peak memory, rows missing from the
+// baseline are listed and skipped
+size_t Compare(std::vector<Sample> const &samples,
+               std::map<SampleKey, Sample> const &baseline,
+               double tolerance) {
+  size_t regressions = 0;
+  for (auto const &sample : samples) {
+    auto it = baseline.find(
+        {sample.days, sample.assets, sample.trades, sample.section});
+    if (it == baseline.end()) {
+      std::cout << std::format(
+          "NOT IN BASELINE days={} assets={} trades={} {}\n", sample.days,
+          sample.assets, sample.trades, sample.section);
+      continue;
+    }
+    auto const &base = it->second;
+    const bool slower = sample.latencyMs > base.latencyMs * (1 + tolerance);
+    const bool larger =
+        base.sampledPeakBytes > 0 &&
+        static_cast<double>(sample.sampledPeakBytes) >
+            static_cast<double>(base.sampledPeakBytes) * (1 + tolerance);
+    if (slower || larger) {
+      ++regressions;
+      std::cout << std::format(
+          "REGRESSION days={} assets={} trades={} {}: {:.3f} ms (was {:.3f}),"
+          " peak {} bytes (was {})\n",
+          sample.days, sample.assets, sample.trades, sample.section,
+          sample.latencyMs, base.latencyMs, sample.sampledPeakBytes,
+          base.sampledPeakBytes);
+    }
+  }
+  return regressions;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto arrowComputeStatus = arrow::compute::Initialize();
+  if (!arrowComputeStatus.ok()) {
+    std::stringstream errorMsg;
+    errorMsg << "arrow compute initialized failed: " << arrowComputeStatus
+             << std::endl;
+    throw std::runtime_error(errorMsg.str());
+  }
+
+  try {
+    const auto option = ParseArgs(argc, argv);
+    std::vector<Sample> samples;
+    std::cout << kHeader << '\n';
+    for (auto days : option.days) {
+      for (auto assets : option.assets) {
+        for (auto trades : option.trades) {
+          for (auto &sample :
+               Measure(option, {.days = days,
+                                .assets = assets,
+                                .sparsity = option.sparsity,
+                                .trades = trades})) {
+            std::cout << ToCsv(sample) << std::endl;
+            samples.push_back(std::move(sample));
+          }
+        }
+      }
+    }
+
+    if (!option.output.empty()) {
+      std::ofstream file{option.output};
+      file << kHeader << '\n';
+      for (auto const &sample : samples) {
+        file << ToCsv(sample) << '\n';
+      }
+    }
+    if (!option.baseline.empty()) {
+      const auto regressions =
+          Compare(samples, ReadBaseline(option.baseline), option.tolerance);
+      std::cout << std::format("{} regression(s) against {}\n", regressions,
+                               option.baseline);
+      return regressions == 0 ? 0 : 1;
+    }
+  } catch (std::exception const &e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,317 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "synthetic.h"
+#include "common/series_helper.h"
+#include "portfolio/round_trip.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <epoch_frame/factory/index_factory.h>
+#include <format>
+#include <numbers>
+#include <stdexcept>
+#include <string_view>
+
+namespace epoch_folio::bench {
+namespace {
+constexpr int64_t kDayNs = 86'400'000'000'000;
+constexpr int64_t kMinuteNs = 60'000'000'000;
+constexpr int64_t kStartNs = 946'684'800'000'000'000; // 2000-01-01
+constexpr int64_t kMaxDailyRows = 100'000;
+
+// splitmix64 with a Box-Muller normal, unlike <random> distributions the
+// sequence does not depend on the standard library
+class Rng {
+public:
+  explicit Rng(uint64_t seed) : m_state(seed) {}
+
+  uint64_t Next() {
+    uint64_t z = (m_state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  // [0, 1)
+  double Uniform() { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+
+  double Normal(double mean, double stddev) {
+    const double u = 1.0 - Uniform();
+    const double v = Uniform();
+    return mean + stddev * std::sqrt(-2.0 * std::log(u)) *
+                      std::cos(2.0 * std::numbers::pi * v);
+  }
+
+private:
+  uint64_t m_state;
+};
+
+std::vector<int64_t> ParseList(const char *name,
+                               std::vector<int64_t> fallback) {
+  const char *env = std::getenv(name);
+  if (env == nullptr || *env == '\0') {
+    return fallback;
+  }
+  std::vector<int64_t> values;
+  std::string_view text{env};
+  while (!text.empty()) {
+    const auto comma = text.find(',');
+    const auto item = text.substr(0, comma);
+    int64_t value{};
+    auto [end, ec] =
+        std::from_chars(item.data(), item.data() + item.size(), value);
+    if (ec != std::errc{} || end != item.data() + item.size() || value <= 0) {
+      throw std::runtime_error(std::format("{}: bad entry '{}'", name, item));
+    }
+    values.push_back(value);
+    text = comma == std::string_view::npos ? "" : text.substr(comma + 1);
+  }
+  return values;
+}
+
+int64_t StepNs(int64_t rows) {
+  return rows <= kMaxDailyRows ? kDayNs : kMinuteNs;
+}
+
+template <typename Builder, typename Fn>
+arrow::ArrayPtr Build(Builder builder, int64_t rows, Fn &&value) {
+  ThrowIfNotOk(builder.Reserve(rows));
+  for (int64_t i = 0; i < rows; ++i) {
+    builder.UnsafeAppend(value(i));
+  }
+  return builder.Finish().ValueOrDie();
+}
+
+arrow::ArrayPtr Doubles(int64_t rows, auto &&value) {
+  return Build(arrow::DoubleBuilder{}, rows, value);
+}
+
+arrow::ArrayPtr Symbols(int64_t rows, auto &&symbol) {
+  arrow::StringBuilder builder;
+  for (int64_t i = 0; i < rows; ++i) {
+    ThrowIfNotOk(builder.Append(std::format("A{:05}", symbol(i))));
+  }
+  return builder.Finish().ValueOrDie();
+}
+} // namespace
+
+std::vector<int64_t> BenchmarkRows() {
+  return ParseList("EPOCH_FOLIO_BENCH_ROWS", {1'000, 10'000, 100'000});
+}
+
+std::vector<int64_t> BenchmarkChunks() {
+  return ParseList("EPOCH_FOLIO_BENCH_CHUNKS", {1, 16});
+}
+
+arrow::ChunkedArrayPtr Chunked(arrow::ArrayPtr const &array, int64_t chunks) {
+  const auto length = array->length();
+  chunks = std::clamp<int64_t>(chunks, 1, std::max<int64_t>(length, 1));
+  arrow::ArrayVector slices;
+  slices.reserve(chunks);
+  for (int64_t i = 0; i < chunks; ++i) {
+    const auto begin = length * i / chunks;
+    const auto end = length * (i + 1) / chunks;
+    slices.push_back(array->Slice(begin, end - begin));
+  }
+  return std::make_shared<arrow::ChunkedArray>(std::move(slices),
+                                               array->type());
+}
+
+arrow::ArrayPtr MakeTimestamps(int64_t rows) {
+  const auto step = StepNs(rows);
+  return Build(
+      arrow::TimestampBuilder{arrow::timestamp(arrow::TimeUnit::NANO, "UTC"),
+                              arrow::default_memory_pool()},
+      rows, [step](int64_t i) { return kStartNs + i * step; });
+}
+
+epoch_frame::DataFrame MakeFrame(std::vector<arrow::ArrayPtr> const &columns,
+                                 std::vector<std::string> const &names,
+                                 int64_t chunks) {
+  const auto rows = columns.empty() ? 0 : columns.front()->length();
+  arrow::FieldVector fields{
+      arrow::field("index", arrow::timestamp(arrow::TimeUnit::NANO, "UTC"))};
+  std::vector<arrow::ChunkedArrayPtr> data{
+      Chunked(MakeTimestamps(rows), chunks)};
+  for (size_t i = 0; i < columns.size(); ++i) {
+    fields.push_back(arrow::field(names.at(i), columns[i]->type()));
+    data.push_back(Chunked(columns[i], chunks));
+  }
+  auto table = arrow::Table::Make(arrow::schema(fields), data, rows);
+  epoch_frame::DataFrame frame{
+      epoch_frame::factory::index::from_range(rows), table};
+  return frame.set_index("index");
+}
+
+epoch_frame::Series MakeReturns(int64_t rows, int64_t chunks, uint64_t seed) {
+  Rng rng{seed};
+  return MakeFrame(
+             {Doubles(rows, [&](int64_t) { return rng.Normal(5e-4, 0.01); })},
+             {"returns"}, chunks)
+      .to_series();
+}
+
+epoch_frame::DataFrame MakeFactorReturns(int64_t rows, int64_t chunks,
+                                         uint64_t seed) {
+  Rng rng{seed};
+  std::vector<double> benchmark(rows);
+  auto benchmarkArray = Doubles(rows, [&](int64_t i) {
+    benchmark[i] = rng.Normal(3e-4, 0.008);
+    return benchmark[i];
+  });
+  auto strategyArray = Doubles(rows, [&](int64_t i) {
+    return 1e-4 + 0.8 * benchmark[i] + rng.Normal(0, 0.005);
+  });
+  return MakeFrame({strategyArray, benchmarkArray}, {"strategy", "benchmark"},
+                   chunks);
+}
+
+epoch_frame::DataFrame MakePositions(int64_t rows, int64_t assets,
+                                     int64_t chunks, uint64_t seed) {
+  Rng rng{seed};
+  std::vector<arrow::ArrayPtr> columns;
+  std::vector<std::string> names;
+  for (int64_t a = 0; a < assets; ++a) {
+    // a random walk in [-1e5, 1e5], long and short
+    double value = rng.Normal(0, 5e4);
+    columns.push_back(Doubles(rows, [&](int64_t) {
+      value = std::clamp(value + rng.Normal(0, 1e3), -1e5, 1e5);
+      return value;
+    }));
+    names.push_back(std::format("A{:05}", a));
+  }
+  columns.push_back(Doubles(rows, [&](int64_t) { return 1e5; }));
+  names.emplace_back("cash");
+  return MakeFrame(columns, names, chunks);
+}
+
+epoch_frame::DataFrame MakeTransactions(int64_t rows, int64_t days,
+                                        int64_t assets, uint64_t seed) {
+  Rng rng{seed};
+  const auto span = days * StepNs(days);
+  std::vector<int64_t> symbols(rows);
+  auto timestamps = Build(
+      arrow::TimestampBuilder{arrow::timestamp(arrow::TimeUnit::NANO, "UTC"),
+                              arrow::default_memory_pool()},
+      rows, [&](int64_t i) { return kStartNs + i * (span / rows); });
+  auto sid = Build(arrow::Int32Builder{}, rows, [&](int64_t i) {
+    symbols[i] =
+        static_cast<int64_t>(rng.Next() % static_cast<uint64_t>(assets));
+    return static_cast<int32_t>(symbols[i]);
+  });
+  auto amount = Doubles(rows, [&](int64_t) {
+    return std::round(rng.Normal(0, 100));
+  });
+  auto price = Doubles(rows, [&](int64_t) { return 50 + 100 * rng.Uniform(); });
+  auto symbol = Symbols(rows, [&](int64_t i) { return symbols[i]; });
+
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("index", timestamps->type()),
+                     arrow::field("sid", arrow::int32()),
+                     arrow::field("amount", arrow::float64()),
+                     arrow::field("price", arrow::float64()),
+                     arrow::field("symbol", arrow::utf8())}),
+      {timestamps, sid, amount, price, symbol});
+  epoch_frame::DataFrame frame{
+      epoch_frame::factory::index::from_range(rows), table};
+  return frame.set_index("index");
+}
+
+epoch_frame::DataFrame MakeRoundTrips(int64_t rows, int64_t assets,
+                                      int64_t chunks, uint64_t seed) {
+  Rng rng{seed};
+  std::vector<double> returns(rows);
+  auto returnsArray = Doubles(rows, [&](int64_t i) {
+    returns[i] = rng.Normal(0.002, 0.03);
+    return returns[i];
+  });
+  auto pnl = Doubles(rows, [&](int64_t i) {
+    return returns[i] * (1e3 + 1e4 * rng.Uniform());
+  });
+  // nanoseconds, up to twenty days
+  auto duration = Doubles(rows, [&](int64_t) {
+    return std::floor(rng.Uniform() * 20 * static_cast<double>(kDayNs));
+  });
+  auto isLong = Build(arrow::BooleanBuilder{}, rows,
+                      [&](int64_t) { return rng.Uniform() < 0.6; });
+  auto symbol = Symbols(rows, [&](int64_t) {
+    return static_cast<int64_t>(rng.Next() % static_cast<uint64_t>(assets));
+  });
+  return MakeFrame({pnl, returnsArray, duration, isLong, symbol},
+                   {"pnl", "returns", "duration", "long", "symbol"}, chunks);
+}
+
+SectorMapping MakeSectorMapping(int64_t assets) {
+  static constexpr std::array kSectors{"Technology", "Financials", "Energy",
+                                       "Health Care", "Industrials"};
+  SectorMapping mapping;
+  for (int64_t a = 0; a < assets; ++a) {
+    mapping.emplace(std::format("A{:05}", a), kSectors[a % kSectors.size()]);
+  }
+  return mapping;
+}
+
+TearSheetDataOption MakePortfolio(SyntheticPortfolio const &shape) {
+  const auto days = shape.days;
+  // one stream per input so that changing a dimension leaves the others as is
+  Rng rng{shape.seed + 1};
+
+  const auto factors = MakeFactorReturns(days, 1, shape.seed);
+  const auto strategy = ToDoubleVector(factors["strategy"].array());
+  std::vector<double> equity(days);
+  double value = 1e6;
+  for (int64_t i = 0; i < days; ++i) {
+    value *= 1.0 + strategy[i];
+    equity[i] = value;
+  }
+
+  // two state chain per asset, entered with 0.1 (1 - sparsity) and left
+  // with 0.1 sparsity, so `sparsity` of the asset-days hold nothing
+  const auto enter = 0.1 * (1.0 - shape.sparsity);
+  const auto exit = 0.1 * shape.sparsity;
+  const auto budget =
+      1.0 / static_cast<double>(std::max<int64_t>(shape.assets, 1));
+  std::vector<double> invested(days, 0.0);
+  std::vector<arrow::ArrayPtr> columns;
+  std::vector<std::string> names;
+  for (int64_t a = 0; a < shape.assets; ++a) {
+    bool held = rng.Uniform() >= shape.sparsity;
+    double weight = 0;
+    columns.push_back(Doubles(days, [&](int64_t i) {
+      const bool was = held;
+      held = rng.Uniform() < (held ? 1.0 - exit : enter);
+      if (held && !was) {
+        weight = budget * (rng.Uniform() < 0.7 ? 1.0 : -1.0) *
+                 (0.5 + rng.Uniform());
+      }
+      const auto position = held ? weight * equity[i] : 0.0;
+      invested[i] += position;
+      return position;
+    }));
+    names.push_back(std::format("A{:05}", a));
+  }
+
+  TearSheetDataOption data;
+  data.equity = MakeFrame({Doubles(days, [&](int64_t i) { return equity[i]; })},
+                          {"equity"}, 1)
+                    .to_series();
+  data.benchmark = factors["benchmark"];
+  data.cash = MakeFrame({Doubles(days, [&](int64_t i) {
+                          return equity[i] - invested[i];
+                        })},
+                        {"cash"}, 1)
+                  .to_series();
+  data.positions = MakeFrame(columns, names, 1);
+  data.transactions = MakeTransactions(shape.trades, days,
+                                       std::max<int64_t>(shape.assets, 1),
+                                       shape.seed + 2);
+  data.roundTrip = ExtractRoundTripsFromTransactions(data.transactions);
+  data.sectorMapping = MakeSectorMapping(shape.assets);
+  data.isEquity = true;
+  return data;
+}
+} // namespace epoch_folio::bench
@@ -0,0 +1,71 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include "portfolio/model.h"
+#include <arrow/api.h>
+#include <cstdint>
+#include <vector>
+
+// Seeded inputs for the benchmarks, identical across runs and machines.
+namespace epoch_folio::bench {
+// EPOCH_FOLIO_BENCH_ROWS, comma separated, default 1000,10000,100000; pass
+// up to 100000000 for the large end of the grid
+std::vector<int64_t> BenchmarkRows();
+
+// EPOCH_FOLIO_BENCH_CHUNKS, default 1,16
+std::vector<int64_t> BenchmarkChunks();
+
+// splits `array` into `chunks` zero-copy slices
+arrow::ChunkedArrayPtr Chunked(arrow::ArrayPtr const &array, int64_t chunks);
+
+// daily UTC timestamps from 2000-01-01, minutes past 100k rows so that every
+// size stays inside the nanosecond range
+arrow::ArrayPtr MakeTimestamps(int64_t rows);
+
+// frame over `columns` indexed by MakeTimestamps, every column in `chunks`
+epoch_frame::DataFrame MakeFrame(std::vector<arrow::ArrayPtr> const &columns,
+                                 std::vector<std::string> const &names,
+                                 int64_t chunks);
+
+// daily returns with a small drift, N(0.0005, 0.01)
+epoch_frame::Series MakeReturns(int64_t rows, int64_t chunks,
+                                uint64_t seed = 1);
+
+// "strategy" and a correlated "benchmark" column, the factor stats' input
+epoch_frame::DataFrame MakeFactorReturns(int64_t rows, int64_t chunks,
+                                         uint64_t seed = 1);
+
+// position values of `assets` symbols plus "cash"
+epoch_frame::DataFrame MakePositions(int64_t rows, int64_t assets,
+                                     int64_t chunks, uint64_t seed = 1);
+
+// `rows` fills (sid, amount, price, symbol) spread over `days` days
+epoch_frame::DataFrame MakeTransactions(int64_t rows, int64_t days,
+                                        int64_t assets, uint64_t seed = 1);
+
+// extracted round trips: pnl, returns, duration, long, symbol
+epoch_frame::DataFrame MakeRoundTrips(int64_t rows, int64_t assets,
+                                      int64_t chunks, uint64_t seed = 1);
+
+// symbols of MakePositions spread over a few sectors
+SectorMapping MakeSectorMapping(int64_t assets);
+
+struct SyntheticPortfolio {
+  int64_t days{252};
+  int64_t assets{20};
+  // share of asset-days without a position, holdings come in runs
+  double sparsity{0.5};
+  int64_t trades{1'000};
+  uint64_t seed{1};
+};
+
+/*
+Every input of a tear sheet: an equity curve and a correlated benchmark,
+sparse long/short positions with cash making up the rest of the equity,
+`trades` fills over the same days, the round trips matched from them and a
+sector mapping.
+*/
+TearSheetDataOption MakePortfolio(SyntheticPortfolio const &shape);
+} // namespace epoch_folio::bench
@@ -0,0 +1,51 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <functional>
+#include <optional>
+#include <span>
+
+#include "epoch_folio/tearsheet.h"
+
+namespace epoch_folio
+{
+  struct BatchTearSheetOption
+  {
+    TearSheetOption tearSheet{};
+    // strategies built at the same time, bounds peak memory; 0 = one per core
+    int maxConcurrency{0};
+  };
+
+  /*
+  Builds tear sheets for many strategies against one benchmark. The benchmark
+  is aligned once per distinct strategy index, and its cumulative returns,
+  interesting date ranges, rolling Sharpe and rolling volatility are derived
+  once per alignment; strategies with nulls in their returns or with extra
+  benchmarks align on their own. Every tear sheet equals the one a
+  PortfolioTearSheetFactory builds for the strategy alone. Strategies run on
+  a TBB arena limited to maxConcurrency, and each tear sheet goes to the
+  callback as soon as it is finished, so at most maxConcurrency of them are
+  held in memory.
+  */
+  class BatchTearSheetRunner
+  {
+  public:
+    // called once per successful strategy, never concurrently, in completion
+    // order; `index` is the position of the strategy in the batch
+    using Callback =
+        std::function<void(size_t index, epoch_proto::TearSheet &&tearSheet)>;
+
+    BatchTearSheetRunner(std::optional<epoch_frame::Series> const &benchmark,
+                         BatchTearSheetOption options);
+
+    // the strategies' own benchmark fields are ignored
+    void Run(std::span<const TearSheetDataOption> strategies,
+             Callback const &onTearSheet) const;
+
+  private:
+    std::optional<epoch_frame::Series> m_benchmark;
+    BatchTearSheetOption m_options;
+  };
+} // namespace epoch_folio
@@ -0,0 +1,61 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "portfolio/model.h"
+
+namespace epoch_folio
+{
+  // One input table on disk: Arrow IPC (.arrow, .feather, .ipc) or Parquet
+  // (.parquet), picked by extension.
+  struct TableSource
+  {
+    std::string path;
+    // timestamp (or int64 epoch nanoseconds) column the rows are sorted by,
+    // used for the time range and, with setIndex, as the index
+    std::string timeColumn{"index"};
+    bool setIndex{true};
+    // columns to load besides timeColumn, empty loads every column
+    std::vector<std::string> columns{};
+    // source name -> name the tear sheet expects, e.g. {"pnl", "net_return"}
+    std::unordered_map<std::string, std::string> rename{};
+  };
+
+  struct TearSheetSources
+  {
+    // for the series inputs `columns` names the single value column
+    TableSource equity;
+    std::optional<TableSource> benchmark{};
+    std::optional<TableSource> cash{};
+    std::optional<TableSource> positions{};
+    std::optional<TableSource> transactions{};
+    // e.g. timeColumn "close_datetime" with setIndex false
+    std::optional<TableSource> roundTrip{};
+    // [start, end) in UTC epoch nanoseconds
+    std::optional<int64_t> start{};
+    std::optional<int64_t> end{};
+  };
+
+  /*
+  Loads a table through a memory map. Only the projected columns are decoded:
+  Parquet row groups and IPC record batches wholly outside [start, end) are
+  skipped using the row group statistics and batch bounds, and the rest is
+  sliced in place. IPC buffers stay in the mapping. Timestamps already in
+  nanoseconds UTC are used as they are, int64 epoch nanoseconds are viewed as
+  timestamps, and other units or zones are cast once. Parquet files may hold
+  nested columns as long as none of them is projected.
+  */
+  epoch_frame::DataFrame LoadTable(TableSource const &source,
+                                   std::optional<int64_t> start = std::nullopt,
+                                   std::optional<int64_t> end = std::nullopt);
+
+  // builds every input of the tear sheet from `sources`, see LoadTable
+  TearSheetDataOption LoadTearSheetData(TearSheetSources const &sources);
+} // namespace epoch_folio
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -15,6 +16,16 @@
 
 namespace epoch_folio {
 
+// Tear sheet of one reporter execution, shared read-only between readers
+using TearSheetHandle = std::shared_ptr<const epoch_proto::TearSheet>;
+
+// Everything one execution produces: the normalized frame handed on to the
+// graph and the tear sheet built from it
+struct ReportOutput {
+  epoch_frame::DataFrame data;
+  TearSheetHandle tearsheet;
+};
+
 // IReporter extends ITransform to add TearSheet generation capability
 // Following the TradeExecutorTransform pattern for column mapping
 class IReporter : public epoch_metadata::transform::ITransform {
@@ -26,8 +37,19 @@ public:
     BuildColumnMappings();
   }
 
-  // TransformData normalizes column names and generates TearSheet
+  // TransformData normalizes column names and generates TearSheet, then
+  // publishes it for the deprecated GetTearSheet. Callers that need the tear
+  // sheet use Report instead
   epoch_frame::DataFrame TransformData(const epoch_frame::DataFrame &df) const override {
+    auto output = Report(df);
+    m_tearsheet.store(std::move(output.tearsheet), std::memory_order_release);
+    return std::move(output.data);
+  }
+
+  // The way to get a tear sheet. Re-entrant: the result belongs to this
+  // invocation only, so graphs and assets running the same instance
+  // concurrently never see each other's tear sheet
+  ReportOutput Report(const epoch_frame::DataFrame &df) const {
     // 1. Get expected columns from configuration inputs
     std::vector<std::string> inputColumns;
     for (const auto& [inputId, columns] : m_config.GetInputs()) {
@@ -39,38 +61,45 @@ public:
 
     if (inputColumns.empty()) {
       // No inputs configured, return empty DataFrame
-      return epoch_frame::DataFrame(
-          df.index(),
-          arrow::Table::MakeEmpty(arrow::schema(arrow::FieldVector{}))
-              .MoveValueUnsafe());
+      return {epoch_frame::DataFrame(
+                  df.index(),
+                  arrow::Table::MakeEmpty(arrow::schema(arrow::FieldVector{}))
+                      .MoveValueUnsafe()),
+              EmptyTearSheet()};
     }
 
     // 2. Rename columns to canonical names (e.g., "gap_classifier#result" -> "gap")
     // This follows TradeExecutorTransform pattern
     auto normalizedDf = df[inputColumns].rename(m_columnMappings);
 
-    // 3. Child classes implement generateTearsheet() to fill m_tearsheet
-    generateTearsheet(normalizedDf);
+    // 3. Child classes implement generateTearsheet() to build this
+    // invocation's TearSheet
+    auto tearsheet = std::make_shared<const epoch_proto::TearSheet>(
+        generateTearsheet(normalizedDf));
 
     // 4. Return normalized DataFrame (computation graph expects DataFrame output)
-    return normalizedDf;
+    return {std::move(normalizedDf), std::move(tearsheet)};
   }
 
-  // Public getter for the generated TearSheet
-  epoch_proto::TearSheet GetTearSheet() const {
-    return m_tearsheet;
+  // TearSheet of the latest TransformData to finish, empty before the first.
+  // Last writer wins: with executions running concurrently it may belong to
+  // any of them, so it cannot be matched to an input
+  [[deprecated("races between concurrent executions, use Report")]]
+  TearSheetHandle GetTearSheet() const {
+    return m_tearsheet.load(std::memory_order_acquire);
   }
 
   // Public method for testing that bypasses transform input validation
-  void generateTearsheetForTesting(const epoch_frame::DataFrame &normalizedDf) const {
-    generateTearsheet(normalizedDf);
+  epoch_proto::TearSheet generateTearsheetForTesting(const epoch_frame::DataFrame &normalizedDf) const {
+    return generateTearsheet(normalizedDf);
   }
 
   virtual ~IReporter() = default;
 
 protected:
-  // Child classes only need to implement this to fill m_tearsheet
-  virtual void generateTearsheet(const epoch_frame::DataFrame &normalizedDf) const = 0;
+  // Child classes only need to implement this. It may run concurrently on
+  // one instance, so results go in the returned TearSheet, not in members
+  virtual epoch_proto::TearSheet generateTearsheet(const epoch_frame::DataFrame &normalizedDf) const = 0;
 
   void BuildColumnMappings() {
     // Similar to TradeExecutorTransform constructor
@@ -89,7 +118,14 @@ protected:
     }
   }
 
-  mutable epoch_proto::TearSheet m_tearsheet;  // Mutable since generateTearsheet is const
+  static TearSheetHandle EmptyTearSheet() {
+    static const TearSheetHandle empty =
+        std::make_shared<const epoch_proto::TearSheet>();
+    return empty;
+  }
+
+  // Mutable since TransformData is const, only ever swapped atomically
+  mutable std::atomic<TearSheetHandle> m_tearsheet{EmptyTearSheet()};
   std::unordered_map<std::string, std::string> m_columnMappings;
 };
 
@@ -3,8 +3,13 @@
 //
 
 #pragma once
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
 
+#include "common/columnar_json.h"
 #include "portfolio/model.h"
 #include <epoch_protos/tearsheet.pb.h>
 
@@ -26,23 +31,159 @@ namespace epoch_folio
     constexpr const char *Transactions = "Transactions";
     constexpr const char *RoundTripPerformance = "Round Trip Performance";
     constexpr const char *RoundTripAnalysis = "Round Trip Analysis";
+    constexpr const char *Memory = "Memory";
   } // namespace categories
 
+  class TearSheetDiskCache;
+
+  struct MemoryBudget
+  {
+    // bytes a build may keep resident
+    uint64_t bytes{4ULL << 30};
+    // where oversize inputs are spilled, the system temp directory if empty
+    std::string spillDirectory{};
+  };
+
+  struct TearSheetExportOption
+  {
+    std::string directory;
+    // points per line chart kept in the protobuf skeleton, 0 = every point
+    size_t previewPoints{500};
+  };
+
+  // the strategy returns every section of the tear sheet is built from,
+  // `options.equity` itself unless it holds an equity curve
+  epoch_frame::Series StrategyReturns(TearSheetDataOption const &options);
+
   class PortfolioTearSheetFactory
   {
 
   public:
-    explicit PortfolioTearSheetFactory(TearSheetDataOption const &options);
+    // `sharedBenchmark` replaces options.benchmark with benchmark series
+    // derived once for many strategies, see BatchTearSheetRunner
+    explicit PortfolioTearSheetFactory(
+        TearSheetDataOption const &options,
+        returns::SharedBenchmark sharedBenchmark = nullptr);
+    PortfolioTearSheetFactory(PortfolioTearSheetFactory &&) noexcept;
+    PortfolioTearSheetFactory &operator=(PortfolioTearSheetFactory &&) noexcept;
+    ~PortfolioTearSheetFactory();
 
     epoch_proto::TearSheet MakeTearSheet(TearSheetOption const &) const;
 
+    /*
+    Builds on the factory's TBB arena, which runs at most one build per core
+    and queues the rest; dropping the future neither blocks nor stops the
+    build. `token` and `deadline` are checked before the build starts and
+    before each widget, so a cancelled build stops within one widget and the
+    future throws BuildCancelled. `onWidget` streams each widget as it
+    finishes, for progressive rendering; a tear sheet found whole in the disk
+    cache resolves the future without callbacks. The factory waits for its
+    builds when destroyed and before Append, UseDiskCache or UseMemoryBudget
+    change it, so never call those from `onWidget`.
+    */
+    std::future<epoch_proto::TearSheet>
+    MakeTearSheetAsync(TearSheetOption const &options,
+                       CancellationToken token = {},
+                       std::optional<Deadline> deadline = std::nullopt,
+                       WidgetCallback onWidget = {}) const;
+
+    // Writes the dashboard to <directory>/tearsheet.pb with its line charts
+    // decimated to previewPoints, and the full resolution data of the large
+    // widgets (cumulative returns, rolling stats, allocations, the extracted
+    // round trips under "xrange") to <directory>/<widget id>.arrow as Arrow
+    // IPC files, see MapWidgetSeries. Both come from one build, so the files
+    // hold the very frames the charts were drawn from. The widget selection
+    // applies to both.
+    void Export(TearSheetOption const &options,
+                TearSheetExportOption const &exportOption) const;
+
+    /*
+    Appends new rows (bars, trades, round trips) to the inputs. The next
+    MakeTearSheet with unchanged options reuses every widget of the previous
+    build that reads none of the appended inputs and matches a build over the
+    merged inputs from scratch.
+
+    Widget reuse is the whole of the incremental mode: a widget that reads an
+    appended input is recomputed over the full history, as no section keeps
+    running state (cumulative returns, rolling windows, drawdown episodes), so
+    a nightly equity append still costs O(history) for every returns and
+    round trip widget. The reused widgets live in this factory only.
+    */
+    void Append(TearSheetDataOption const &delta);
+
+    // Persists every built widget and tear sheet in `cache`, addressed by a
+    // hash of the input buffers and the options. Builds over the same data,
+    // in this or another process, read them back instead of recomputing, and
+    // one with another selection only computes the widgets not stored yet.
+    // The drawdown episodes, rolling series and round trips are stored too,
+    // keyed by only the options they read, so e.g. a build with another
+    // maxChartPoints redraws its charts without recomputing them.
+    void UseDiskCache(std::shared_ptr<TearSheetDiskCache> cache);
+
+    /*
+    Keeps the raw inputs of later builds within half of the budget. The
+    largest inputs (positions, transactions, round trips) are spilled to Arrow
+    IPC files and mapped back until those still in memory fit; mapped pages are
+    read on demand and can be dropped again by the kernel. Builds then run
+    serially, each intermediate computed right before its consumers and
+    released after the last one. The caller's own copies of the inputs keep
+    their memory, drop them after this call.
+
+    Only the raw inputs are spilled. The other half of the budget is headroom
+    for the build's working set, which stays in memory: the returns, cash and
+    benchmark inputs, the derived frames (cumulative and rolling series,
+    position allocations and exposures, matched round trips) and the
+    temporaries of the widget running. At any time that is the frames of one
+    widget plus the intermediates still waiting for a consumer. Nothing checks
+    that they fit: memoryTracker reports the sampled peak of each widget, a
+    lower bound of the true one.
+    */
+    void UseMemoryBudget(MemoryBudget budget);
+
+    // widget_inputs of the inputs UseMemoryBudget serves from spill files
+    uint8_t SpilledInputs() const
+    {
+      return m_spilledInputs;
+    }
+
   private:
+    struct BuildCache;
+    struct AsyncBuilds;
+
+    // schedules, selects and runs (or reuses) every widget of the build,
+    // throws BuildCancelled when `control` expires
+    void BuildWidgets(WidgetGraph &graph, TearSheetOption const &options,
+                      RunControl const &control = {}) const;
+
+    epoch_proto::TearSheet Build(TearSheetOption const &options,
+                                 RunControl const &control) const;
+
+    TearSheetDataOption m_data;
+    returns::SharedBenchmark m_sharedBenchmark;
     epoch_frame::Series m_returns;
     epoch_frame::DataFrame m_positions;
     returns::TearSheetFactory m_returnsFactory;
     positions::TearSheetFactory m_positionsFactory;
     txn::TearSheetFactory m_transactionsFactory;
     round_trip::TearSheetFactory m_roundTripFactory;
+    std::unique_ptr<BuildCache> m_cache;
+    std::shared_ptr<TearSheetDiskCache> m_diskCache;
+
+    std::optional<MemoryBudget> m_memoryBudget;
+    // widget_inputs of the frames already served from a spill file
+    uint8_t m_spilledInputs{0};
+    // declared last, so builds in flight finish before any member goes
+    std::unique_ptr<AsyncBuilds> m_async;
+
+    // key of the whole tear sheet in m_diskCache
+    std::string SheetKey(TearSheetOption const &options) const;
+
+    // spills `candidates` (widget_inputs) as m_memoryBudget requires and
+    // rebuilds the section factories over the mapped frames
+    void SpillInputs(uint8_t candidates);
+
+    // blocks until every MakeTearSheetAsync build of this factory is done
+    void WaitForAsyncBuilds() const;
   };
 
   std::string write_protobuf(epoch_proto::TearSheet const &output);
@@ -54,55 +195,46 @@ namespace glz
 {
   generic to_json(const epoch_frame::Scalar &array);
 
+  namespace detail
+  {
+    // builds the columnar json in an intermediate string and writes it
+    // through raw_json_view, so glaze manages the output buffer of any type
+    template <auto Opts>
+    void WriteColumnarJson(auto const &value, auto &&ctx, auto &&b,
+                           auto &&ix) noexcept
+    {
+      std::string json;
+      epoch_folio::AppendJson(value, json);
+      serialize<JSON>::op<Opts>(raw_json_view{json}, ctx, b, ix);
+    }
+  } // namespace detail
+
   template <>
   struct to<JSON, arrow::TablePtr>
   {
-    template <auto Opts>
-    static void op(const arrow::TablePtr &table, auto &&...args) noexcept
+    template <auto Opts, class B>
+    static void op(const arrow::TablePtr &table, auto &&ctx, B &&b,
+                   auto &&ix) noexcept
     {
-      std::vector<generic> json_obj;
-      if (!table)
+      if (table)
       {
-        serialize<JSON>::op<Opts>(json_obj, args...);
-        return;
+        detail::WriteColumnarJson<Opts>(*table, ctx, b, ix);
       }
-
-      json_obj.reserve(table->num_rows());
-      const auto column_names = table->ColumnNames();
-      const auto columns = table->columns();
-
-      auto col_range = std::views::iota(0, static_cast<int>(columns.size()));
-      auto row_range = std::views::iota(0, static_cast<int>(table->num_rows()));
-
-      for (size_t row : row_range)
+      else
       {
-        generic row_obj;
-        for (size_t col : col_range)
-        {
-          const auto col_name = column_names[col];
-          const auto scalar = columns[col]->GetScalar(row).MoveValueUnsafe();
-          row_obj[col_name] = to_json(epoch_frame::Scalar{scalar});
-        }
-        json_obj.emplace_back(std::move(row_obj));
+        serialize<JSON>::op<Opts>(raw_json_view{"[]"}, ctx, b, ix);
       }
-      serialize<JSON>::op<Opts>(json_obj, args...);
     }
   };
 
   template <>
   struct to<JSON, epoch_frame::Array>
   {
-    template <auto Opts>
-    static void op(const epoch_frame::Array &array, auto &&...args) noexcept
+    template <auto Opts, class B>
+    static void op(const epoch_frame::Array &array, auto &&ctx, B &&b,
+                   auto &&ix) noexcept
     {
-      std::vector<generic> arr;
-      arr.reserve(array.length());
-
-      for (int64_t i = 0; i < array.length(); ++i)
-      {
-        arr.emplace_back(to_json(array[i]));
-      }
-      serialize<JSON>::op<Opts>(arr, args...);
+      detail::WriteColumnarJson<Opts>(*array.value(), ctx, b, ix);
     }
   };
 
@@ -0,0 +1,65 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <epoch_frame/dataframe.h>
+#include <epoch_protos/tearsheet.pb.h>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace epoch_folio
+{
+  /*
+  Content addressed store of serialized tear sheets (whole dashboards or the
+  widgets of one node) and of intermediate frames in a directory that many
+  processes may share. Keys are hashed into file names. Entries are read through a memory map and written to
+  a temporary file renamed into place, so a reader never sees half an entry.
+  Once the entries outgrow maxBytes the least recently used are removed.
+  */
+  class TearSheetDiskCache
+  {
+  public:
+    explicit TearSheetDiskCache(std::string const &directory,
+                                uint64_t maxBytes = uint64_t{1} << 30);
+
+    // false when `key` is missing or unreadable
+    bool Get(std::string const &key, epoch_proto::TearSheet &output) const;
+
+    void Put(std::string const &key, epoch_proto::TearSheet const &value);
+
+    // Arrow IPC entries, mapped rather than read: the frame's buffers point
+    // into the file. Keys share one namespace with the tear sheets.
+    std::optional<epoch_frame::DataFrame>
+    GetFrame(std::string const &key) const;
+
+    void PutFrame(std::string const &key, epoch_frame::DataFrame const &value);
+
+    // bytes held as of the last scan plus what this instance wrote since
+    uint64_t SizeBytes() const;
+
+    std::filesystem::path const &Directory() const { return m_directory; }
+
+  private:
+    std::filesystem::path m_directory;
+    uint64_t m_maxBytes;
+    mutable std::mutex m_mutex;
+    uint64_t m_bytes{0};
+    uint64_t m_writes{0};
+
+    std::filesystem::path Path(std::string const &key,
+                               std::string_view extension) const;
+
+    // writes through `write` to a temporary renamed onto `path`
+    template <typename Write>
+    void PutFile(std::filesystem::path const &path, Write &&write);
+
+    // rescans the directory and removes the oldest entries down to 90% of
+    // maxBytes, caller holds m_mutex
+    void Evict();
+  };
+} // namespace epoch_folio
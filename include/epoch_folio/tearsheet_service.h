@@ -0,0 +1,119 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+
+#include "epoch_folio/data_loader.h"
+#include "epoch_folio/tearsheet.h"
+
+namespace epoch_folio
+{
+  struct TearSheetRequest
+  {
+    TearSheetSources sources;
+    bool isEquity{true};
+    TearSheetOption options{};
+  };
+
+  struct TearSheetServiceOption
+  {
+    // finished tear sheets kept, least recently used evicted first
+    size_t cacheEntries{64};
+    // concurrent builds, 0 = one per core
+    int workers{0};
+    // distinct builds queued or running before Build rejects new ones
+    size_t maxPending{256};
+    // submitted requests remembered for Fetch
+    size_t maxRequests{4096};
+    // how long a failed build keeps answering with its error before an
+    // identical request builds again, 0 = retry at once
+    std::chrono::milliseconds failureTtl{std::chrono::seconds{30}};
+  };
+
+  // thrown by Build when maxPending builds are already queued
+  struct ServiceBusy : std::runtime_error
+  {
+    using std::runtime_error::runtime_error;
+  };
+
+  /*
+  Builds tear sheets from local files on a bounded TBB arena. Results are kept
+  in an LRU cache keyed by the request: the options plus the path, size and
+  modification time of every source file, so editing an input misses the
+  cache. Concurrent identical requests share one build, and a failed build
+  keeps its error for `failureTtl` so pollers see the failure instead of a
+  fresh build.
+  */
+  class TearSheetService
+  {
+  public:
+    using Result = std::shared_ptr<const epoch_proto::TearSheet>;
+    using Builder =
+        std::function<epoch_proto::TearSheet(TearSheetRequest const &)>;
+
+    // `builder` defaults to LoadTearSheetData + PortfolioTearSheetFactory
+    explicit TearSheetService(TearSheetServiceOption option = {},
+                              Builder builder = {});
+    TearSheetService(TearSheetService const &) = delete;
+    TearSheetService &operator=(TearSheetService const &) = delete;
+    // waits for the builds in flight
+    ~TearSheetService();
+
+    // cached result, the build in flight for an identical request, the
+    // recently failed build of one, or a new build
+    std::shared_future<Result> Build(TearSheetRequest const &request);
+
+    // remembers `request` and starts building it, returns its id for Fetch
+    std::string Submit(TearSheetRequest const &request);
+
+    // the tear sheet of a submitted request, or only `widget` of it (see
+    // WidgetSelection); nullopt for an unknown id
+    std::optional<std::shared_future<Result>>
+    Fetch(std::string const &id,
+          std::optional<std::string> const &widget = std::nullopt);
+
+    size_t CacheSize() const;
+
+    static std::string Key(TearSheetRequest const &request);
+
+  private:
+    using LruList = std::list<std::pair<std::string, Result>>;
+
+    struct Failure
+    {
+      std::shared_future<Result> future;
+      std::chrono::steady_clock::time_point expires;
+    };
+
+    TearSheetServiceOption m_option;
+    Builder m_builder;
+
+    mutable std::mutex m_mutex;
+    LruList m_lru;
+    std::unordered_map<std::string, LruList::iterator> m_cache;
+    std::unordered_map<std::string, std::shared_future<Result>> m_inFlight;
+    std::unordered_map<std::string, Failure> m_failed;
+    std::unordered_map<std::string, TearSheetRequest> m_requests;
+    std::deque<std::string> m_requestOrder;
+
+    tbb::task_arena m_arena;
+    tbb::task_group m_group;
+
+    void Complete(std::string const &key, Result const &result);
+    void Fail(std::string const &key, std::shared_future<Result> const &future);
+  };
+} // namespace epoch_folio
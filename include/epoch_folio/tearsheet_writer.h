@@ -0,0 +1,107 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include "tear_sheets/widget_graph.h"
+#include <arrow/api.h>
+#include <cstdint>
+#include <epoch_core/enum_wrapper.h>
+#include <epoch_protos/tearsheet.pb.h>
+#include <string>
+#include <vector>
+
+// Zstd needs the library built with EPOCH_FOLIO_WITH_ZSTD
+CREATE_ENUM(TearSheetCompression, None, Gzip, Zstd);
+
+namespace epoch_folio
+{
+  // Serializes `output` straight into the file descriptor through a protobuf
+  // zero-copy stream, the encoded message is never held in memory.
+  void WriteTearSheet(epoch_proto::TearSheet const &output,
+                      std::string const &file_path,
+                      epoch_core::TearSheetCompression compression =
+                          epoch_core::TearSheetCompression::None);
+
+  // reads a file written by WriteTearSheet with the same compression
+  void ReadTearSheet(std::string const &file_path,
+                     epoch_proto::TearSheet &output,
+                     epoch_core::TearSheetCompression compression =
+                         epoch_core::TearSheetCompression::None);
+
+  // Writes `series` as an Arrow IPC file: an "index" column followed by the
+  // data columns, with the widget id and category in the schema metadata.
+  void WriteWidgetSeries(WidgetSeries const &series,
+                         std::string const &file_path);
+
+  // Memory-maps a file written by WriteWidgetSeries. The table's buffers
+  // point into the mapping, so slices are served without copying or parsing.
+  arrow::TablePtr MapWidgetSeries(std::string const &file_path);
+
+  /*
+  Append-only file holding many tear sheets, e.g. the output of a batch run.
+
+  Layout: a 6 byte header ("EFTC", format version, compression) followed by
+  records of a little-endian uint64 payload length and the payload, one tear
+  sheet compressed on its own. Records are streamed to the file and their
+  length patched in afterwards, so a record never sits in memory encoded. A
+  record cut short by a crash is ignored by the reader and overwritten by the
+  next writer.
+  */
+  class TearSheetContainerWriter
+  {
+  public:
+    // appends to an existing container, which must use the same compression
+    explicit TearSheetContainerWriter(
+        std::string const &file_path,
+        epoch_core::TearSheetCompression compression =
+            epoch_core::TearSheetCompression::None);
+    TearSheetContainerWriter(TearSheetContainerWriter const &) = delete;
+    TearSheetContainerWriter &
+    operator=(TearSheetContainerWriter const &) = delete;
+    ~TearSheetContainerWriter();
+
+    // returns the offset of the record, see TearSheetContainerReader::ReadAt
+    uint64_t Append(epoch_proto::TearSheet const &output);
+
+    void Close();
+
+  private:
+    std::string m_path;
+    int m_fd{-1};
+    epoch_core::TearSheetCompression m_compression;
+    uint64_t m_end{0};
+  };
+
+  // Reads a container lazily: opening only hops over the record lengths, a
+  // tear sheet is decoded when asked for. Reads are safe from many threads.
+  class TearSheetContainerReader
+  {
+  public:
+    explicit TearSheetContainerReader(std::string const &file_path);
+    TearSheetContainerReader(TearSheetContainerReader const &) = delete;
+    TearSheetContainerReader &
+    operator=(TearSheetContainerReader const &) = delete;
+    ~TearSheetContainerReader();
+
+    size_t size() const { return m_offsets.size(); }
+
+    std::vector<uint64_t> const &Offsets() const { return m_offsets; }
+
+    epoch_core::TearSheetCompression Compression() const
+    {
+      return m_compression;
+    }
+
+    epoch_proto::TearSheet Read(size_t i) const;
+
+    // parses the record at `offset`, one of Offsets(), into `output`
+    void ReadAt(uint64_t offset, epoch_proto::TearSheet &output) const;
+
+  private:
+    std::string m_path;
+    int m_fd{-1};
+    epoch_core::TearSheetCompression m_compression;
+    std::vector<uint64_t> m_offsets;
+  };
+} // namespace epoch_folio
@@ -0,0 +1,269 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+/*
+Local tear sheet server. Inputs are referenced by path, nothing leaves the
+machine and it listens on 127.0.0.1 by default.
+
+  POST /tearsheets                         body: TearSheetBody as JSON
+       -> 202 {"id": "..."}
+  GET  /tearsheets/{id}                    -> the tear sheet
+  GET  /tearsheets/{id}/widgets/{widget}   -> a tear sheet of that widget only
+
+GETs answer 202 {"status": "pending"} while the build runs and never block
+the IO threads; results are protobuf unless ?format=json is given.
+*/
+
+#include "epoch_folio/tearsheet_service.h"
+#include <charconv>
+#include <drogon/drogon.h>
+#include <format>
+#include <glaze/glaze.hpp>
+#include <google/protobuf/util/json_util.h>
+#include <map>
+#include <spdlog/spdlog.h>
+
+using namespace epoch_folio;
+
+namespace
+{
+  // the options a client may set, the rest keep their defaults
+  struct TearSheetBody
+  {
+    TearSheetSources sources;
+    bool isEquity{true};
+    uint8_t topKPositions{10};
+    uint8_t topKDrawDowns{5};
+    size_t topKRoundTripSymbols{25};
+    size_t maxChartPoints{0};
+    std::vector<std::string> categories{};
+    std::vector<std::string> widgets{};
+
+    TearSheetRequest ToRequest() const
+    {
+      TearSheetRequest request{.sources = sources, .isEquity = isEquity};
+      request.options.topKPositions = topKPositions;
+      request.options.topKDrawDowns = topKDrawDowns;
+      request.options.topKRoundTripSymbols = topKRoundTripSymbols;
+      request.options.maxChartPoints = maxChartPoints;
+      request.options.selection = {.categories = categories,
+                                   .widgets = widgets};
+      return request;
+    }
+  };
+
+  struct ServerOption
+  {
+    std::string host{"127.0.0.1"};
+    uint16_t port{8080};
+    size_t ioThreads{2};
+    TearSheetServiceOption service{};
+  };
+
+  template <typename T> T ParseNumber(std::string_view flag, char const *value)
+  {
+    T result{};
+    const std::string_view text{value};
+    auto [end, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), result);
+    if (ec != std::errc{} || end != text.data() + text.size())
+    {
+      throw std::runtime_error(std::format("invalid {} {}", flag, text));
+    }
+    return result;
+  }
+
+  ServerOption ParseArgs(int argc, char **argv)
+  {
+    ServerOption option;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+      const std::string_view flag{argv[i]};
+      if (flag == "--host")
+      {
+        option.host = argv[i + 1];
+      }
+      else if (flag == "--port")
+      {
+        option.port = ParseNumber<uint16_t>(flag, argv[i + 1]);
+      }
+      else if (flag == "--io-threads")
+      {
+        option.ioThreads = ParseNumber<size_t>(flag, argv[i + 1]);
+      }
+      else if (flag == "--workers")
+      {
+        option.service.workers = ParseNumber<int>(flag, argv[i + 1]);
+      }
+      else if (flag == "--cache")
+      {
+        option.service.cacheEntries = ParseNumber<size_t>(flag, argv[i + 1]);
+      }
+      else if (flag == "--max-pending")
+      {
+        option.service.maxPending = ParseNumber<size_t>(flag, argv[i + 1]);
+      }
+      else
+      {
+        throw std::runtime_error(std::format("unknown flag {}", flag));
+      }
+    }
+    return option;
+  }
+
+  drogon::HttpResponsePtr JsonResponse(drogon::HttpStatusCode status,
+                                       std::string body)
+  {
+    auto response = drogon::HttpResponse::newHttpResponse();
+    response->setStatusCode(status);
+    response->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    response->setBody(std::move(body));
+    return response;
+  }
+
+  drogon::HttpResponsePtr ErrorResponse(drogon::HttpStatusCode status,
+                                        std::string const &error)
+  {
+    std::string body;
+    (void)glz::write_json(std::map<std::string, std::string>{{"error", error}},
+                          body);
+    return JsonResponse(status, std::move(body));
+  }
+
+  drogon::HttpResponsePtr
+  TearSheetResponse(drogon::HttpRequestPtr const &request,
+                    std::optional<std::shared_future<TearSheetService::Result>>
+                        const &future)
+  {
+    if (!future)
+    {
+      return ErrorResponse(drogon::k404NotFound, "unknown tear sheet id");
+    }
+    if (future->wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+    {
+      return JsonResponse(drogon::k202Accepted, R"({"status":"pending"})");
+    }
+
+    TearSheetService::Result tearSheet;
+    try
+    {
+      tearSheet = future->get();
+    }
+    catch (std::exception const &e)
+    {
+      return ErrorResponse(drogon::k500InternalServerError, e.what());
+    }
+
+    if (request->getParameter("format") == "json")
+    {
+      std::string body;
+      if (!google::protobuf::util::MessageToJsonString(*tearSheet, &body).ok())
+      {
+        return ErrorResponse(drogon::k500InternalServerError,
+                             "failed to encode tear sheet as json");
+      }
+      return JsonResponse(drogon::k200OK, std::move(body));
+    }
+
+    auto response = drogon::HttpResponse::newHttpResponse();
+    response->setContentTypeString("application/x-protobuf");
+    response->setBody(tearSheet->SerializeAsString());
+    return response;
+  }
+
+  using Callback = std::function<void(drogon::HttpResponsePtr const &)>;
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ServerOption option;
+  try
+  {
+    option = ParseArgs(argc, argv);
+  }
+  catch (std::exception const &e)
+  {
+    SPDLOG_ERROR("{}", e.what());
+    return 1;
+  }
+
+  TearSheetService service{option.service};
+
+  drogon::app().registerHandler(
+      "/tearsheets",
+      [&service](drogon::HttpRequestPtr const &request, Callback &&callback)
+      {
+        TearSheetBody body;
+        const std::string json{request->body()};
+        if (auto ec = glz::read_json(body, json))
+        {
+          callback(ErrorResponse(drogon::k400BadRequest,
+                                 glz::format_error(ec, json)));
+          return;
+        }
+        try
+        {
+          const auto id = service.Submit(body.ToRequest());
+          callback(JsonResponse(drogon::k202Accepted,
+                                std::format(R"({{"id":"{}"}})", id)));
+        }
+        catch (ServiceBusy const &e)
+        {
+          callback(ErrorResponse(drogon::k503ServiceUnavailable, e.what()));
+        }
+        catch (std::exception const &e)
+        {
+          // e.g. a missing input file while keying the request
+          callback(ErrorResponse(drogon::k400BadRequest, e.what()));
+        }
+      },
+      {drogon::Post});
+
+  drogon::app().registerHandler(
+      "/tearsheets/{id}",
+      [&service](drogon::HttpRequestPtr const &request, Callback &&callback,
+                 std::string const &id)
+      {
+        try
+        {
+          callback(TearSheetResponse(request, service.Fetch(id)));
+        }
+        catch (ServiceBusy const &e)
+        {
+          callback(ErrorResponse(drogon::k503ServiceUnavailable, e.what()));
+        }
+        catch (std::exception const &e)
+        {
+          callback(ErrorResponse(drogon::k400BadRequest, e.what()));
+        }
+      },
+      {drogon::Get});
+
+  drogon::app().registerHandler(
+      "/tearsheets/{id}/widgets/{widget}",
+      [&service](drogon::HttpRequestPtr const &request, Callback &&callback,
+                 std::string const &id, std::string const &widget)
+      {
+        try
+        {
+          callback(TearSheetResponse(request, service.Fetch(id, widget)));
+        }
+        catch (ServiceBusy const &e)
+        {
+          callback(ErrorResponse(drogon::k503ServiceUnavailable, e.what()));
+        }
+        catch (std::exception const &e)
+        {
+          callback(ErrorResponse(drogon::k400BadRequest, e.what()));
+        }
+      },
+      {drogon::Get});
+
+  SPDLOG_INFO("Serving tear sheets on {}:{}", option.host, option.port);
+  drogon::app()
+      .addListener(option.host, option.port)
+      .setThreadNum(option.ioThreads)
+      .run();
+  return 0;
+}
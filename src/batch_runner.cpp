@@ -0,0 +1,98 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "epoch_folio/batch_runner.h"
+#include <algorithm>
+#include <mutex>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
+#include <spdlog/spdlog.h>
+
+namespace epoch_folio
+{
+  BatchTearSheetRunner::BatchTearSheetRunner(
+      std::optional<epoch_frame::Series> const &benchmark,
+      BatchTearSheetOption options)
+      : m_benchmark(benchmark), m_options(std::move(options)) {}
+
+  void BatchTearSheetRunner::Run(std::span<const TearSheetDataOption> strategies,
+                                 Callback const &onTearSheet) const
+  {
+    // one alignment per distinct strategy index and fill, strategies that
+    // cannot share one align the raw benchmark on their own
+    std::vector<returns::SharedBenchmark> alignments;
+    std::vector<returns::SharedBenchmark> shared(strategies.size());
+    returns::SharedBenchmark unaligned;
+    for (size_t i = 0; m_benchmark && i < strategies.size(); ++i)
+    {
+      auto const &data = strategies[i];
+      try
+      {
+        const auto strategy = StrategyReturns(data);
+        auto it = std::ranges::find_if(
+            alignments, [&](returns::SharedBenchmark const &aligned)
+            { return aligned->alignment->Applies(strategy, data.benchmarkFill); });
+        if (data.benchmarks.empty() && it != alignments.end())
+        {
+          shared[i] = *it;
+        }
+        else if (data.benchmarks.empty())
+        {
+          auto aligned = returns::BenchmarkArtifacts::MakeAligned(
+              *m_benchmark, strategy, data.benchmarkFill);
+          if (aligned->alignment->Applies(strategy, data.benchmarkFill))
+          {
+            shared[i] = aligned;
+            alignments.push_back(std::move(aligned));
+          }
+        }
+      }
+      catch (std::exception const &e)
+      {
+        // the build below fails the same way and reports it
+        SPDLOG_DEBUG("Cannot align strategy {}: {}", i, e.what());
+      }
+      if (!shared[i])
+      {
+        if (!unaligned)
+        {
+          unaligned = returns::BenchmarkArtifacts::Make(*m_benchmark);
+        }
+        shared[i] = unaligned;
+      }
+    }
+
+    std::mutex callbackMutex;
+    auto build = [&](size_t i)
+    {
+      epoch_proto::TearSheet tearSheet;
+      try
+      {
+        auto data = strategies[i];
+        data.benchmark = std::nullopt;
+        // a thread waiting on its own widgets must not start another
+        // strategy, which would lift the bound on live tear sheets
+        tbb::this_task_arena::isolate(
+            [&]
+            {
+              tearSheet = PortfolioTearSheetFactory{data, shared[i]}
+                              .MakeTearSheet(m_options.tearSheet);
+            });
+      }
+      catch (std::exception const &e)
+      {
+        SPDLOG_ERROR("Failed to build tear sheet {}: {}", i, e.what());
+        return;
+      }
+      std::lock_guard lock{callbackMutex};
+      onTearSheet(i, std::move(tearSheet));
+    };
+
+    tbb::task_arena arena(m_options.maxConcurrency > 0
+                              ? m_options.maxConcurrency
+                              : tbb::task_arena::automatic);
+    arena.execute([&]
+                  { tbb::parallel_for(size_t{0}, strategies.size(), build); });
+  }
+} // namespace epoch_folio
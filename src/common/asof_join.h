@@ -0,0 +1,42 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace epoch_folio {
+constexpr int64_t kNoMatch = -1;
+
+/*
+Backward as-of join of two ascending int64 timestamp columns. For every left
+row, returns the position of the last right row whose timestamp is <= the left
+timestamp, or kNoMatch when there is none or it lies more than `tolerance`
+behind. Single merge pass, O(n + m), no hashing. Equal right timestamps resolve
+to the last of them.
+*/
+inline std::vector<int64_t>
+AsOfJoinBackward(std::span<const int64_t> left,
+                 std::span<const int64_t> right,
+                 std::optional<int64_t> tolerance = std::nullopt) {
+  std::vector<int64_t> out(left.size(), kNoMatch);
+  size_t cursor = 0;
+  for (size_t i = 0; i < left.size(); ++i) {
+    while (cursor < right.size() && right[cursor] <= left[i]) {
+      ++cursor;
+    }
+    if (cursor == 0) {
+      continue;
+    }
+    const auto match = cursor - 1;
+    if (tolerance && left[i] - right[match] > *tolerance) {
+      continue;
+    }
+    out[i] = static_cast<int64_t>(match);
+  }
+  return out;
+}
+} // namespace epoch_folio
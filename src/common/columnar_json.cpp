@@ -0,0 +1,194 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "columnar_json.h"
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <epoch_frame/scalar.h>
+#include <string_view>
+#include <vector>
+
+namespace epoch_folio {
+namespace {
+void AppendDouble(double value, std::string &out) {
+  if (!std::isfinite(value)) {
+    out += "null";
+    return;
+  }
+  std::array<char, 32> buffer{};
+  const auto result =
+      std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  out.append(buffer.data(), result.ptr);
+}
+
+void AppendString(std::string_view value, std::string &out) {
+  constexpr std::string_view kHex = "0123456789abcdef";
+  out += '"';
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        out += "\\u00";
+        out += kHex[(c >> 4) & 0xF];
+        out += kHex[c & 0xF];
+      } else {
+        out += c;
+      }
+    }
+  }
+  out += '"';
+}
+
+// writes the non-null value at `row`
+using CellWriter = void (*)(arrow::Array const &, int64_t, std::string &);
+
+template <typename ArrowType>
+void WriteNumber(arrow::Array const &array, int64_t row, std::string &out) {
+  auto const &typed = static_cast<arrow::NumericArray<ArrowType> const &>(array);
+  AppendDouble(static_cast<double>(typed.Value(row)), out);
+}
+
+void WriteBool(arrow::Array const &array, int64_t row, std::string &out) {
+  out += static_cast<arrow::BooleanArray const &>(array).Value(row) ? "true"
+                                                                    : "false";
+}
+
+template <typename ArrayType>
+void WriteString(arrow::Array const &array, int64_t row, std::string &out) {
+  AppendString(static_cast<ArrayType const &>(array).GetView(row), out);
+}
+
+// types without a buffer writer take the scalar route of glz::to_json
+void WriteScalar(arrow::Array const &array, int64_t row, std::string &out) {
+  epoch_frame::Scalar scalar{array.GetScalar(row).MoveValueUnsafe()};
+  if (arrow::is_numeric(array.type_id())) {
+    AppendDouble(scalar.cast_double().as_double(), out);
+  } else {
+    AppendString(scalar.repr(), out);
+  }
+}
+
+CellWriter WriterFor(arrow::Type::type type) {
+  switch (type) {
+  case arrow::Type::DOUBLE:
+    return WriteNumber<arrow::DoubleType>;
+  case arrow::Type::FLOAT:
+    return WriteNumber<arrow::FloatType>;
+  case arrow::Type::INT64:
+    return WriteNumber<arrow::Int64Type>;
+  case arrow::Type::INT32:
+    return WriteNumber<arrow::Int32Type>;
+  case arrow::Type::INT16:
+    return WriteNumber<arrow::Int16Type>;
+  case arrow::Type::INT8:
+    return WriteNumber<arrow::Int8Type>;
+  case arrow::Type::UINT64:
+    return WriteNumber<arrow::UInt64Type>;
+  case arrow::Type::UINT32:
+    return WriteNumber<arrow::UInt32Type>;
+  case arrow::Type::UINT16:
+    return WriteNumber<arrow::UInt16Type>;
+  case arrow::Type::UINT8:
+    return WriteNumber<arrow::UInt8Type>;
+  case arrow::Type::BOOL:
+    return WriteBool;
+  case arrow::Type::STRING:
+    return WriteString<arrow::StringArray>;
+  case arrow::Type::LARGE_STRING:
+    return WriteString<arrow::LargeStringArray>;
+  default:
+    return WriteScalar;
+  }
+}
+
+void WriteCell(CellWriter writer, arrow::Array const &array, int64_t row,
+               std::string &out) {
+  if (array.IsNull(row)) {
+    out += "null";
+  } else {
+    writer(array, row, out);
+  }
+}
+
+// walks one chunked column in row order
+class ColumnCursor {
+public:
+  explicit ColumnCursor(std::shared_ptr<arrow::ChunkedArray> column)
+      : m_column(std::move(column)),
+        m_writer(WriterFor(m_column->type()->id())) {}
+
+  void WriteNext(std::string &out) {
+    auto const &chunks = m_column->chunks();
+    while (m_row == chunks[m_chunk]->length()) {
+      ++m_chunk;
+      m_row = 0;
+    }
+    WriteCell(m_writer, *chunks[m_chunk], m_row++, out);
+  }
+
+private:
+  std::shared_ptr<arrow::ChunkedArray> m_column;
+  CellWriter m_writer;
+  size_t m_chunk{0};
+  int64_t m_row{0};
+};
+} // namespace
+
+void AppendJson(arrow::Table const &table, std::string &out) {
+  const auto columnNames = table.ColumnNames();
+  std::vector<std::string> keys;
+  std::vector<ColumnCursor> cursors;
+  keys.reserve(columnNames.size());
+  cursors.reserve(columnNames.size());
+  for (int i = 0; i < table.num_columns(); ++i) {
+    std::string key;
+    AppendString(columnNames[i], key);
+    key += ':';
+    keys.emplace_back(std::move(key));
+    cursors.emplace_back(table.column(i));
+  }
+
+  out += '[';
+  for (int64_t row = 0; row < table.num_rows(); ++row) {
+    out += row == 0 ? "{" : ",{";
+    for (size_t col = 0; col < cursors.size(); ++col) {
+      if (col > 0) {
+        out += ',';
+      }
+      out += keys[col];
+      cursors[col].WriteNext(out);
+    }
+    out += '}';
+  }
+  out += ']';
+}
+
+void AppendJson(arrow::Array const &array, std::string &out) {
+  const auto writer = WriterFor(array.type_id());
+  out += '[';
+  for (int64_t row = 0; row < array.length(); ++row) {
+    if (row > 0) {
+      out += ',';
+    }
+    WriteCell(writer, array, row, out);
+  }
+  out += ']';
+}
+} // namespace epoch_folio
@@ -0,0 +1,24 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <arrow/api.h>
+#include <string>
+
+namespace epoch_folio {
+/*
+Columnar JSON writers backing the glz serializers of arrow tables and arrays.
+The writer for each column is picked once from its type. Numeric and boolean
+columns are then read straight from the value buffers and validity bitmaps,
+and each value is appended as text. Values match glz::to_json cell by cell:
+numbers become doubles (non-finite ones null), nulls become null, and every
+other type becomes the scalar's repr() string.
+*/
+
+// appends the table as an array of row objects keyed by column name
+void AppendJson(arrow::Table const &table, std::string &out);
+
+// appends the values as a JSON array
+void AppendJson(arrow::Array const &array, std::string &out);
+} // namespace epoch_folio
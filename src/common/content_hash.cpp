@@ -0,0 +1,243 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "content_hash.h"
+#include <arrow/util/bit_util.h>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <map>
+
+namespace epoch_folio {
+namespace {
+constexpr uint64_t kPrime1 = 0x87C37B91114253D5ULL;
+constexpr uint64_t kPrime2 = 0x4CF5AD432745937FULL;
+
+void Mix(uint64_t &a, uint64_t &b, uint64_t word) {
+  a = std::rotl(a ^ (word * kPrime1), 31) * kPrime2;
+  b = std::rotl(b ^ (word * kPrime2), 33) * kPrime1 + a;
+}
+
+// murmur3 finalizer
+uint64_t Avalanche(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+} // namespace
+
+void ContentHash::Update(const void *data, size_t size) {
+  auto bytes = static_cast<const uint8_t *>(data);
+  m_length += size;
+  while (size > 0 && m_tailBytes != 0) {
+    m_tail |= uint64_t{*bytes++} << (8 * m_tailBytes);
+    --size;
+    if (++m_tailBytes == 8) {
+      Mix(m_a, m_b, m_tail);
+      m_tail = 0;
+      m_tailBytes = 0;
+    }
+  }
+  for (; size >= 8; size -= 8, bytes += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    Mix(m_a, m_b, word);
+  }
+  for (; size > 0; --size) {
+    m_tail |= uint64_t{*bytes++} << (8 * m_tailBytes++);
+  }
+}
+
+void ContentHash::Update(std::string_view text) {
+  Update(static_cast<uint64_t>(text.size()));
+  Update(text.data(), text.size());
+}
+
+void ContentHash::UpdateBits(const uint8_t *bitmap, int64_t offset,
+                             int64_t length) {
+  uint64_t word = 0;
+  int bits = 0;
+  for (int64_t i = 0; i < length; ++i) {
+    if (arrow::bit_util::GetBit(bitmap, offset + i)) {
+      word |= uint64_t{1} << bits;
+    }
+    if (++bits == 64) {
+      Update(word);
+      word = 0;
+      bits = 0;
+    }
+  }
+  if (bits != 0) {
+    Update(word);
+  }
+}
+
+void ContentHash::Update(arrow::ArrayData const &data) {
+  Update(std::string_view{data.type->ToString()});
+  Update(data.length);
+  const auto nulls = data.GetNullCount();
+  Update(nulls);
+  if (nulls > 0 && data.buffers[0]) {
+    UpdateBits(data.buffers[0]->data(), data.offset, data.length);
+  }
+
+  const auto id = data.type->id();
+  if (id == arrow::Type::BOOL) {
+    UpdateBits(data.buffers[1]->data(), data.offset, data.length);
+    return;
+  }
+  auto const *fixed =
+      dynamic_cast<arrow::FixedWidthType const *>(data.type.get());
+  if (fixed && id != arrow::Type::DICTIONARY && fixed->bit_width() % 8 == 0 &&
+      data.buffers.size() == 2 && data.buffers[1] && data.child_data.empty()) {
+    const auto width = fixed->bit_width() / 8;
+    Update(data.buffers[1]->data() + data.offset * width,
+           static_cast<size_t>(data.length * width));
+    return;
+  }
+
+  // offsets, views and children are hashed as laid out
+  Update(data.offset);
+  for (auto const &buffer : data.buffers) {
+    if (!buffer) {
+      Update(int64_t{-1});
+      continue;
+    }
+    Update(buffer->size());
+    Update(buffer->data(), static_cast<size_t>(buffer->size()));
+  }
+  for (auto const &child : data.child_data) {
+    Update(*child);
+  }
+  if (data.dictionary) {
+    Update(*data.dictionary);
+  }
+}
+
+void ContentHash::Update(arrow::ChunkedArray const &array) {
+  Update(array.length());
+  for (auto const &chunk : array.chunks()) {
+    Update(*chunk->data());
+  }
+}
+
+void ContentHash::UpdateFrame(epoch_frame::DataFrame const &frame) {
+  if (frame.empty()) {
+    Update(uint64_t{0});
+    return;
+  }
+  const auto names = frame.column_names();
+  Update(static_cast<uint64_t>(names.size()));
+  for (size_t i = 0; i < names.size(); ++i) {
+    Update(std::string_view{names[i]});
+    Update(*frame.table()->column(static_cast<int>(i)));
+  }
+  Update(*frame.index()->as_chunked_array());
+}
+
+void ContentHash::UpdateSeries(epoch_frame::Series const &series) {
+  if (series.empty()) {
+    Update(uint64_t{0});
+    return;
+  }
+  UpdateFrame(series.to_frame());
+}
+
+std::string ContentHash::Hex() const {
+  auto a = m_a;
+  auto b = m_b;
+  if (m_tailBytes != 0) {
+    Mix(a, b, m_tail);
+  }
+  a ^= m_length;
+  b ^= m_length;
+  a = Avalanche(a + b);
+  b = Avalanche(b + a);
+  return std::format("{:016x}{:016x}", a, b);
+}
+
+std::string TearSheetOptionKey(TearSheetOption const &options) {
+  std::string key = std::format(
+      "{}|{}|{}|{}|{}|{}|{}|{}|{}|{}|{}|{}",
+      static_cast<int>(options.turnoverDenominator), options.topKPositions,
+      options.rollingVolatilityPeriodInMonths,
+      options.rollingSharpePeriodInMonths, options.topKDrawDowns,
+      options.bootstrapKSamples, options.transactionBinMinutes,
+      options.transactionTimezone, options.topKRoundTripSymbols,
+      options.maxChartPoints, options.interestingDateRanges.has_value(),
+      options.roundTripValueTolerance
+          .transform([](auto tolerance) { return tolerance.count(); })
+          .value_or(-1));
+  for (auto months : options.rollingBetaPeriodsInMonths) {
+    key += std::format(",b{}", months);
+  }
+  if (options.interestingDateRanges) {
+    for (auto const &range : *options.interestingDateRanges) {
+      key += std::format(
+          ",r{}:{}:{}", range.name,
+          epoch_frame::DateTime{range.start}.m_nanoseconds.count(),
+          epoch_frame::DateTime{range.end}.m_nanoseconds.count());
+    }
+  }
+  for (auto const &category : options.selection.categories) {
+    key += std::format(",c{}", category);
+  }
+  for (auto const &widget : options.selection.widgets) {
+    key += std::format(",w{}", widget);
+  }
+  return key;
+}
+
+std::string HashTearSheetData(TearSheetDataOption const &data) {
+  ContentHash hash;
+  hash.UpdateSeries(data.equity);
+  hash.Update(data.benchmark.has_value());
+  if (data.benchmark) {
+    hash.UpdateSeries(*data.benchmark);
+  }
+  hash.Update(static_cast<uint64_t>(data.benchmarks.size()));
+  for (auto const &benchmark : data.benchmarks) {
+    hash.Update(std::string_view{benchmark.name});
+    hash.UpdateSeries(benchmark.returns);
+  }
+  hash.Update(static_cast<int>(data.benchmarkFill));
+  hash.UpdateSeries(data.cash);
+  hash.UpdateFrame(data.positions);
+  hash.UpdateFrame(data.transactions);
+  hash.UpdateFrame(data.roundTrip);
+
+  // unordered, so hash the mapping sorted
+  const std::map<std::string, std::string> sectors(data.sectorMapping.begin(),
+                                                   data.sectorMapping.end());
+  hash.Update(static_cast<uint64_t>(sectors.size()));
+  for (auto const &[asset, sector] : sectors) {
+    hash.Update(std::string_view{asset});
+    hash.Update(std::string_view{sector});
+  }
+
+  hash.Update(data.isEquity);
+  hash.Update(data.classification.has_value());
+  if (data.classification) {
+    hash.Update(static_cast<uint64_t>(data.classification->assets.size()));
+    for (auto const &asset : data.classification->assets) {
+      hash.Update(std::string_view{asset});
+    }
+    for (auto const &level : data.classification->levels) {
+      hash.Update(std::string_view{level.id});
+      hash.Update(std::string_view{level.name});
+      hash.Update(static_cast<uint64_t>(level.labels.size()));
+      for (auto const &label : level.labels) {
+        hash.Update(std::string_view{label});
+      }
+      hash.Update(static_cast<uint64_t>(level.codes.size()));
+      hash.Update(level.codes.data(), level.codes.size() * sizeof(int32_t));
+    }
+  }
+  hash.Update(static_cast<int>(data.roundTripMatching));
+  return hash.Hex();
+}
+} // namespace epoch_folio
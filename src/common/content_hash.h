@@ -0,0 +1,64 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <arrow/api.h>
+#include <concepts>
+#include <cstdint>
+#include <epoch_frame/dataframe.h>
+#include <epoch_frame/series.h>
+#include <string>
+#include <string_view>
+
+#include "portfolio/model.h"
+
+namespace epoch_folio {
+/*
+Streaming 128 bit hash of the bytes an input is made of, used to address
+cached results by content. Arrays are hashed by value over their logical
+range, so a slice hashes like a copy of it; layouts it cannot walk (strings,
+nested types) fall back to their whole buffers, which can only cause a miss.
+Not cryptographic.
+*/
+class ContentHash {
+public:
+  void Update(const void *data, size_t size);
+
+  template <std::integral T> void Update(T value) {
+    Update(&value, sizeof(value));
+  }
+
+  // length prefixed, so adjacent strings cannot run into each other
+  void Update(std::string_view text);
+
+  void Update(arrow::ArrayData const &data);
+  void Update(arrow::ChunkedArray const &array);
+  void UpdateFrame(epoch_frame::DataFrame const &frame);
+  void UpdateSeries(epoch_frame::Series const &series);
+
+  // 32 lower case hex digits
+  std::string Hex() const;
+
+private:
+  uint64_t m_a{0x9E3779B97F4A7C15ULL};
+  uint64_t m_b{0xC2B2AE3D27D4EB4FULL};
+  uint64_t m_length{0};
+  uint64_t m_tail{0};
+  size_t m_tailBytes{0};
+
+  void UpdateBits(const uint8_t *bitmap, int64_t offset, int64_t length);
+};
+
+// every option that changes the output of a build, in a stable order
+std::string TearSheetOptionKey(TearSheetOption const &options);
+
+// hash of every input the tear sheet reads
+std::string HashTearSheetData(TearSheetDataOption const &data);
+
+inline std::string HashKey(std::string_view key) {
+  ContentHash hash;
+  hash.Update(key);
+  return hash.Hex();
+}
+} // namespace epoch_folio
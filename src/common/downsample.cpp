@@ -0,0 +1,109 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "downsample.h"
+#include "series_helper.h"
+#include <epoch_frame/factory/dataframe_factory.h>
+
+namespace epoch_folio {
+namespace {
+void KeepExtrema(std::vector<double> const &y, std::vector<size_t> &rows) {
+  std::optional<size_t> lo, hi;
+  for (size_t i = 0; i < y.size(); ++i) {
+    if (std::isnan(y[i])) {
+      continue;
+    }
+    if (!lo || y[i] < y[*lo]) {
+      lo = i;
+    }
+    if (!hi || y[i] > y[*hi]) {
+      hi = i;
+    }
+  }
+  if (lo) {
+    rows.push_back(*lo);
+    rows.push_back(*hi);
+  }
+}
+
+arrow::ArrayPtr Take(arrow::Datum const &values, arrow::ArrayPtr const &rows) {
+  return epoch_frame::AssertResultIsOk(arrow::compute::Take(values, rows))
+      .make_array();
+}
+} // namespace
+
+epoch_frame::DataFrame Downsample(epoch_frame::DataFrame const &frame,
+                                  size_t maxPoints,
+                                  std::span<const int64_t> keepTimestamps) {
+  const auto n = static_cast<size_t>(frame.num_rows());
+  if (maxPoints == 0 || n <= maxPoints) {
+    return frame;
+  }
+
+  const auto index = frame.index();
+  const bool timed = index->dtype()->id() == arrow::Type::TIMESTAMP;
+  std::vector<int64_t> timestamps;
+  std::vector<double> x(n);
+  if (timed) {
+    timestamps = ToTimestampVector(index);
+    std::ranges::transform(timestamps, x.begin(),
+                           [](int64_t t) { return static_cast<double>(t); });
+  } else {
+    std::iota(x.begin(), x.end(), 0.0);
+  }
+
+  const auto columns = frame.table()->columns();
+  const auto budget = std::max<size_t>(maxPoints / columns.size(), 3);
+  std::vector<size_t> rows;
+  for (auto const &column : columns) {
+    const auto y = ToDoubleVector(column);
+    auto picked = Lttb(x, y, budget);
+    rows.insert(rows.end(), picked.begin(), picked.end());
+    KeepExtrema(y, rows);
+  }
+
+  // the rows bracketing each kept timestamp, so bands start and end on a point
+  if (timed) {
+    for (auto t : keepTimestamps) {
+      const auto it = std::ranges::lower_bound(timestamps, t);
+      const auto row = static_cast<size_t>(it - timestamps.begin());
+      if (row < n) {
+        rows.push_back(row);
+      }
+      if (row > 0 && (row == n || timestamps[row] != t)) {
+        rows.push_back(row - 1);
+      }
+    }
+  }
+
+  std::ranges::sort(rows);
+  rows.erase(std::ranges::unique(rows).begin(), rows.end());
+
+  arrow::UInt64Builder builder;
+  ThrowIfNotOk(builder.Reserve(static_cast<int64_t>(rows.size())));
+  for (auto row : rows) {
+    builder.UnsafeAppend(row);
+  }
+  const auto take = builder.Finish().ValueOrDie();
+
+  std::vector<arrow::ChunkedArrayPtr> taken;
+  taken.reserve(columns.size());
+  for (auto const &column : columns) {
+    taken.push_back(
+        std::make_shared<arrow::ChunkedArray>(Take(arrow::Datum{column}, take)));
+  }
+  return epoch_frame::make_dataframe(
+      index->Make(Take(arrow::Datum{index->array().value()}, take)), taken,
+      frame.column_names());
+}
+
+epoch_frame::Series Downsample(epoch_frame::Series const &series,
+                               size_t maxPoints,
+                               std::span<const int64_t> keepTimestamps) {
+  if (maxPoints == 0 || static_cast<size_t>(series.size()) <= maxPoints) {
+    return series;
+  }
+  return Downsample(series.to_frame(), maxPoints, keepTimestamps).to_series();
+}
+} // namespace epoch_folio
@@ -0,0 +1,98 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <epoch_frame/dataframe.h>
+#include <epoch_frame/series.h>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace epoch_folio {
+/*
+Largest-Triangle-Three-Buckets: picks `budget` of the points (x[i], y[i]) that
+best keep the visual shape of the line, always including the first and the
+last. NaN points are only picked for a bucket holding nothing else.
+*/
+inline std::vector<size_t> Lttb(std::span<const double> x,
+                                std::span<const double> y, size_t budget) {
+  const auto n = y.size();
+  if (budget >= n) {
+    std::vector<size_t> all(n);
+    std::iota(all.begin(), all.end(), size_t{0});
+    return all;
+  }
+  if (budget < 3) {
+    return n == 0 ? std::vector<size_t>{} : std::vector<size_t>{0, n - 1};
+  }
+
+  std::vector<size_t> out;
+  out.reserve(budget);
+  out.push_back(0);
+
+  const double every =
+      static_cast<double>(n - 2) / static_cast<double>(budget - 2);
+  auto bucketStart = [&](size_t bucket) {
+    return std::min(static_cast<size_t>(std::floor(bucket * every)) + 1, n - 1);
+  };
+
+  size_t a = 0;
+  for (size_t bucket = 0; bucket + 2 < budget; ++bucket) {
+    const auto start = bucketStart(bucket);
+    const auto end = bucketStart(bucket + 1);
+    const auto nextEnd = bucket + 3 < budget ? bucketStart(bucket + 2) : n;
+
+    // the third triangle vertex is the average of the next bucket
+    double avgX = 0, avgY = 0;
+    size_t count = 0;
+    for (size_t j = end; j < nextEnd; ++j) {
+      if (!std::isnan(y[j])) {
+        avgX += x[j];
+        avgY += y[j];
+        ++count;
+      }
+    }
+    if (count > 0) {
+      avgX /= static_cast<double>(count);
+      avgY /= static_cast<double>(count);
+    } else {
+      avgX = x[end];
+      avgY = y[a];
+    }
+
+    double maxArea = -1;
+    size_t pick = start;
+    for (size_t j = start; j < end; ++j) {
+      const double area = std::abs((x[a] - avgX) * (y[j] - y[a]) -
+                                   (x[a] - x[j]) * (avgY - y[a]));
+      if (area > maxArea) {
+        maxArea = area;
+        pick = j;
+      }
+    }
+    out.push_back(pick);
+    a = pick;
+  }
+  out.push_back(n - 1);
+  return out;
+}
+
+/*
+Chart decimation: keeps at most about `maxPoints` rows of a line chart input
+chosen by LTTB (the budget is split across columns), plus every column's
+minimum and maximum and the rows around each timestamp of `keepTimestamps`
+(e.g. drawdown band endpoints). maxPoints = 0 keeps every row.
+*/
+epoch_frame::DataFrame Downsample(epoch_frame::DataFrame const &frame,
+                                  size_t maxPoints,
+                                  std::span<const int64_t> keepTimestamps = {});
+
+epoch_frame::Series Downsample(epoch_frame::Series const &series,
+                               size_t maxPoints,
+                               std::span<const int64_t> keepTimestamps = {});
+} // namespace epoch_folio
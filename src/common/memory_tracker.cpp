@@ -0,0 +1,173 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "memory_tracker.h"
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace epoch_folio {
+namespace {
+std::atomic<TrackingMemoryPool *> g_installed{nullptr};
+// installs of g_installed still alive, guarded by g_installMutex
+std::mutex g_installMutex;
+int64_t g_installs{0};
+thread_local MemoryScope *t_scope{nullptr};
+
+void RaiseMax(std::atomic<int64_t> &max, int64_t value) {
+  auto current = max.load(std::memory_order_relaxed);
+  while (current < value &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+} // namespace
+
+TrackingMemoryPool::TrackingMemoryPool(arrow::MemoryPool *target)
+    : m_target(target) {}
+
+arrow::Status TrackingMemoryPool::Allocate(int64_t size, int64_t alignment,
+                                           uint8_t **out) {
+  ARROW_RETURN_NOT_OK(m_target->Allocate(size, alignment, out));
+  RaiseMax(m_maxBytes, m_bytes.fetch_add(size) + size);
+  m_totalBytes.fetch_add(size, std::memory_order_relaxed);
+  m_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (t_scope && t_scope->m_pool == this) {
+    t_scope->Observe(m_target->bytes_allocated());
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status TrackingMemoryPool::Reallocate(int64_t oldSize, int64_t newSize,
+                                             int64_t alignment,
+                                             uint8_t **ptr) {
+  ARROW_RETURN_NOT_OK(m_target->Reallocate(oldSize, newSize, alignment, ptr));
+  const auto grown = newSize - oldSize;
+  RaiseMax(m_maxBytes, m_bytes.fetch_add(grown) + grown);
+  if (grown > 0) {
+    m_totalBytes.fetch_add(grown, std::memory_order_relaxed);
+  }
+  if (t_scope && t_scope->m_pool == this) {
+    t_scope->Observe(m_target->bytes_allocated());
+  }
+  return arrow::Status::OK();
+}
+
+void TrackingMemoryPool::Free(uint8_t *buffer, int64_t size,
+                              int64_t alignment) {
+  m_target->Free(buffer, size, alignment);
+  m_bytes.fetch_sub(size);
+}
+
+int64_t TrackingMemoryPool::bytes_allocated() const { return m_bytes.load(); }
+
+int64_t TrackingMemoryPool::total_bytes_allocated() const {
+  return m_totalBytes.load();
+}
+
+int64_t TrackingMemoryPool::num_allocations() const {
+  return m_allocations.load();
+}
+
+int64_t TrackingMemoryPool::max_memory() const { return m_maxBytes.load(); }
+
+std::string TrackingMemoryPool::backend_name() const {
+  return m_target->backend_name();
+}
+
+std::vector<MemoryUsage> TrackingMemoryPool::Report() const {
+  std::vector<MemoryUsage> report;
+  {
+    std::lock_guard lock{m_mutex};
+    report.reserve(m_usage.size());
+    for (auto const &[_, usage] : m_usage) {
+      report.push_back(usage);
+    }
+  }
+  std::ranges::sort(report, [](auto const &lhs, auto const &rhs) {
+    return std::tie(rhs.sampledPeakBytes, lhs.scope) <
+           std::tie(lhs.sampledPeakBytes, rhs.scope);
+  });
+  return report;
+}
+
+void TrackingMemoryPool::Record(MemoryUsage const &usage) {
+  std::lock_guard lock{m_mutex};
+  auto [it, inserted] = m_usage.try_emplace(usage.scope, usage);
+  if (!inserted) {
+    auto &merged = it->second;
+    merged.sampledPeakBytes =
+        std::max(merged.sampledPeakBytes, usage.sampledPeakBytes);
+    merged.totalBytes += usage.totalBytes;
+    merged.allocations += usage.allocations;
+    merged.invocations += usage.invocations;
+  }
+}
+
+InstallMemoryPool::InstallMemoryPool(TrackingMemoryPool &pool) {
+  std::lock_guard lock{g_installMutex};
+  auto *installed = g_installed.load(std::memory_order_relaxed);
+  if (installed && installed != &pool) {
+    throw std::runtime_error(
+        "Another tracking memory pool is already installed");
+  }
+  g_installed.store(&pool, std::memory_order_release);
+  ++g_installs;
+}
+
+InstallMemoryPool::~InstallMemoryPool() {
+  std::lock_guard lock{g_installMutex};
+  if (--g_installs == 0) {
+    g_installed.store(nullptr, std::memory_order_release);
+  }
+}
+
+arrow::MemoryPool *CurrentMemoryPool() {
+  if (auto *pool = g_installed.load(std::memory_order_acquire)) {
+    return pool;
+  }
+  return arrow::default_memory_pool();
+}
+
+MemoryScope::MemoryScope(std::string_view name, std::string_view category) {
+  m_pool = g_installed.load(std::memory_order_acquire);
+  if (!m_pool) {
+    return;
+  }
+  if (t_scope && t_scope->m_pool == m_pool) {
+    m_parent = t_scope;
+  }
+  t_scope = this;
+
+  m_usage.scope = name;
+  m_usage.category = category;
+  m_usage.invocations = 1;
+  auto *target = m_pool->m_target;
+  m_startBytes = target->bytes_allocated();
+  m_startTotal = target->total_bytes_allocated();
+  m_startAllocations = target->num_allocations();
+  m_highBytes = m_startBytes;
+}
+
+MemoryScope::~MemoryScope() {
+  if (!m_pool) {
+    return;
+  }
+  auto *target = m_pool->m_target;
+  Observe(target->bytes_allocated());
+  t_scope = m_parent;
+
+  m_usage.sampledPeakBytes =
+      std::max<int64_t>(m_highBytes - m_startBytes, 0);
+  m_usage.totalBytes = target->total_bytes_allocated() - m_startTotal;
+  m_usage.allocations = target->num_allocations() - m_startAllocations;
+  m_pool->Record(m_usage);
+}
+
+void MemoryScope::Observe(int64_t liveBytes) {
+  for (auto *scope = this; scope; scope = scope->m_parent) {
+    scope->m_highBytes = std::max(scope->m_highBytes, liveBytes);
+  }
+}
+} // namespace epoch_folio
@@ -0,0 +1,119 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <arrow/memory_pool.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace epoch_folio {
+// Memory of one scope (widget, factory stage) over a build, in bytes.
+struct MemoryUsage {
+  std::string scope;
+  std::string category;
+  // Highest live bytes above the level at entry, max over invocations, as
+  // sampled at scope boundaries and at allocations routed through the
+  // tracking pool. Memory allocated and freed between two samples straight
+  // from the default pool (most epoch_frame kernels) is missed, so this is a
+  // lower bound of the true peak.
+  int64_t sampledPeakBytes{};
+  // bytes allocated inside the scope, summed over invocations
+  int64_t totalBytes{};
+  int64_t allocations{};
+  int64_t invocations{};
+};
+
+/*
+Wraps `target` (the default arrow pool unless given) and attributes arrow
+memory to the innermost MemoryScope of the allocating thread.
+
+epoch_frame allocates from the default pool directly, so scopes measure the
+target pool: totals are its allocation growth over the scope and exact,
+peaks are only sampled, see MemoryUsage::sampledPeakBytes. Arrow has no hook
+to observe the default pool, so the build's allocations cannot all be routed
+here. The target counts every thread, so the figures overlap between widgets
+of a parallel build.
+*/
+class TrackingMemoryPool final : public arrow::MemoryPool {
+public:
+  explicit TrackingMemoryPool(
+      arrow::MemoryPool *target = arrow::default_memory_pool());
+
+  using arrow::MemoryPool::Allocate;
+  using arrow::MemoryPool::Free;
+  using arrow::MemoryPool::Reallocate;
+
+  arrow::Status Allocate(int64_t size, int64_t alignment,
+                         uint8_t **out) override;
+  arrow::Status Reallocate(int64_t oldSize, int64_t newSize,
+                           int64_t alignment, uint8_t **ptr) override;
+  void Free(uint8_t *buffer, int64_t size, int64_t alignment) override;
+
+  // allocations routed through this pool only
+  int64_t bytes_allocated() const override;
+  int64_t total_bytes_allocated() const override;
+  int64_t num_allocations() const override;
+  int64_t max_memory() const override;
+  std::string backend_name() const override;
+
+  // every scope seen so far, highest peak first
+  std::vector<MemoryUsage> Report() const;
+
+private:
+  friend class MemoryScope;
+
+  arrow::MemoryPool *m_target;
+  std::atomic<int64_t> m_bytes{0};
+  std::atomic<int64_t> m_totalBytes{0};
+  std::atomic<int64_t> m_allocations{0};
+  std::atomic<int64_t> m_maxBytes{0};
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<std::string, MemoryUsage> m_usage;
+
+  void Record(MemoryUsage const &usage);
+};
+
+// Routes the tear sheet allocations of every thread to `pool` while alive.
+// One pool at a time: installs of the same pool nest, e.g. concurrent builds
+// sharing one tracker, and it stays installed until the last one ends;
+// installing another pool meanwhile throws.
+class InstallMemoryPool {
+public:
+  explicit InstallMemoryPool(TrackingMemoryPool &pool);
+  InstallMemoryPool(InstallMemoryPool const &) = delete;
+  InstallMemoryPool &operator=(InstallMemoryPool const &) = delete;
+  ~InstallMemoryPool();
+};
+
+// the installed pool, the default arrow pool otherwise
+arrow::MemoryPool *CurrentMemoryPool();
+
+// Attributes the memory of the enclosing scope on this thread to `name`, a
+// no-op unless a pool is installed. Nested scopes count toward their parents.
+class MemoryScope {
+public:
+  explicit MemoryScope(std::string_view name, std::string_view category = {});
+  MemoryScope(MemoryScope const &) = delete;
+  MemoryScope &operator=(MemoryScope const &) = delete;
+  ~MemoryScope();
+
+private:
+  TrackingMemoryPool *m_pool{nullptr};
+  MemoryScope *m_parent{nullptr};
+  MemoryUsage m_usage;
+  int64_t m_startBytes{};
+  int64_t m_startTotal{};
+  int64_t m_startAllocations{};
+  int64_t m_highBytes{};
+
+  friend class TrackingMemoryPool;
+  void Observe(int64_t liveBytes);
+};
+} // namespace epoch_folio
@@ -0,0 +1,77 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include <epoch_frame/common.h>
+#include <epoch_frame/dataframe.h>
+#include <epoch_frame/index.h>
+#include <epoch_frame/series.h>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace epoch_folio {
+inline void ThrowIfNotOk(arrow::Status const &status) {
+  if (!status.ok()) {
+    throw std::runtime_error(status.ToString());
+  }
+}
+
+// Copies a numeric column into a dense buffer, nulls become NaN. Used by the
+// single pass kernels that would otherwise pay a Scalar round trip per cell.
+inline std::vector<double> ToDoubleVector(arrow::ChunkedArrayPtr chunked) {
+  if (chunked->type()->id() != arrow::Type::DOUBLE) {
+    chunked = epoch_frame::AssertResultIsOk(
+                  arrow::compute::Cast(chunked, arrow::float64()))
+                  .chunked_array();
+  }
+
+  std::vector<double> out;
+  out.reserve(chunked->length());
+  for (auto const &chunk : chunked->chunks()) {
+    auto const &array = static_cast<arrow::DoubleArray const &>(*chunk);
+    const auto *raw = array.raw_values();
+    if (array.null_count() == 0) {
+      out.insert(out.end(), raw, raw + array.length());
+      continue;
+    }
+    for (int64_t i = 0; i < array.length(); ++i) {
+      out.push_back(array.IsNull(i) ? std::numeric_limits<double>::quiet_NaN()
+                                    : raw[i]);
+    }
+  }
+  return out;
+}
+
+inline std::vector<double> ToDoubleVector(epoch_frame::Series const &series) {
+  return ToDoubleVector(series.array());
+}
+
+// Raw int64 payload of a timestamp column (unit preserved, nulls read as
+// INT64_MIN so they sort first and never match a join key).
+inline std::vector<int64_t> ToTimestampVector(arrow::ChunkedArrayPtr const &chunked) {
+  if (chunked->type()->id() != arrow::Type::TIMESTAMP) {
+    throw std::runtime_error("expected timestamp column, got: " +
+                             chunked->type()->ToString());
+  }
+
+  std::vector<int64_t> out;
+  out.reserve(chunked->length());
+  for (auto const &chunk : chunked->chunks()) {
+    auto const &array = static_cast<arrow::TimestampArray const &>(*chunk);
+    const auto *raw = array.raw_values();
+    for (int64_t i = 0; i < array.length(); ++i) {
+      out.push_back(array.IsNull(i) ? std::numeric_limits<int64_t>::min()
+                                    : raw[i]);
+    }
+  }
+  return out;
+}
+
+inline std::vector<int64_t> ToTimestampVector(epoch_frame::IndexPtr const &index) {
+  return ToTimestampVector(index->as_chunked_array());
+}
+} // namespace epoch_folio
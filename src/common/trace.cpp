@@ -0,0 +1,145 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "trace.h"
+#include <algorithm>
+#include <arrow/memory_pool.h>
+#include <chrono>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace epoch_folio::trace {
+namespace {
+struct ThreadBuffer {
+  std::mutex mutex;
+  std::vector<SpanRecord> records;
+  uint32_t threadId{};
+};
+
+struct Registry {
+  std::mutex mutex;
+  // kept after their thread exits so its spans can still be drained
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  const std::chrono::steady_clock::time_point origin =
+      std::chrono::steady_clock::now();
+};
+
+Registry &GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+ThreadBuffer &LocalBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+    auto &registry = GetRegistry();
+    auto created = std::make_shared<ThreadBuffer>();
+    std::lock_guard lock{registry.mutex};
+    created->threadId = static_cast<uint32_t>(registry.buffers.size()) + 1;
+    registry.buffers.push_back(created);
+    return created;
+  }();
+  return *buffer;
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - GetRegistry().origin)
+      .count();
+}
+
+int64_t ThreadCpuNs() {
+  timespec ts{};
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+void AppendEscaped(std::string &out, std::string_view text) {
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out += std::format("\\u{:04x}", static_cast<int>(c));
+    } else {
+      out += c;
+    }
+  }
+}
+} // namespace
+
+void Span::Begin(std::string_view name, std::string_view category) {
+  m_active = true;
+  m_record.name = name;
+  m_record.category = category;
+  m_startArrowBytes = arrow::default_memory_pool()->total_bytes_allocated();
+  m_startCpuNs = ThreadCpuNs();
+  m_record.startNs = NowNs();
+}
+
+void Span::End() {
+  m_record.wallNs = NowNs() - m_record.startNs;
+  m_record.cpuNs = ThreadCpuNs() - m_startCpuNs;
+  m_record.arrowBytes =
+      arrow::default_memory_pool()->total_bytes_allocated() -
+      m_startArrowBytes;
+
+  auto &buffer = LocalBuffer();
+  m_record.threadId = buffer.threadId;
+  std::lock_guard lock{buffer.mutex};
+  buffer.records.push_back(std::move(m_record));
+}
+
+std::vector<SpanRecord> Drain() {
+  std::vector<SpanRecord> records;
+  auto &registry = GetRegistry();
+  std::lock_guard lock{registry.mutex};
+  for (auto const &buffer : registry.buffers) {
+    std::lock_guard bufferLock{buffer->mutex};
+    std::ranges::move(buffer->records, std::back_inserter(records));
+    buffer->records.clear();
+  }
+  std::ranges::stable_sort(records, {}, &SpanRecord::startNs);
+  return records;
+}
+
+std::string ToChromeTrace(std::vector<SpanRecord> const &records) {
+  std::string out = R"({"displayTimeUnit":"ms","traceEvents":[)";
+  bool first = true;
+  for (auto const &record : records) {
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    out += R"({"name":")";
+    AppendEscaped(out, record.name);
+    out += R"(","cat":")";
+    AppendEscaped(out, record.category);
+    out += std::format(
+        R"(","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},)"
+        R"("args":{{"cpu_us":{:.3f},"arrow_bytes":{})",
+        record.threadId, static_cast<double>(record.startNs) / 1e3,
+        static_cast<double>(record.wallNs) / 1e3,
+        static_cast<double>(record.cpuNs) / 1e3, record.arrowBytes);
+    if (record.rows >= 0) {
+      out += std::format(R"(,"rows":{})", record.rows);
+    }
+    out += "}}";
+  }
+  out += "]}";
+  return out;
+}
+
+void WriteChromeTrace(std::string const &path) {
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  if (!file) {
+    throw std::runtime_error("Failed to open trace file: " + path);
+  }
+  file << ToChromeTrace(Drain());
+}
+} // namespace epoch_folio::trace
@@ -0,0 +1,88 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace epoch_folio::trace {
+// One finished span, times in nanoseconds.
+struct SpanRecord {
+  std::string name;
+  std::string category;
+  int64_t startNs{}; // since the first span of the process
+  int64_t wallNs{};
+  int64_t cpuNs{}; // cpu time of the recording thread
+  uint32_t threadId{};
+  int64_t rows{-1}; // -1 when not reported
+  // growth of the default arrow pool's total allocations, which counts every
+  // thread, so nested and concurrent spans overlap
+  int64_t arrowBytes{};
+};
+
+namespace detail {
+inline std::atomic<bool> g_enabled{false};
+}
+
+// off by default; while off a span costs one relaxed load
+inline void Enable(bool enabled = true) {
+  detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+inline bool Enabled() {
+  return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/*
+Times the enclosing scope when tracing is enabled at construction. Records go
+to a buffer of the recording thread, so spans on different threads never
+contend.
+*/
+class Span {
+public:
+  explicit Span(std::string_view name, std::string_view category = "folio") {
+    if (Enabled()) {
+      Begin(name, category);
+    }
+  }
+  Span(Span const &) = delete;
+  Span &operator=(Span const &) = delete;
+  ~Span() {
+    if (m_active) {
+      End();
+    }
+  }
+
+  void SetRows(int64_t rows) { m_record.rows = rows; }
+
+private:
+  bool m_active{false};
+  SpanRecord m_record;
+  int64_t m_startCpuNs{};
+  int64_t m_startArrowBytes{};
+
+  void Begin(std::string_view name, std::string_view category);
+  void End();
+};
+
+// takes the records of every thread, oldest first
+std::vector<SpanRecord> Drain();
+
+// Chrome trace event JSON ("X" events), loadable in chrome://tracing and
+// Perfetto; cpu time, rows and arrow bytes go into each event's args
+std::string ToChromeTrace(std::vector<SpanRecord> const &records);
+
+// drains and writes ToChromeTrace to `path`
+void WriteChromeTrace(std::string const &path);
+} // namespace epoch_folio::trace
+
+#define EPOCH_FOLIO_TRACE_CONCAT_(a, b) a##b
+#define EPOCH_FOLIO_TRACE_CONCAT(a, b) EPOCH_FOLIO_TRACE_CONCAT_(a, b)
+// spans the rest of the scope: EPOCH_FOLIO_TRACE("RollingBeta");
+#define EPOCH_FOLIO_TRACE(...)                                                 \
+  ::epoch_folio::trace::Span EPOCH_FOLIO_TRACE_CONCAT(epochFolioSpan,          \
+                                                      __LINE__){__VA_ARGS__}
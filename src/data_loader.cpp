@@ -0,0 +1,407 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "epoch_folio/data_loader.h"
+#include "common/series_helper.h"
+#include "common/trace.h"
+#include <algorithm>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <cctype>
+#include <epoch_frame/factory/index_factory.h>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <numeric>
+#include <parquet/arrow/reader.h>
+#include <parquet/arrow/schema.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+#include <span>
+#include <stdexcept>
+
+namespace epoch_folio
+{
+  namespace
+  {
+    const auto kUtcNanos = arrow::timestamp(arrow::TimeUnit::NANO, "UTC");
+
+    // [lo, hi) in the unit of the time column
+    struct TimeRange
+    {
+      int64_t lo{std::numeric_limits<int64_t>::min()};
+      int64_t hi{std::numeric_limits<int64_t>::max()};
+
+      bool Overlaps(int64_t first, int64_t last) const
+      {
+        return last >= lo && first < hi;
+      }
+    };
+
+    int64_t NanosPerUnit(arrow::DataType const &type)
+    {
+      if (type.id() != arrow::Type::TIMESTAMP)
+      {
+        return 1;
+      }
+      switch (static_cast<arrow::TimestampType const &>(type).unit())
+      {
+      case arrow::TimeUnit::SECOND:
+        return 1'000'000'000;
+      case arrow::TimeUnit::MILLI:
+        return 1'000'000;
+      case arrow::TimeUnit::MICRO:
+        return 1'000;
+      case arrow::TimeUnit::NANO:
+        return 1;
+      }
+      return 1;
+    }
+
+    int64_t CeilDiv(int64_t value, int64_t divisor)
+    {
+      const auto quotient = value / divisor;
+      return value % divisor != 0 && value > 0 ? quotient + 1 : quotient;
+    }
+
+    // v * unit >= start <=> v >= ceil(start / unit), same for v * unit < end
+    TimeRange ToColumnUnit(std::optional<int64_t> start,
+                           std::optional<int64_t> end,
+                           arrow::DataType const &type)
+    {
+      const auto unit = NanosPerUnit(type);
+      TimeRange range;
+      if (start)
+      {
+        range.lo = CeilDiv(*start, unit);
+      }
+      if (end)
+      {
+        range.hi = CeilDiv(*end, unit);
+      }
+      return range;
+    }
+
+    std::span<const int64_t> RawTimes(arrow::Array const &array)
+    {
+      return {array.data()->GetValues<int64_t>(1),
+              static_cast<size_t>(array.length())};
+    }
+
+    int64_t LowerBound(arrow::ChunkedArray const &times, int64_t value)
+    {
+      int64_t offset = 0;
+      for (auto const &chunk : times.chunks())
+      {
+        const auto raw = RawTimes(*chunk);
+        if (!raw.empty() && raw.back() >= value)
+        {
+          return offset + (std::ranges::lower_bound(raw, value) - raw.begin());
+        }
+        offset += chunk->length();
+      }
+      return offset;
+    }
+
+    void AssertTimeColumn(arrow::Schema const &schema,
+                          TableSource const &source)
+    {
+      const auto field = schema.GetFieldByName(source.timeColumn);
+      if (!field)
+      {
+        throw std::runtime_error(std::format("{} has no time column {}",
+                                             source.path, source.timeColumn));
+      }
+      const auto type = field->type()->id();
+      if (type != arrow::Type::TIMESTAMP && type != arrow::Type::INT64)
+      {
+        throw std::runtime_error(
+            std::format("time column {} of {} is {}", source.timeColumn,
+                        source.path, field->type()->ToString()));
+      }
+    }
+
+    std::vector<int> Projection(arrow::Schema const &schema,
+                                TableSource const &source)
+    {
+      AssertTimeColumn(schema, source);
+      if (source.columns.empty())
+      {
+        std::vector<int> all(schema.num_fields());
+        std::iota(all.begin(), all.end(), 0);
+        return all;
+      }
+
+      std::vector<int> fields{schema.GetFieldIndex(source.timeColumn)};
+      for (auto const &column : source.columns)
+      {
+        const auto i = schema.GetFieldIndex(column);
+        if (i < 0)
+        {
+          throw std::runtime_error(
+              std::format("{} has no column {}", source.path, column));
+        }
+        fields.push_back(i);
+      }
+      // readers return projected columns in file order
+      std::ranges::sort(fields);
+      fields.erase(std::ranges::unique(fields).begin(), fields.end());
+      return fields;
+    }
+
+    arrow::TablePtr ReadIpc(TableSource const &source,
+                            std::optional<int64_t> start,
+                            std::optional<int64_t> end)
+    {
+      auto file =
+          epoch_frame::AssertResultIsOk(arrow::io::MemoryMappedFile::Open(
+              source.path, arrow::io::FileMode::READ));
+      auto schema = epoch_frame::AssertResultIsOk(
+                        arrow::ipc::RecordBatchFileReader::Open(file))
+                        ->schema();
+
+      auto options = arrow::ipc::IpcReadOptions::Defaults();
+      options.included_fields = Projection(*schema, source);
+      auto reader = epoch_frame::AssertResultIsOk(
+          arrow::ipc::RecordBatchFileReader::Open(file, options));
+
+      const auto time = reader->schema()->GetFieldIndex(source.timeColumn);
+      const auto range = ToColumnUnit(
+          start, end, *reader->schema()->field(time)->type());
+
+      // batches point into the mapping, only the bounds of skipped ones are
+      // ever touched
+      arrow::RecordBatchVector batches;
+      for (int i = 0; i < reader->num_record_batches(); ++i)
+      {
+        auto batch =
+            epoch_frame::AssertResultIsOk(reader->ReadRecordBatch(i));
+        const auto times = RawTimes(*batch->column(time));
+        if (!times.empty() && range.Overlaps(times.front(), times.back()))
+        {
+          batches.push_back(std::move(batch));
+        }
+      }
+      return epoch_frame::AssertResultIsOk(
+          arrow::Table::FromRecordBatches(reader->schema(), batches));
+    }
+
+    // parquet leaf column of top level arrow field `field`; leaves are
+    // numbered depth first, so a nested field before it shifts the numbers
+    int LeafColumn(parquet::arrow::SchemaManifest const &manifest, int field,
+                   TableSource const &source)
+    {
+      auto const &schemaField = manifest.schema_fields.at(field);
+      if (!schemaField.is_leaf())
+      {
+        throw std::runtime_error(
+            std::format("{}: nested column {} is not supported", source.path,
+                        schemaField.field->name()));
+      }
+      return schemaField.column_index;
+    }
+
+    arrow::TablePtr ReadParquet(TableSource const &source,
+                                std::optional<int64_t> start,
+                                std::optional<int64_t> end)
+    {
+      auto file =
+          epoch_frame::AssertResultIsOk(arrow::io::MemoryMappedFile::Open(
+              source.path, arrow::io::FileMode::READ));
+      auto reader = epoch_frame::AssertResultIsOk(
+          parquet::arrow::OpenFile(file, arrow::default_memory_pool()));
+
+      std::shared_ptr<arrow::Schema> schema;
+      ThrowIfNotOk(reader->GetSchema(&schema));
+      auto const &manifest = reader->manifest();
+      std::vector<int> columns;
+      for (const auto field : Projection(*schema, source))
+      {
+        columns.push_back(LeafColumn(manifest, field, source));
+      }
+
+      const auto timeField = schema->GetFieldIndex(source.timeColumn);
+      const auto time = LeafColumn(manifest, timeField, source);
+      const auto range =
+          ToColumnUnit(start, end, *schema->field(timeField)->type());
+      const auto metadata = reader->parquet_reader()->metadata();
+
+      std::vector<int> rowGroups;
+      for (int g = 0; g < metadata->num_row_groups(); ++g)
+      {
+        const auto stats =
+            metadata->RowGroup(g)->ColumnChunk(time)->statistics();
+        if (stats && stats->HasMinMax() &&
+            stats->physical_type() == parquet::Type::INT64)
+        {
+          const auto &typed =
+              static_cast<parquet::Int64Statistics const &>(*stats);
+          if (!range.Overlaps(typed.min(), typed.max()))
+          {
+            continue;
+          }
+        }
+        rowGroups.push_back(g);
+      }
+
+      arrow::TablePtr table;
+      ThrowIfNotOk(reader->ReadRowGroups(rowGroups, columns, &table));
+      return table;
+    }
+
+    // slices away the rows of kept batches or row groups that straddle the
+    // range, the time column must be sorted
+    arrow::TablePtr SliceByTime(arrow::TablePtr const &table,
+                                std::string const &timeColumn,
+                                std::optional<int64_t> start,
+                                std::optional<int64_t> end)
+    {
+      if (!start && !end)
+      {
+        return table;
+      }
+      const auto times = table->GetColumnByName(timeColumn);
+      const auto range = ToColumnUnit(start, end, *times->type());
+      const auto begin = LowerBound(*times, range.lo);
+      const auto stop = LowerBound(*times, range.hi);
+      return table->Slice(begin, std::max<int64_t>(stop - begin, 0));
+    }
+
+    arrow::ChunkedArrayPtr ToUtcNanos(arrow::ChunkedArrayPtr const &column)
+    {
+      if (column->type()->Equals(*kUtcNanos))
+      {
+        return column;
+      }
+      if (column->type()->id() == arrow::Type::INT64)
+      {
+        // epoch nanoseconds share the layout, so this is a view
+        arrow::ArrayVector chunks;
+        chunks.reserve(column->num_chunks());
+        for (auto const &chunk : column->chunks())
+        {
+          chunks.push_back(
+              epoch_frame::AssertResultIsOk(chunk->View(kUtcNanos)));
+        }
+        return std::make_shared<arrow::ChunkedArray>(std::move(chunks),
+                                                     kUtcNanos);
+      }
+      return epoch_frame::AssertResultIsOk(
+                 arrow::compute::Cast(column, kUtcNanos))
+          .chunked_array();
+    }
+
+    arrow::TablePtr NormalizeTimestamps(arrow::TablePtr table,
+                                        std::string const &timeColumn)
+    {
+      for (int i = 0; i < table->num_columns(); ++i)
+      {
+        const auto &field = table->field(i);
+        const bool isTime = field->name() == timeColumn;
+        if ((isTime || field->type()->id() == arrow::Type::TIMESTAMP) &&
+            !field->type()->Equals(*kUtcNanos))
+        {
+          table = epoch_frame::AssertResultIsOk(table->SetColumn(
+              i, field->WithType(kUtcNanos), ToUtcNanos(table->column(i))));
+        }
+      }
+      return table;
+    }
+
+    std::string RenamedTimeColumn(TableSource const &source)
+    {
+      auto it = source.rename.find(source.timeColumn);
+      return it == source.rename.end() ? source.timeColumn : it->second;
+    }
+
+    epoch_frame::Series LoadSeries(TableSource const &source,
+                                   std::optional<int64_t> start,
+                                   std::optional<int64_t> end)
+    {
+      if (!source.setIndex)
+      {
+        throw std::runtime_error(std::format(
+            "{} feeds a series and must be indexed by time", source.path));
+      }
+      const auto frame = LoadTable(source, start, end);
+      const auto columns = frame.column_names().size();
+      if (columns != 1)
+      {
+        throw std::runtime_error(std::format(
+            "{} must project exactly one value column, got {}", source.path,
+            columns));
+      }
+      return frame.to_series();
+    }
+
+    bool IsParquet(std::string const &path)
+    {
+      auto extension = std::filesystem::path{path}.extension().string();
+      std::ranges::transform(extension, extension.begin(), [](unsigned char c)
+                             { return static_cast<char>(std::tolower(c)); });
+      return extension == ".parquet" || extension == ".pq";
+    }
+  } // namespace
+
+  epoch_frame::DataFrame LoadTable(TableSource const &source,
+                                   std::optional<int64_t> start,
+                                   std::optional<int64_t> end)
+  {
+    trace::Span span{"LoadTable", "io"};
+    auto table = IsParquet(source.path) ? ReadParquet(source, start, end)
+                                        : ReadIpc(source, start, end);
+    table = SliceByTime(table, source.timeColumn, start, end);
+    table = NormalizeTimestamps(std::move(table), source.timeColumn);
+
+    if (!source.rename.empty())
+    {
+      auto names = table->ColumnNames();
+      for (auto &name : names)
+      {
+        if (auto it = source.rename.find(name); it != source.rename.end())
+        {
+          name = it->second;
+        }
+      }
+      table = epoch_frame::AssertResultIsOk(table->RenameColumns(names));
+    }
+
+    span.SetRows(table->num_rows());
+    epoch_frame::DataFrame frame{
+        epoch_frame::factory::index::from_range(table->num_rows()), table};
+    return source.setIndex ? frame.set_index(RenamedTimeColumn(source))
+                           : frame;
+  }
+
+  TearSheetDataOption LoadTearSheetData(TearSheetSources const &sources)
+  {
+    const auto start = sources.start;
+    const auto end = sources.end;
+
+    TearSheetDataOption data;
+    data.equity = LoadSeries(sources.equity, start, end);
+    if (sources.benchmark)
+    {
+      data.benchmark = LoadSeries(*sources.benchmark, start, end);
+    }
+    if (sources.cash)
+    {
+      data.cash = LoadSeries(*sources.cash, start, end);
+    }
+    if (sources.positions)
+    {
+      data.positions = LoadTable(*sources.positions, start, end);
+    }
+    if (sources.transactions)
+    {
+      data.transactions = LoadTable(*sources.transactions, start, end);
+    }
+    if (sources.roundTrip)
+    {
+      data.roundTrip = LoadTable(*sources.roundTrip, start, end);
+    }
+    return data;
+  }
+} // namespace epoch_folio
@@ -0,0 +1,209 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "align.h"
+#include "common/memory_tracker.h"
+#include "common/series_helper.h"
+#include "common/trace.h"
+#include <algorithm>
+#include <cmath>
+#include <epoch_frame/factory/series_factory.h>
+#include <limits>
+#include <stdexcept>
+
+namespace epoch_folio {
+MergeAlignment MergeAlign(std::span<const std::vector<int64_t>> indexes,
+                          epoch_core::AlignFill fill) {
+  const auto n = indexes.size();
+  MergeAlignment out;
+  out.rows.resize(n);
+
+  int64_t start = std::numeric_limits<int64_t>::min();
+  for (auto const &index : indexes) {
+    if (index.empty()) {
+      return out;
+    }
+    start = std::max(start, index.front());
+  }
+
+  // rows before `start` are only ever read as the previous row
+  std::vector<size_t> cursor(n);
+  for (size_t k = 0; k < n; ++k) {
+    cursor[k] = std::ranges::lower_bound(indexes[k], start) -
+                indexes[k].begin();
+  }
+
+  std::vector<bool> exact(n);
+  while (true) {
+    auto t = std::numeric_limits<int64_t>::max();
+    bool done = true;
+    for (size_t k = 0; k < n; ++k) {
+      if (cursor[k] < indexes[k].size()) {
+        t = std::min(t, indexes[k][cursor[k]]);
+        done = false;
+      }
+    }
+    if (done) {
+      break;
+    }
+
+    bool all = true;
+    for (size_t k = 0; k < n; ++k) {
+      exact[k] = cursor[k] < indexes[k].size() && indexes[k][cursor[k]] == t;
+      all = all && exact[k];
+    }
+
+    if (fill != epoch_core::AlignFill::Intersect || all) {
+      out.timestamps.push_back(t);
+      for (size_t k = 0; k < n; ++k) {
+        const auto row = static_cast<int64_t>(cursor[k]);
+        out.rows[k].push_back(
+            exact[k] ? row
+                     : (fill == epoch_core::AlignFill::ForwardFill ? row - 1
+                                                                   : kNoMatch));
+      }
+    }
+    for (size_t k = 0; k < n; ++k) {
+      cursor[k] += exact[k] ? 1 : 0;
+    }
+  }
+  return out;
+}
+
+namespace {
+struct GatheredReturns {
+  MergeAlignment alignment;
+  // per input, filled but not yet filtered
+  std::vector<std::vector<double>> columns;
+  // rows without a null left in any input
+  std::vector<bool> keep;
+  epoch_frame::IndexPtr index;
+};
+
+GatheredReturns GatherReturns(std::vector<epoch_frame::Series> const &series,
+                              epoch_core::AlignFill fill) {
+  std::vector<std::vector<int64_t>> indexes;
+  indexes.reserve(series.size());
+  const auto type = series.front().index()->dtype();
+  for (auto const &s : series) {
+    if (!s.index()->dtype()->Equals(*type)) {
+      throw std::runtime_error("cannot align returns indexed by " +
+                               type->ToString() + " and " +
+                               s.index()->dtype()->ToString());
+    }
+    indexes.push_back(ToTimestampVector(s.index()));
+    if (std::ranges::adjacent_find(indexes.back(), std::greater_equal{}) !=
+        indexes.back().end()) {
+      throw std::runtime_error("returns index must be sorted and unique");
+    }
+  }
+
+  GatheredReturns out{MergeAlign(indexes, fill), {}, {}, nullptr};
+  auto const &alignment = out.alignment;
+  const auto rows = alignment.timestamps.size();
+
+  // gather, fill nulls per column, then keep the rows with no null left
+  out.columns.resize(series.size());
+  out.keep.assign(rows, true);
+  for (size_t k = 0; k < series.size(); ++k) {
+    const auto values = ToDoubleVector(series[k]);
+    auto &column = out.columns[k];
+    column.resize(rows);
+    double last = std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < rows; ++i) {
+      const auto row = alignment.rows[k][i];
+      auto value = row == kNoMatch ? std::numeric_limits<double>::quiet_NaN()
+                                   : values[row];
+      if (std::isnan(value)) {
+        if (fill == epoch_core::AlignFill::ForwardFill) {
+          value = last;
+        } else if (fill == epoch_core::AlignFill::Zero) {
+          value = 0.0;
+        }
+      }
+      last = std::isnan(value) ? last : value;
+      column[i] = value;
+      out.keep[i] = out.keep[i] && !std::isnan(value);
+    }
+  }
+
+  arrow::TimestampBuilder timestamps(type, CurrentMemoryPool());
+  ThrowIfNotOk(timestamps.Reserve(static_cast<int64_t>(rows)));
+  for (size_t i = 0; i < rows; ++i) {
+    if (out.keep[i]) {
+      timestamps.UnsafeAppend(alignment.timestamps[i]);
+    }
+  }
+  out.index = series.front().index()->Make(timestamps.Finish().ValueOrDie());
+  return out;
+}
+
+epoch_frame::Series KeptSeries(GatheredReturns const &gathered, size_t k) {
+  std::vector<double> kept;
+  kept.reserve(gathered.index->size());
+  for (size_t i = 0; i < gathered.keep.size(); ++i) {
+    if (gathered.keep[i]) {
+      kept.push_back(gathered.columns[k][i]);
+    }
+  }
+  return epoch_frame::make_series(gathered.index, kept);
+}
+
+bool HasNull(std::vector<double> const &values) {
+  return std::ranges::any_of(values, [](double v) { return std::isnan(v); });
+}
+} // namespace
+
+std::vector<epoch_frame::Series>
+AlignReturns(std::vector<epoch_frame::Series> const &series,
+             epoch_core::AlignFill fill) {
+  EPOCH_FOLIO_TRACE("AlignReturns");
+  if (series.size() < 2) {
+    return series;
+  }
+
+  const auto gathered = GatherReturns(series, fill);
+  std::vector<epoch_frame::Series> out;
+  out.reserve(series.size());
+  for (size_t k = 0; k < series.size(); ++k) {
+    out.push_back(KeptSeries(gathered, k));
+  }
+  return out;
+}
+
+ReturnsAlignment::ReturnsAlignment(epoch_frame::Series const &strategy,
+                                   epoch_frame::Series const &benchmark,
+                                   epoch_core::AlignFill fill)
+    : m_strategyIndex(strategy.index()), m_fill(fill),
+      m_reusable(!HasNull(ToDoubleVector(strategy))) {
+  EPOCH_FOLIO_TRACE("ReturnsAlignment");
+  const auto gathered = GatherReturns({strategy, benchmark}, fill);
+  m_benchmark = KeptSeries(gathered, 1);
+  m_rows.reserve(gathered.index->size());
+  for (size_t i = 0; i < gathered.keep.size(); ++i) {
+    if (gathered.keep[i]) {
+      m_rows.push_back(gathered.alignment.rows[0][i]);
+    }
+  }
+}
+
+bool ReturnsAlignment::Applies(epoch_frame::Series const &strategy,
+                               epoch_core::AlignFill fill) const {
+  return m_reusable && fill == m_fill &&
+         strategy.index()->equals(m_strategyIndex) &&
+         !HasNull(ToDoubleVector(strategy));
+}
+
+epoch_frame::Series
+ReturnsAlignment::Apply(epoch_frame::Series const &strategy) const {
+  const auto values = ToDoubleVector(strategy);
+  std::vector<double> aligned(m_rows.size());
+  for (size_t i = 0; i < m_rows.size(); ++i) {
+    // a forward filled row reads the previous strategy row and never misses
+    // once kept, so a kept miss is a zero filled one
+    aligned[i] = m_rows[i] == kNoMatch ? 0.0 : values[m_rows[i]];
+  }
+  return epoch_frame::make_series(m_benchmark.index(), aligned);
+}
+} // namespace epoch_folio
@@ -0,0 +1,69 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include "common/asof_join.h"
+#include "model.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace epoch_folio {
+struct MergeAlignment {
+  std::vector<int64_t> timestamps;
+  // rows[k][i] is the row of input k read at timestamps[i], or kNoMatch
+  std::vector<std::vector<int64_t>> rows;
+};
+
+/*
+Merge-joins ascending, unique int64 timestamp columns in one pass. Output
+timestamps start at the latest first timestamp of the inputs, so no input is
+read before it begins. ForwardFill and Zero keep the union of the remaining
+timestamps (an input lacking one reads its previous row or kNoMatch
+respectively), Intersect keeps only the timestamps every input has.
+*/
+MergeAlignment MergeAlign(std::span<const std::vector<int64_t>> indexes,
+                          epoch_core::AlignFill fill);
+
+/*
+Aligns returns series with different timestamp indexes onto one index, the
+replacement for concat + ffill + drop_null. Null returns are forward filled
+(ForwardFill), zeroed (Zero) or drop their row (Intersect); rows still holding
+a null are dropped. The indexes must be sorted, unique and of one type.
+*/
+std::vector<epoch_frame::Series>
+AlignReturns(std::vector<epoch_frame::Series> const &series,
+             epoch_core::AlignFill fill);
+
+/*
+AlignReturns of a strategy against a benchmark, made once and applied to
+every strategy on the same index. Without a null in the strategy the rows kept
+depend on the indexes and the benchmark alone, so Apply(other) equals
+AlignReturns({other, benchmark}, fill)[0] whenever Applies(other, fill).
+*/
+class ReturnsAlignment {
+public:
+  ReturnsAlignment(epoch_frame::Series const &strategy,
+                   epoch_frame::Series const &benchmark,
+                   epoch_core::AlignFill fill);
+
+  // the benchmark on the aligned index
+  epoch_frame::Series const &Benchmark() const { return m_benchmark; }
+
+  // `strategy` holds no null and shares the index this was made for
+  bool Applies(epoch_frame::Series const &strategy,
+               epoch_core::AlignFill fill) const;
+
+  epoch_frame::Series Apply(epoch_frame::Series const &strategy) const;
+
+private:
+  epoch_frame::IndexPtr m_strategyIndex;
+  epoch_core::AlignFill m_fill;
+  // the strategy it was made from held no null
+  bool m_reusable;
+  epoch_frame::Series m_benchmark;
+  // strategy row read at each aligned row, kNoMatch when zero filled
+  std::vector<int64_t> m_rows;
+};
+} // namespace epoch_folio
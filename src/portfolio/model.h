@@ -3,6 +3,8 @@
 //
 
 #pragma once
+#include <algorithm>
+#include <chrono>
 #include <epoch_core/enum_wrapper.h>
 #include <epoch_frame/common.h>
 #include <epoch_frame/dataframe.h>
@@ -11,10 +13,16 @@
 #include <epoch_protos/chart_def.pb.h>
 #include <epoch_protos/common.pb.h>
 #include <epoch_protos/table_def.pb.h>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 CREATE_ENUM(TurnoverDenominator, AGB, PortfolioValue);
+CREATE_ENUM(RoundTripMatching, FIFO, LIFO, AverageCost);
+// ForwardFill carries the last return over timestamps a series lacks, Zero
+// books them as a zero return, Intersect keeps shared timestamps only
+CREATE_ENUM(AlignFill, ForwardFill, Zero, Intersect);
 
 namespace epoch_folio {
 using ColumnDefs = std::vector<epoch_proto::ColumnDef>;
@@ -104,6 +112,36 @@ MakeDataFrame(std::vector<epoch_frame::Series> const &series,
 
 using SectorMapping = std::unordered_map<std::string, std::string>;
 
+constexpr int32_t kUnclassified = -1;
+
+// One level of an asset hierarchy (sector, industry, country, ...) encoded as
+// dense integer codes: codes[i] is the bucket of AssetClassification::assets[i]
+// and labels[code] its display name.
+struct ClassificationLevel {
+  std::string id;
+  std::string name;
+  std::vector<std::string> labels;
+  std::vector<int32_t> codes;
+};
+
+struct AssetClassification {
+  std::vector<std::string> assets;
+  std::vector<ClassificationLevel> levels;
+};
+
+struct LevelExposure {
+  std::string id;
+  std::string name;
+  epoch_frame::DataFrame net{EMPTY_DATAFRAME}, gross{EMPTY_DATAFRAME},
+      longs{EMPTY_DATAFRAME}, shorts{EMPTY_DATAFRAME};
+};
+using LevelExposures = std::vector<LevelExposure>;
+
+struct NamedBenchmark {
+  std::string name;
+  epoch_frame::Series returns;
+};
+
 struct TearSheetDataOption {
   epoch_frame::Series equity;
   std::optional<epoch_frame::Series> benchmark;
@@ -113,8 +151,33 @@ struct TearSheetDataOption {
   epoch_frame::DataFrame roundTrip;
   SectorMapping sectorMapping;
   bool isEquity{true};
+  std::optional<AssetClassification> classification{std::nullopt};
+  // used to match `transactions` into round trips when `roundTrip` is empty
+  epoch_core::RoundTripMatching roundTripMatching{
+      epoch_core::RoundTripMatching::FIFO};
+  // compared next to `benchmark`, e.g. a sector ETF or a custom composite
+  std::vector<NamedBenchmark> benchmarks{};
+  // aligns the strategy with every benchmark onto one index
+  epoch_core::AlignFill benchmarkFill{epoch_core::AlignFill::ForwardFill};
 };
 
+// Subset of the tear sheet to build. A widget is built when its category (see
+// epoch_folio::categories) or its widget id (e.g. "rolling_beta", "underwater",
+// "xrange") is listed; an empty selection builds everything.
+struct WidgetSelection {
+  std::vector<std::string> categories{};
+  std::vector<std::string> widgets{};
+
+  bool empty() const { return categories.empty() && widgets.empty(); }
+
+  bool Selects(std::string const &id, std::string const &category) const {
+    return empty() || std::ranges::contains(categories, category) ||
+           std::ranges::contains(widgets, id);
+  }
+};
+
+class TrackingMemoryPool;
+
 struct TearSheetOption {
   epoch_core::TurnoverDenominator turnoverDenominator =
       epoch_core::TurnoverDenominator::AGB;
@@ -127,5 +190,25 @@ struct TearSheetOption {
   std::optional<InterestingDateRanges> interestingDateRanges{std::nullopt};
   size_t transactionBinMinutes{5};
   std::string transactionTimezone{"America/New_York"};
+  // per-symbol round trip table keeps the best and worst k symbols by mean
+  // return, 0 = all. With more than 2k symbols the rest are left out of the
+  // table, set 0 for the complete table
+  size_t topKRoundTripSymbols{25};
+  // a round trip takes the last portfolio value at or before its close; one
+  // older than this is treated as missing, leaving the trip's return null.
+  // Unset matches however old
+  std::optional<std::chrono::nanoseconds> roundTripValueTolerance{};
+  // points kept per line chart, decimated with LTTB while keeping extrema and
+  // drawdown band edges, 0 = every point
+  size_t maxChartPoints{0};
+  // build independent widgets concurrently, the output matches a serial run
+  bool parallel{true};
+  WidgetSelection selection{};
+  // installed for the build, which appends its per-widget peak and total
+  // bytes as a "Memory" table; not part of any cache key. A tracked build
+  // never returns a whole tear sheet from the disk cache, but widgets reused
+  // from the caches do not run and report no memory. Concurrent builds may
+  // share one tracker, their figures then overlap
+  std::shared_ptr<TrackingMemoryPool> memoryTracker{};
 };
 } // namespace epoch_folio
\ No newline at end of file
@@ -8,6 +8,11 @@
 #include <epoch_frame/frame_or_series.h>
 #include <epoch_frame/common.h>
 #include <epoch_frame/factory/dataframe_factory.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <format>
+#include <map>
+#include <stdexcept>
+#include "common/series_helper.h"
 
 namespace epoch_folio {
 
@@ -51,28 +56,148 @@ namespace epoch_folio {
 
     epoch_frame::DataFrame GetSectorExposure(const epoch_frame::DataFrame &positions,
                                      const std::unordered_map<std::string, std::string> &sectorMapping) {
-        auto index = positions.index();
-        std::unordered_map<std::string, std::pair<std::vector<std::string>, arrow::ChunkedArrayVector>> grouper;
-        for (auto const &asset: positions.column_names()) {
-            auto sectorIter = sectorMapping.find(asset);
-            if (sectorIter != sectorMapping.end()) {
-                auto sector = sectorIter->second;
-                grouper[sector].first.emplace_back(asset);
-                grouper[sector].second.emplace_back(positions[asset].array());
-            } else {
-                SPDLOG_WARN("Warning: {} has no sector mapping. They will not be included in sector allocations",
-                            asset);
+        auto assets = positions.column_names();
+        AssetClassification classification{
+                assets, {MakeClassificationLevel("sector", "Sector", assets, sectorMapping)}};
+        return GetExposures(positions, classification).front().net;
+    }
+
+    ClassificationLevel MakeClassificationLevel(std::string id, std::string name,
+                                                std::vector<std::string> const &assets,
+                                                SectorMapping const &mapping) {
+        ClassificationLevel level{std::move(id), std::move(name), {}, std::vector(assets.size(), kUnclassified)};
+
+        std::map<std::string, int32_t> labelCodes;
+        for (auto const &asset: assets) {
+            auto iter = mapping.find(asset);
+            if (iter != mapping.end()) {
+                labelCodes.emplace(iter->second, 0);
+            } else if (asset != "cash") {
+                SPDLOG_WARN("Warning: {} has no {} mapping. They will not be included in {} allocations",
+                            asset, level.id, level.id);
             }
         }
 
-        std::vector<std::string> columns;
-        std::vector<arrow::ChunkedArrayPtr> values;
-        for (auto const &[sector, arrayTable]: grouper) {
-            columns.emplace_back(sector);
-            values.emplace_back(make_dataframe(index, arrayTable.second, arrayTable.first).sum(
-                    epoch_frame::AxisType::Column).array());
+        // labels are sorted so codes, and therefore output columns, are stable
+        for (auto &[label, code]: labelCodes) {
+            code = static_cast<int32_t>(level.labels.size());
+            level.labels.emplace_back(label);
+        }
+
+        for (size_t i = 0; i < assets.size(); ++i) {
+            auto iter = mapping.find(assets[i]);
+            if (iter != mapping.end()) {
+                level.codes[i] = labelCodes.at(iter->second);
+            }
         }
+        return level;
+    }
 
-        return make_dataframe(index, values, columns);
+    LevelExposures GetExposures(const epoch_frame::DataFrame &positions,
+                                AssetClassification const &classification) {
+        const auto index = positions.index();
+        const auto columns = positions.column_names();
+        const auto nRows = static_cast<size_t>(positions.num_rows());
+        const auto nLevels = classification.levels.size();
+
+        std::unordered_map<std::string_view, size_t> assetLookup;
+        assetLookup.reserve(classification.assets.size());
+        for (size_t i = 0; i < classification.assets.size(); ++i) {
+            assetLookup.emplace(classification.assets[i], i);
+        }
+
+        // Resolve every position column to its bucket at each level once, the
+        // row loop below only does integer indexing.
+        std::vector<std::vector<double>> values;
+        std::vector<std::vector<int32_t>> columnCodes(nLevels);
+        values.reserve(columns.size());
+        for (auto const &column: columns) {
+            auto iter = assetLookup.find(column);
+            if (iter == assetLookup.end()) {
+                continue;
+            }
+            values.emplace_back(ToDoubleVector(positions[column]));
+            for (size_t l = 0; l < nLevels; ++l) {
+                auto const &level = classification.levels[l];
+                auto const &codes = level.codes;
+                const auto code = iter->second < codes.size() ? codes[iter->second] : kUnclassified;
+                if (code != kUnclassified && (code < 0 || static_cast<size_t>(code) >= level.labels.size())) {
+                    throw std::runtime_error(std::format("GetExposures: {} has code {} at level {}, which has {} labels",
+                                                         column, code, level.id, level.labels.size()));
+                }
+                columnCodes[l].push_back(code);
+            }
+        }
+
+        // [level][kind] -> code-major buffer so every output column is contiguous
+        enum Kind { Net = 0, Gross, Long, Short, KindCount };
+        std::vector<std::array<std::vector<double>, KindCount>> buffers(nLevels);
+        for (size_t l = 0; l < nLevels; ++l) {
+            for (auto &buffer: buffers[l]) {
+                buffer.assign(classification.levels[l].labels.size() * nRows, 0.0);
+            }
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, nRows), [&](tbb::blocked_range<size_t> const &r) {
+            for (size_t c = 0; c < values.size(); ++c) {
+                auto const &column = values[c];
+                for (size_t row = r.begin(); row != r.end(); ++row) {
+                    const double x = column[row];
+                    if (std::isnan(x)) {
+                        continue;
+                    }
+                    for (size_t l = 0; l < nLevels; ++l) {
+                        const auto code = columnCodes[l][c];
+                        if (code == kUnclassified) {
+                            continue;
+                        }
+                        const auto offset = static_cast<size_t>(code) * nRows + row;
+                        auto &levelBuffers = buffers[l];
+                        levelBuffers[Net][offset] += x;
+                        levelBuffers[Gross][offset] += std::abs(x);
+                        if (x > 0) {
+                            levelBuffers[Long][offset] += x;
+                        } else if (x < 0) {
+                            levelBuffers[Short][offset] += x;
+                        }
+                    }
+                }
+            }
+        });
+
+        LevelExposures result;
+        result.reserve(nLevels);
+        for (size_t l = 0; l < nLevels; ++l) {
+            auto const &level = classification.levels[l];
+
+            std::vector<bool> used(level.labels.size(), false);
+            for (auto code: columnCodes[l]) {
+                if (code != kUnclassified) {
+                    used[code] = true;
+                }
+            }
+
+            std::vector<std::string> labels;
+            std::array<std::vector<std::vector<double>>, KindCount> data;
+            for (size_t code = 0; code < level.labels.size(); ++code) {
+                if (!used[code]) {
+                    continue;
+                }
+                labels.emplace_back(level.labels[code]);
+                for (size_t k = 0; k < KindCount; ++k) {
+                    auto begin = buffers[l][k].begin() + code * nRows;
+                    data[k].emplace_back(begin, begin + nRows);
+                }
+            }
+
+            result.emplace_back(LevelExposure{
+                    .id = level.id,
+                    .name = level.name,
+                    .net = epoch_frame::make_dataframe(index, data[Net], labels),
+                    .gross = epoch_frame::make_dataframe(index, data[Gross], labels),
+                    .longs = epoch_frame::make_dataframe(index, data[Long], labels),
+                    .shorts = epoch_frame::make_dataframe(index, data[Short], labels)});
+        }
+        return result;
     }
 }
@@ -5,6 +5,7 @@
 #pragma once
 #include <epoch_frame/series.h>
 #include <epoch_frame/dataframe.h>
+#include "model.h"
 
 namespace epoch_folio {
     inline epoch_frame::DataFrame GetPercentAlloc(const epoch_frame::DataFrame &values) {
@@ -18,4 +19,18 @@ namespace epoch_folio {
 
     epoch_frame::DataFrame GetSectorExposure(const epoch_frame::DataFrame &positions,
                                      const std::unordered_map<std::string, std::string> &sectorMapping);
+
+    ClassificationLevel MakeClassificationLevel(std::string id, std::string name,
+                                                std::vector<std::string> const &assets,
+                                                SectorMapping const &mapping);
+
+    /*
+    Net, gross, long and short exposure of every classification level in a
+    single pass over the positions. Columns of each frame are the level labels
+    that hold at least one position column; unclassified columns and "cash"
+    are ignored. Throws when a code is neither kUnclassified nor an index into
+    its level's labels.
+    */
+    LevelExposures GetExposures(const epoch_frame::DataFrame &positions,
+                                AssetClassification const &classification);
 }
\ No newline at end of file
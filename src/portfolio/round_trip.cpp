@@ -10,337 +10,603 @@
 #include <epoch_frame/factory/series_factory.h>
 #include <epoch_frame/factory/table_factory.h>
 #include <oneapi/tbb/parallel_for.h>
+#include "common/memory_tracker.h"
+#include "common/series_helper.h"
+#include "common/trace.h"
 #include "epoch_dashboard/tearsheet/table_builder.h"
 #include "epoch_folio/tearsheet.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <format>
+#include <memory_resource>
+#include <numeric>
+#include <span>
 
 using namespace epoch_frame;
 
 
 namespace epoch_folio {
-using AggList = std::vector<
-    std::pair<std::string, std::variant<std::function<Scalar(Series const &)>,
-                                        std::string>>>;
-
-template <bool is_duration = false>
-arrow::TablePtr AggAllLongShort(epoch_frame::DataFrame const &round_trip,
-                                std::string const &col,
-                                AggList const &stats_dict,
-                                bool is_percentage = false) {
-  std::vector<Scalar> index(stats_dict.size());
-  std::vector<Scalar> all_trades(stats_dict.size());
-  std::vector<Scalar> long_trades(stats_dict.size());
-  std::vector<Scalar> short_trades(stats_dict.size());
-
-  auto multiplier = is_percentage ? 100.0_scalar : 1.0_scalar;
-  tbb::parallel_for(tbb::blocked_range<size_t>(0, stats_dict.size()),
-                    [&](tbb::blocked_range<size_t> const &r) {
-                      for (size_t i = r.begin(); i != r.end(); ++i) {
-                        auto [key, fn] = stats_dict[i];
-                        index[i] = Scalar{key};
-
-                        auto all = round_trip[col];
-                        auto _long = all.loc(round_trip["long"]);
-                        auto _short = all.loc(!round_trip["long"]);
-
-                        std::visit(
-                            [&]<typename T>(T const &fn) {
-                              if constexpr (std::is_same_v<T, std::string>) {
-                                auto all_agg = all.agg(AxisType::Row, fn);
-                                auto long_agg = _long.agg(AxisType::Row, fn);
-                                auto short_agg = _short.agg(AxisType::Row, fn);
-
-                                if constexpr (is_duration) {
-                                  all_trades[i] = all_agg.cast_int64();
-                                  long_trades[i] = long_agg.cast_int64();
-                                  short_trades[i] = short_agg.cast_int64();
-                                } else {
-                                  all_trades[i] = all_agg * multiplier;
-                                  long_trades[i] = long_agg * multiplier;
-                                  short_trades[i] = short_agg * multiplier;
-                                }
-                              } else {
-                                all_trades[i] = fn(all) * multiplier;
-                                long_trades[i] = fn(_long) * multiplier;
-                                short_trades[i] = fn(_short) * multiplier;
-                              }
-                            },
-                            fn);
-                      }
-                    });
+namespace {
+constexpr int32_t kNullSymbol = -1;
+
+// Rows grouped by symbol: rows[offsets[code], offsets[code + 1]) belong to
+// symbols[code] and keep their original order. The symbol views point into
+// `storage`.
+struct SymbolSegments {
+  arrow::ChunkedArrayPtr storage;
+  std::vector<std::string_view> symbols;
+  std::vector<int64_t> offsets;
+  std::vector<int64_t> rows;
+
+  size_t size() const { return symbols.size(); }
+
+  std::span<int64_t> operator[](size_t code) {
+    return {rows.data() + offsets[code], rows.data() + offsets[code + 1]};
+  }
+};
+
+// dictionary encodes the symbols and counting sorts the rows, null symbols are
+// dropped
+SymbolSegments SegmentBySymbol(arrow::ChunkedArrayPtr symbolArray) {
+  if (symbolArray->type()->id() != arrow::Type::STRING) {
+    symbolArray = AssertResultIsOk(
+                      arrow::compute::Cast(symbolArray, arrow::utf8()))
+                      .chunked_array();
+  }
+
+  SymbolSegments out{symbolArray, {}, {}, {}};
+  std::unordered_map<std::string_view, int32_t> symbolCodes;
+  std::vector<int32_t> codes;
+  codes.reserve(symbolArray->length());
+  for (auto const &chunk : symbolArray->chunks()) {
+    auto const &strings = static_cast<arrow::StringArray const &>(*chunk);
+    for (int64_t i = 0; i < strings.length(); ++i) {
+      if (strings.IsNull(i)) {
+        codes.push_back(kNullSymbol);
+        continue;
+      }
+      auto [iter, inserted] = symbolCodes.try_emplace(
+          strings.GetView(i), static_cast<int32_t>(out.symbols.size()));
+      if (inserted) {
+        out.symbols.push_back(iter->first);
+      }
+      codes.push_back(iter->second);
+    }
+  }
+
+  out.offsets.assign(out.symbols.size() + 1, 0);
+  for (auto code : codes) {
+    if (code != kNullSymbol) {
+      ++out.offsets[code + 1];
+    }
+  }
+  std::partial_sum(out.offsets.begin(), out.offsets.end(),
+                   out.offsets.begin());
+
+  out.rows.resize(out.offsets.back());
+  auto cursor = out.offsets;
+  for (int64_t row = 0; row < static_cast<int64_t>(codes.size()); ++row) {
+    if (codes[row] != kNullSymbol) {
+      out.rows[cursor[codes[row]]++] = row;
+    }
+  }
+  return out;
+}
+} // namespace
 
-  arrow::FieldVector fields{string_field("key")};
-  fields.reserve(4);
-  for (auto const &field : {"all_trades", "long_trades", "short_trades"}) {
-    if constexpr (is_duration) {
-      fields.emplace_back(int64_field(field));
+namespace {
+double ExactMedian(std::vector<double> &values) {
+  if (values.empty()) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  auto mid = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+  std::nth_element(values.begin(), mid, values.end());
+  if (values.size() % 2 == 1) {
+    return *mid;
+  }
+  return (*std::max_element(values.begin(), mid) + *mid) / 2.0;
+}
+
+class SignedAccumulator {
+public:
+  explicit SignedAccumulator(bool withMedian) : m_withMedian(withMedian) {}
+
+  void Add(double value) {
+    ++m_summary.rows;
+    if (std::isnan(value)) {
+      return;
+    }
+    Push(m_summary.all, m_all, value);
+    if (value > 0) {
+      Push(m_summary.winning, m_winning, value);
+    } else if (value < 0) {
+      Push(m_summary.losing, m_losing, value);
     } else {
-      fields.emplace_back(float64_field(field));
+      ++m_summary.even;
+    }
+  }
+
+  SignedSummary Finish() {
+    if (m_withMedian) {
+      m_summary.all.median = ExactMedian(m_all);
+      m_summary.winning.median = ExactMedian(m_winning);
+      m_summary.losing.median = ExactMedian(m_losing);
     }
+    return m_summary;
   }
-  return factory::table::make_table(
-      std::vector{index, all_trades, long_trades, short_trades}, fields);
+
+private:
+  bool m_withMedian;
+  SignedSummary m_summary;
+  std::vector<double> m_all, m_winning, m_losing;
+
+  void Push(ValueSummary &summary, std::vector<double> &values,
+            double value) const {
+    ++summary.count;
+    summary.sum += value;
+    summary.min = std::min(summary.min, value);
+    summary.max = std::max(summary.max, value);
+    if (m_withMedian) {
+      values.push_back(value);
+    }
+  }
+};
+
+struct SideAccumulator {
+  SignedAccumulator pnl{false};
+  SignedAccumulator returns{true};
+  SignedAccumulator duration{true};
+
+  void Add(double pnl_, double returns_, double duration_) {
+    pnl.Add(pnl_);
+    returns.Add(returns_);
+    duration.Add(duration_);
+  }
+
+  RoundTripSideSummary Finish() {
+    return {pnl.Finish(), returns.Finish(), duration.Finish()};
+  }
+};
+
+// 1 = long, 0 = short, -1 = null (counted under all trades only, like the
+// boolean mask filters it replaces)
+std::vector<int8_t> ToSideVector(arrow::ChunkedArrayPtr const &chunked) {
+  std::vector<int8_t> out;
+  out.reserve(chunked->length());
+  for (auto const &chunk : chunked->chunks()) {
+    auto const &array = static_cast<arrow::BooleanArray const &>(*chunk);
+    for (int64_t i = 0; i < array.length(); ++i) {
+      out.push_back(array.IsNull(i) ? int8_t{-1}
+                                    : static_cast<int8_t>(array.Value(i)));
+    }
+  }
+  return out;
 }
 
-epoch_proto::Table GetSymbolsTable(epoch_frame::DataFrame const &round_trip,
-                                   AggList const &stats_dict) {
-  auto apply_symbol = [&](std::string const &symbol,
-                          epoch_frame::Series const &returns) {
-    std::vector<std::string> index(stats_dict.size());
-    std::vector<Scalar> all_trades(stats_dict.size());
-
-    std::transform(stats_dict.begin(), stats_dict.end(), index.begin(),
-                   all_trades.begin(), [&](auto const &stat, std::string &row) {
-                     row = stat.first;
-                     return std::visit(
-                         [&]<typename T>(T const &fn) {
-                           if constexpr (std::is_same_v<T, std::string>) {
-                             return returns.agg(AxisType::Row, fn) * 100_scalar;
-                           } else {
-                             return fn(returns) * 100_scalar;
-                           }
-                         },
-                         stat.second);
-                   });
+using StatRow =
+    std::pair<std::string, std::array<std::optional<double>, 3>>;
+
+using ReturnStat =
+    std::pair<std::string_view, std::optional<double> (*)(SignedSummary const &)>;
+
+const std::array<ReturnStat, 8> kReturnStats{{
+    {"Avg returns all round_trips",
+     [](SignedSummary const &s) { return s.all.Mean(); }},
+    {"Avg returns winning",
+     [](SignedSummary const &s) { return s.winning.Mean(); }},
+    {"Avg returns losing",
+     [](SignedSummary const &s) { return s.losing.Mean(); }},
+    {"Median returns all round_trips",
+     [](SignedSummary const &s) { return s.all.Median(); }},
+    {"Median returns winning",
+     [](SignedSummary const &s) { return s.winning.Median(); }},
+    {"Median returns losing",
+     [](SignedSummary const &s) { return s.losing.Median(); }},
+    {"Largest winning trade",
+     [](SignedSummary const &s) { return s.all.Max(); }},
+    {"Largest losing trade",
+     [](SignedSummary const &s) { return s.all.Min(); }},
+}};
+
+std::optional<double> Ratio(std::optional<double> num,
+                            std::optional<double> den) {
+  if (!num || !den || *den == 0.0) {
+    return std::nullopt;
+  }
+  return *num / std::abs(*den);
+}
 
-    return make_dataframe(factory::index::make_object_index(index),
-                          {all_trades},
-                          {arrow::field(symbol, arrow::float64())});
-  };
+std::optional<double> Scaled(std::optional<double> value, double factor) {
+  return value.transform([factor](double v) { return v * factor; });
+}
+
+epoch_proto::Table MakeAllLongShortTable(std::string const &title,
+                                         epoch_proto::EpochFolioType type,
+                                         std::vector<StatRow> const &rows) {
+  epoch_tearsheet::TableBuilder builder;
+  builder.setType(epoch_proto::WidgetDataTable)
+      .setCategory(categories::RoundTripPerformance)
+      .setTitle(title);
 
-  auto groups = round_trip[std::vector<std::string>{"returns", "symbol"}]
-                    .group_by_apply("symbol")
-                    .groups();
+  builder.addColumn("key", "key", epoch_proto::TypeString);
+  for (auto const &col : {"all_trades", "long_trades", "short_trades"}) {
+    builder.addColumn(col, col, type);
+  }
+
+  for (auto const &[key, values] : rows) {
+    epoch_proto::TableRow row;
+    *row.add_values() = epoch_tearsheet::ScalarFactory::create(Scalar{key});
+    for (auto const &value : values) {
+      if (!value || std::isnan(*value)) {
+        *row.add_values() = epoch_tearsheet::ScalarFactory::create(Scalar{});
+        continue;
+      }
+      switch (type) {
+      case epoch_proto::TypePercent:
+        *row.add_values() =
+            epoch_tearsheet::ScalarFactory::fromPercentValue(*value);
+        break;
+      case epoch_proto::TypeDuration:
+        // nanoseconds to milliseconds
+        *row.add_values() = epoch_tearsheet::ScalarFactory::fromDurationMs(
+            static_cast<int64_t>(*value / 1000000.0));
+        break;
+      case epoch_proto::TypeDecimal:
+      default:
+        *row.add_values() = epoch_tearsheet::ScalarFactory::fromDecimal(*value);
+        break;
+      }
+    }
+    builder.addRow(std::move(row));
+  }
+  return builder.build();
+}
+} // namespace
+
+epoch_proto::Table GetSymbolsTable(epoch_frame::DataFrame const &round_trip,
+                                   size_t topKSymbols) {
+  trace::Span span{"GetSymbolsTable"};
+  span.SetRows(round_trip.num_rows());
+  const auto returns = ToDoubleVector(round_trip["returns"]);
+  auto segments = SegmentBySymbol(round_trip["symbol"].array());
+
+  std::vector<SignedSummary> summaries(segments.size());
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, segments.size()),
+                    [&](tbb::blocked_range<size_t> const &r) {
+                      for (size_t code = r.begin(); code != r.end(); ++code) {
+                        SignedAccumulator accumulator{true};
+                        for (auto row : segments[code]) {
+                          accumulator.Add(returns[row]);
+                        }
+                        summaries[code] = accumulator.Finish();
+                      }
+                    });
+
+  std::vector<size_t> columns(segments.size());
+  std::iota(columns.begin(), columns.end(), 0);
+  const bool truncate =
+      topKSymbols > 0 && columns.size() > 2 * topKSymbols;
+  if (truncate) {
+    // best topKSymbols then worst topKSymbols by mean return. Symbols without
+    // a valid return are neither, so they are left out
+    auto meanOf = [&](size_t code) { return *summaries[code].all.Mean(); };
+    std::erase_if(columns, [&](size_t code) {
+      return !summaries[code].all.Mean().has_value();
+    });
+    std::stable_sort(columns.begin(), columns.end(),
+                     [&](size_t lhs, size_t rhs) {
+                       return meanOf(lhs) > meanOf(rhs);
+                     });
+    if (columns.size() > 2 * topKSymbols) {
+      columns.erase(
+          columns.begin() + static_cast<std::ptrdiff_t>(topKSymbols),
+          columns.end() - static_cast<std::ptrdiff_t>(topKSymbols));
+    }
+  } else {
+    std::ranges::sort(columns, [&](size_t lhs, size_t rhs) {
+      return segments.symbols[lhs] < segments.symbols[rhs];
+    });
+  }
 
   epoch_tearsheet::TableBuilder builder;
   builder.setType(epoch_proto::WidgetDataTable)
       .setCategory(categories::RoundTripPerformance)
-      .setTitle("Returns by Symbol");
+      .setTitle(truncate ? std::format("Returns by Symbol (top and bottom {} of {})",
+                                       topKSymbols, segments.size())
+                         : std::string{"Returns by Symbol"});
 
-  // Add key column
   builder.addColumn("key", "Stats", epoch_proto::TypeString);
+  for (auto code : columns) {
+    std::string symbol{segments.symbols[code]};
+    builder.addColumn(symbol, symbol, epoch_proto::TypePercent);
+  }
+
+  for (auto const &[key, stat] : kReturnStats) {
+    epoch_proto::TableRow row;
+    *row.add_values() =
+        epoch_tearsheet::ScalarFactory::create(Scalar{std::string{key}});
+    for (auto code : columns) {
+      auto value = Scaled(stat(summaries[code]), 100.0);
+      *row.add_values() =
+          value && !std::isnan(*value)
+              ? epoch_tearsheet::ScalarFactory::fromPercentValue(*value)
+              : epoch_tearsheet::ScalarFactory::create(Scalar{});
+    }
+    builder.addRow(std::move(row));
+  }
+  return builder.build();
+}
+
+RoundTripAggregates
+AggregateRoundTrips(epoch_frame::DataFrame const &round_trip) {
+  trace::Span span{"AggregateRoundTrips"};
+  span.SetRows(round_trip.num_rows());
+  const auto pnl = ToDoubleVector(round_trip["pnl"]);
+  const auto returns = ToDoubleVector(round_trip["returns"]);
+  const auto duration = ToDoubleVector(round_trip["duration"]);
+  const auto side = ToSideVector(round_trip["long"].array());
+
+  SideAccumulator all, longs, shorts;
+  for (size_t i = 0; i < pnl.size(); ++i) {
+    all.Add(pnl[i], returns[i], duration[i]);
+    if (side[i] == 1) {
+      longs.Add(pnl[i], returns[i], duration[i]);
+    } else if (side[i] == 0) {
+      shorts.Add(pnl[i], returns[i], duration[i]);
+    }
+  }
+  return {all.Finish(), longs.Finish(), shorts.Finish()};
+}
+
+std::vector<epoch_proto::Table>
+GetRoundTripStats(epoch_frame::DataFrame const &round_trip,
+                  size_t topKSymbols) {
+  const auto aggregates = AggregateRoundTrips(round_trip);
+  auto row = [&](std::string key, auto &&fn) {
+    return StatRow{std::move(key),
+                   {fn(aggregates.all), fn(aggregates.longs),
+                    fn(aggregates.shorts)}};
+  };
+  auto count = [](size_t n) { return std::optional{static_cast<double>(n)}; };
 
-  std::vector<FrameOrSeries> frames;
-  frames.reserve(groups.size());
+  std::vector<epoch_proto::Table> out;
+  out.reserve(5);
 
-  auto returns = round_trip["returns"];
-  for (auto const &[symbol, indexes] : groups) {
-    auto symbol_name = symbol.repr();
-    frames.emplace_back(
-        apply_symbol(symbol_name, returns.iloc(Array{indexes})));
-    builder.addColumn(symbol_name, symbol_name, epoch_proto::TypePercent);
+  out.emplace_back(MakeAllLongShortTable(
+      "PnL Statistics", epoch_proto::TypeDecimal,
+      {row("Total profit", [](auto const &s) { return s.pnl.all.Sum(); }),
+       row("Gross profit", [](auto const &s) { return s.pnl.winning.Sum(); }),
+       row("Gross loss", [](auto const &s) { return s.pnl.losing.Sum(); }),
+       row("Profit factor",
+           [](auto const &s) {
+             return Ratio(s.pnl.winning.Sum(), s.pnl.losing.Sum());
+           }),
+       row("Avg. trade net profit",
+           [](auto const &s) { return s.pnl.all.Mean(); }),
+       row("Avg. winning trade",
+           [](auto const &s) { return s.pnl.winning.Mean(); }),
+       row("Avg. losing trade",
+           [](auto const &s) { return s.pnl.losing.Mean(); }),
+       row("Ratio Avg. Win:Avg. Loss",
+           [](auto const &s) {
+             return Ratio(s.pnl.winning.Mean(), s.pnl.losing.Mean());
+           }),
+       row("Largest winning trade",
+           [](auto const &s) { return s.pnl.all.Max(); }),
+       row("Largest losing trade",
+           [](auto const &s) { return s.pnl.all.Min(); })}));
+
+  out.emplace_back(MakeAllLongShortTable(
+      "Trade Summary", epoch_proto::TypeDecimal,
+      {row("Total number of round_trips",
+           [&](auto const &s) { return count(s.pnl.all.count); }),
+       row("Percent profitable",
+           [](auto const &s) {
+             return s.pnl.rows ? std::optional{static_cast<double>(
+                                                   s.pnl.winning.count) /
+                                               static_cast<double>(s.pnl.rows)}
+                               : std::nullopt;
+           }),
+       row("Winning round_trips",
+           [&](auto const &s) { return count(s.pnl.winning.count); }),
+       row("Losing round_trips",
+           [&](auto const &s) { return count(s.pnl.losing.count); }),
+       row("Even round_trips",
+           [&](auto const &s) { return count(s.pnl.even); })}));
+
+  out.emplace_back(MakeAllLongShortTable(
+      "Duration Analysis", epoch_proto::TypeDuration,
+      {row("Avg duration", [](auto const &s) { return s.duration.all.Mean(); }),
+       row("Median duration",
+           [](auto const &s) { return s.duration.all.Median(); }),
+       row("Longest duration",
+           [](auto const &s) { return s.duration.all.Max(); }),
+       row("Shortest duration",
+           [](auto const &s) { return s.duration.all.Min(); })}));
+
+  std::vector<StatRow> returnRows;
+  returnRows.reserve(kReturnStats.size());
+  for (auto const &[key, stat] : kReturnStats) {
+    returnRows.emplace_back(row(std::string{key}, [stat](auto const &s) {
+      return Scaled(stat(s.returns), 100.0);
+    }));
   }
+  out.emplace_back(MakeAllLongShortTable(
+      "Return Analysis", epoch_proto::TypePercent, returnRows));
 
-  if (!frames.empty()) {
-    auto table = concat({.frames = frames, .axis = AxisType::Column})
-                     .reset_index("key");
+  out.emplace_back(GetSymbolsTable(round_trip, topKSymbols));
+  return out;
+}
 
-    // Build data incrementally using addRow
-    // Process columns in the same order they were added to the builder
-    std::vector<std::string> ordered_columns;
-    ordered_columns.reserve(table.column_names().size());
-    ordered_columns.push_back("key"); // First column added
+namespace {
+constexpr double kAmountEpsilon = 1e-9;
+
+struct Lot {
+  int64_t openTime;
+  double amount; // signed, positive for long lots
+  double price;
+};
+
+struct MatchedRoundTrip {
+  int64_t openTime;
+  int64_t closeTime;
+  bool isLong;
+  int32_t symbol;
+  double pnl;
+};
+
+void MatchSymbol(int32_t symbol, std::span<const int64_t> rows,
+                 std::vector<int64_t> const &timestamps,
+                 std::vector<double> const &amounts,
+                 std::vector<double> const &prices,
+                 epoch_core::RoundTripMatching matching,
+                 std::vector<MatchedRoundTrip> &out) {
+  // lots churn constantly on busy symbols, the pool recycles their blocks
+  std::pmr::unsynchronized_pool_resource pool;
+  std::pmr::deque<Lot> lots{&pool};
+
+  for (auto row : rows) {
+    const auto time = timestamps[row];
+    const auto price = prices[row];
+    const auto amount = amounts[row];
+    if (std::isnan(amount) || std::isnan(price) ||
+        std::abs(amount) < kAmountEpsilon) {
+      continue;
+    }
 
-    // Add symbol columns in the same order they were added to the builder
-    for (auto const &[symbol, indexes] : groups) {
-      ordered_columns.push_back(symbol.repr());
+    const bool opening = lots.empty() || ((lots.front().amount > 0) == (amount > 0));
+    if (opening) {
+      if (matching == epoch_core::RoundTripMatching::AverageCost &&
+          !lots.empty()) {
+        auto &lot = lots.front();
+        const auto total = lot.amount + amount;
+        lot.price = (lot.amount * lot.price + amount * price) / total;
+        lot.amount = total;
+      } else {
+        lots.push_back(Lot{time, amount, price});
+      }
+      continue;
     }
 
-    for (int64_t i = 0; i < static_cast<int64_t>(table.num_rows()); ++i) {
-      epoch_proto::TableRow row;
-      for (const auto& col_name : ordered_columns) {
-        auto scalar = table[col_name].iloc(i);
-        if (col_name == "key") {
-          *row.add_values() = epoch_tearsheet::ScalarFactory::create(scalar);
+    const bool isLong = lots.front().amount > 0;
+    const double direction = isLong ? 1.0 : -1.0;
+    auto remaining = std::abs(amount);
+    MatchedRoundTrip trip{time, time, isLong, symbol, 0.0};
+
+    while (remaining > kAmountEpsilon && !lots.empty()) {
+      auto &lot = matching == epoch_core::RoundTripMatching::LIFO ? lots.back()
+                                                                  : lots.front();
+      const auto matched = std::min(remaining, std::abs(lot.amount));
+      trip.pnl += matched * (price - lot.price) * direction;
+      trip.openTime = std::min(trip.openTime, lot.openTime);
+
+      lot.amount -= matched * direction;
+      remaining -= matched;
+      if (std::abs(lot.amount) < kAmountEpsilon) {
+        if (matching == epoch_core::RoundTripMatching::LIFO) {
+          lots.pop_back();
         } else {
-          // Percentage columns are already scaled by apply_symbol (lines 97,99 multiply by 100_scalar)
-          *row.add_values() = epoch_tearsheet::ScalarFactory::fromPercentValue(scalar.cast_double().as_double());
+          lots.pop_front();
         }
       }
-      builder.addRow(row);
     }
-  }
+    out.push_back(trip);
 
-  return builder.build();
+    // position flip: whatever was not matched opens on the other side
+    if (remaining > kAmountEpsilon) {
+      lots.push_back(Lot{time, amount > 0 ? remaining : -remaining, price});
+    }
+  }
 }
-
-std::vector<epoch_proto::Table>
-GetRoundTripStats(epoch_frame::DataFrame const &round_trip) {
-  using epoch_frame::Series;
-  static const Scalar ZERO{0.0};
-
-  const AggList PNL_STATS{
-      {"Total profit", std::string{"sum"}},
-      {"Gross profit",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return x.loc(x > ZERO).sum(); })},
-      {"Gross loss", std::function<Scalar(Series const &)>([](Series const &x) {
-         return x.loc(x < ZERO).sum();
-       })},
-      {"Profit factor",
-       std::function<Scalar(Series const &)>([](Series const &x) {
-         auto neg_sum = x.loc(x < ZERO).abs().sum();
-         if (neg_sum != ZERO)
-           return x.loc(x > ZERO).sum() / neg_sum;
-         return Scalar();
-       })},
-      {"Avg. trade net profit", std::string{"mean"}},
-      {"Avg. winning trade",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return x.loc(x > ZERO).mean(); })},
-      {"Avg. losing trade",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return x.loc(x < ZERO).mean(); })},
-      {"Ratio Avg. Win:Avg. Loss",
-       std::function<Scalar(Series const &)>([](Series const &x) {
-         auto neg_mean = x.loc(x < ZERO).abs().mean();
-         if (neg_mean != ZERO)
-           return x.loc(x > ZERO).mean() / neg_mean;
-         return Scalar();
-       })},
-      {"Largest winning trade", std::string{"max"}},
-      {"Largest losing trade", std::string{"min"}}};
-
-  const AggList SUMMARY_STATS{
-      {"Total number of round_trips",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return x.count_valid(); })},
-      {"Percent profitable",
-       std::function<Scalar(Series const &)>([](Series const &x) {
-         return Scalar{static_cast<double>(x.loc(x > ZERO).size()) /
-                       static_cast<double>(x.size())};
-       })},
-      {"Winning round_trips",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return Scalar{x.loc(x > ZERO).size()}; })},
-      {"Losing round_trips",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return Scalar{x.loc(x < ZERO).size()}; })},
-      {"Even round_trips",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return Scalar{x.loc(x == ZERO).size()}; })}};
-
-  const AggList RETURNS_STATS{
-      {"Avg returns all round_trips", std::string{"mean"}},
-      {"Avg returns winning",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return x.loc(x > ZERO).mean(); })},
-      {"Avg returns losing",
-       std::function<Scalar(Series const &)>(
-           [](Series const &x) { return x.loc(x < ZERO).mean(); })},
-      {"Median returns all round_trips",
-       std::function<Scalar(Series const &)>([](Series const &x) {
-         return x.quantile(arrow::compute::QuantileOptions{
-             0.5, arrow::compute::QuantileOptions::Interpolation::LINEAR});
-       })},
-      {"Median returns winning",
-       std::function<Scalar(Series const &)>([](Series const &x) {
-         return x.loc(x > ZERO).quantile(arrow::compute::QuantileOptions{
-             0.5, arrow::compute::QuantileOptions::Interpolation::LINEAR});
-       })},
-      {"Median returns losing",
-       std::function<Scalar(Series const &)>([](Series const &x) {
-         return x.loc(x < ZERO).quantile(arrow::compute::QuantileOptions{
-             0.5, arrow::compute::QuantileOptions::Interpolation::LINEAR});
-       })},
-      {"Largest winning trade", std::string{"max"}},
-      {"Largest losing trade", std::string{"min"}}};
-
-  const AggList DURATION_STATS{
-      {"Avg duration", std::string{"mean"}},
-      {"Median duration", std::string{"approximate_median"}},
-      {"Longest duration", std::string{"max"}},
-      {"Shortest duration", std::string{"min"}}};
-
-  auto pnl = AggAllLongShort(round_trip, "pnl", PNL_STATS);
-  auto summary = AggAllLongShort(round_trip, "pnl", SUMMARY_STATS);
-  auto duration = AggAllLongShort<true>(round_trip, "duration", DURATION_STATS);
-  auto returns = AggAllLongShort(round_trip, "returns", RETURNS_STATS, true);
-
-  auto make_table =
-      [&](const std::string &title,
-          const std::vector<std::pair<std::string, epoch_proto::EpochFolioType>>
-              &cols,
-          const std::shared_ptr<arrow::Table> &data) {
-        epoch_tearsheet::TableBuilder builder;
-        builder.setType(epoch_proto::WidgetDataTable)
-            .setCategory(categories::RoundTripPerformance)
-            .setTitle(title);
-
-        for (auto const &c : cols) {
-          builder.addColumn(c.first, c.first, c.second);
-        }
-
-        if (data) {
-          auto df = make_dataframe(data);
-
-          // Build data incrementally using addRow
-          for (int64_t i = 0; i < static_cast<int64_t>(df.num_rows()); ++i) {
-            epoch_proto::TableRow row;
-            for (size_t j = 0; j < cols.size(); ++j) {
-              auto scalar = df[cols[j].first].iloc(i);
-
-              switch (cols[j].second) {
-                case epoch_proto::TypeString:
-                  *row.add_values() = epoch_tearsheet::ScalarFactory::create(scalar);
-                  break;
-                case epoch_proto::TypePercent:
-                  // Check if data is already scaled by looking at the calling context
-                  *row.add_values() = epoch_tearsheet::ScalarFactory::fromPercentValue(scalar.cast_double().as_double());
-                  break;
-                case epoch_proto::TypeDuration:
-                  // Convert from nanoseconds to milliseconds
-                  *row.add_values() = epoch_tearsheet::ScalarFactory::fromDurationMs(static_cast<int64_t>(scalar.cast_double().as_double() / 1000000.0));
-                  break;
-                case epoch_proto::TypeDecimal:
-                default:
-                  *row.add_values() = epoch_tearsheet::ScalarFactory::fromDecimal(scalar.cast_double().as_double());
-                  break;
-              }
-            }
-            builder.addRow(row);
+} // namespace
+
+DataFrame
+ExtractRoundTripsFromTransactions(epoch_frame::DataFrame const &transactions,
+                                  epoch_core::RoundTripMatching matching) {
+  trace::Span span{"ExtractRoundTripsFromTransactions"};
+  span.SetRows(transactions.num_rows());
+  const auto timestamps = ToTimestampVector(transactions.index());
+  const auto amounts = ToDoubleVector(transactions["amount"]);
+  const auto prices = ToDoubleVector(transactions["price"]);
+
+  auto segments = SegmentBySymbol(transactions["symbol"].array());
+  auto const &symbols = segments.symbols;
+
+  std::vector<std::vector<MatchedRoundTrip>> matched(symbols.size());
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, symbols.size()),
+      [&](tbb::blocked_range<size_t> const &r) {
+        for (size_t code = r.begin(); code != r.end(); ++code) {
+          auto segment = segments[code];
+          auto byTime = [&](int64_t lhs, int64_t rhs) {
+            return timestamps[lhs] < timestamps[rhs];
+          };
+          if (!std::is_sorted(segment.begin(), segment.end(), byTime)) {
+            std::stable_sort(segment.begin(), segment.end(), byTime);
           }
+          MatchSymbol(static_cast<int32_t>(code), segment, timestamps, amounts,
+                      prices, matching, matched[code]);
         }
+      });
 
-        return builder.build();
-      };
+  std::vector<MatchedRoundTrip> trips;
+  size_t total = 0;
+  for (auto const &symbolTrips : matched) {
+    total += symbolTrips.size();
+  }
+  trips.reserve(total);
+  for (auto &symbolTrips : matched) {
+    trips.insert(trips.end(), symbolTrips.begin(), symbolTrips.end());
+  }
+  std::stable_sort(trips.begin(), trips.end(),
+                   [](auto const &lhs, auto const &rhs) {
+                     return lhs.closeTime < rhs.closeTime;
+                   });
 
-  std::vector<epoch_proto::Table> out;
-  out.reserve(5);
+  const auto timestampType = transactions.index()->dtype();
+  auto *pool = CurrentMemoryPool();
+  arrow::TimestampBuilder openBuilder(timestampType, pool);
+  arrow::TimestampBuilder closeBuilder(timestampType, pool);
+  arrow::StringBuilder sideBuilder(pool);
+  arrow::StringBuilder assetBuilder(pool);
+  arrow::DoubleBuilder pnlBuilder(pool);
+
+  for (auto *builder :
+       std::initializer_list<arrow::ArrayBuilder *>{&openBuilder, &closeBuilder,
+                                                    &sideBuilder, &assetBuilder,
+                                                    &pnlBuilder}) {
+    ThrowIfNotOk(builder->Reserve(static_cast<int64_t>(trips.size())));
+  }
 
-  out.emplace_back(make_table("PnL Statistics",
-                              {{"key", epoch_proto::TypeString},
-                               {"all_trades", epoch_proto::TypeDecimal},
-                               {"long_trades", epoch_proto::TypeDecimal},
-                               {"short_trades", epoch_proto::TypeDecimal}},
-                              pnl));
-
-  out.emplace_back(make_table("Trade Summary",
-                              {{"key", epoch_proto::TypeString},
-                               {"all_trades", epoch_proto::TypeDecimal},
-                               {"long_trades", epoch_proto::TypeDecimal},
-                               {"short_trades", epoch_proto::TypeDecimal}},
-                              summary));
-
-  out.emplace_back(make_table("Duration Analysis",
-                              {{"key", epoch_proto::TypeString},
-                               {"all_trades", epoch_proto::TypeDuration},
-                               {"long_trades", epoch_proto::TypeDuration},
-                               {"short_trades", epoch_proto::TypeDuration}},
-                              duration));
-
-  out.emplace_back(make_table("Return Analysis",
-                              {{"key", epoch_proto::TypeString},
-                               {"all_trades", epoch_proto::TypePercent},
-                               {"long_trades", epoch_proto::TypePercent},
-                               {"short_trades", epoch_proto::TypePercent}},
-                              returns));
-
-  out.emplace_back(GetSymbolsTable(round_trip, RETURNS_STATS));
-  return out;
+  for (auto const &trip : trips) {
+    openBuilder.UnsafeAppend(trip.openTime);
+    closeBuilder.UnsafeAppend(trip.closeTime);
+    ThrowIfNotOk(sideBuilder.Append(trip.isLong ? "Long" : "Short"));
+    ThrowIfNotOk(assetBuilder.Append(symbols[trip.symbol]));
+    pnlBuilder.UnsafeAppend(trip.pnl);
+  }
+
+  auto finish = [](arrow::ArrayBuilder &builder) {
+    return builder.Finish().ValueOrDie();
+  };
+
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("open_datetime", timestampType),
+                     arrow::field("close_datetime", timestampType),
+                     string_field("side"), string_field("asset"),
+                     float64_field("net_return")}),
+      std::vector{finish(openBuilder), finish(closeBuilder),
+                  finish(sideBuilder), finish(assetBuilder),
+                  finish(pnlBuilder)});
+  return make_dataframe(table);
 }
 
 DataFrame GetProfitAttribution(epoch_frame::DataFrame const &round_trip,
                                std::string const &col) {
+  trace::Span span{"GetProfitAttribution"};
+  span.SetRows(round_trip.num_rows());
   const auto total_pnl = round_trip["pnl"].sum();
   return (
       round_trip[std::vector<std::string>{"pnl", col}].group_by_agg(col).sum() /
@@ -4,10 +4,91 @@
 
 #pragma once
 #include "model.h"
+#include <limits>
 
 namespace epoch_folio {
+// count/sum/min/max (and the median when requested) of one slice of a round
+// trip column. Empty slices report std::nullopt, matching arrow's null
+// aggregates.
+struct ValueSummary {
+  size_t count{0};
+  double sum{0.0};
+  double min{std::numeric_limits<double>::infinity()};
+  double max{-std::numeric_limits<double>::infinity()};
+  double median{std::numeric_limits<double>::quiet_NaN()};
+
+  std::optional<double> Sum() const {
+    return count ? std::optional{sum} : std::nullopt;
+  }
+  std::optional<double> Mean() const {
+    return count ? std::optional{sum / static_cast<double>(count)}
+                 : std::nullopt;
+  }
+  std::optional<double> Min() const {
+    return count ? std::optional{min} : std::nullopt;
+  }
+  std::optional<double> Max() const {
+    return count ? std::optional{max} : std::nullopt;
+  }
+  std::optional<double> Median() const {
+    return count ? std::optional{median} : std::nullopt;
+  }
+};
+
+// one column partitioned by the sign of each value. `rows` includes nulls.
+struct SignedSummary {
+  size_t rows{0};
+  size_t even{0};
+  ValueSummary all;
+  ValueSummary winning;
+  ValueSummary losing;
+};
+
+struct RoundTripSideSummary {
+  SignedSummary pnl;
+  SignedSummary returns;
+  SignedSummary duration;
+};
+
+struct RoundTripAggregates {
+  RoundTripSideSummary all;
+  RoundTripSideSummary longs;
+  RoundTripSideSummary shorts;
+};
+
+// Single scan over the pnl, returns and duration columns of the extracted
+// round trips. Medians are exact (linear interpolation at 0.5) and are only
+// computed for returns and duration.
+RoundTripAggregates
+AggregateRoundTrips(epoch_frame::DataFrame const &round_trip);
+
+// `topKSymbols` caps the per-symbol table to the best and worst symbols by
+// mean return, 0 keeps every symbol.
 std::vector<epoch_proto::Table>
-GetRoundTripStats(epoch_frame::DataFrame const &round_trip);
+GetRoundTripStats(epoch_frame::DataFrame const &round_trip,
+                  size_t topKSymbols = 0);
+
+/*
+Return stats per symbol, one column each. With `topKSymbols` > 0 and more than
+twice that many symbols, only the best `topKSymbols` then the worst
+`topKSymbols` by mean return are kept and symbols without a valid return are
+dropped; otherwise every symbol is kept in name order.
+*/
+epoch_proto::Table GetSymbolsTable(epoch_frame::DataFrame const &round_trip,
+                                   size_t topKSymbols = 0);
+
+/*
+Matches raw fills into round trips. `transactions` is indexed by timestamp and
+carries `symbol`, `amount` (signed) and `price`. Every fill that reduces a
+position emits one round trip against the lots selected by `matching`; a fill
+that crosses zero closes the position and opens the remainder on the other
+side. The output has the schema of TearSheetDataOption::roundTrip:
+open_datetime, close_datetime, side ("Long"/"Short"), asset and net_return.
+*/
+epoch_frame::DataFrame ExtractRoundTripsFromTransactions(
+    epoch_frame::DataFrame const &transactions,
+    epoch_core::RoundTripMatching matching =
+        epoch_core::RoundTripMatching::FIFO);
 
 epoch_frame::DataFrame
 GetProfitAttribution(epoch_frame::DataFrame const &round_trip,
@@ -4,12 +4,15 @@
 
 #include "timeseries.h"
 
+#include <epoch_frame/factory/dataframe_factory.h>
 #include <epoch_frame/factory/date_offset_factory.h>
 #include <epoch_frame/factory/index_factory.h>
 #include <epoch_frame/factory/series_factory.h>
 #include <oneapi/tbb/parallel_for.h>
 #include <spdlog/spdlog.h>
 
+#include "common/series_helper.h"
+#include "common/trace.h"
 #include "empyrical/alpha_beta.h"
 #include "interesting_periods.h"
 #include "txn.h"
@@ -18,6 +21,8 @@ using namespace epoch_frame;
 
 namespace epoch_folio {
 Series RollingBeta(DataFrame const &df, int64_t rollingWindow) {
+  trace::Span span{"RollingBeta"};
+  span.SetRows(df.num_rows());
   auto index_array = df.index()->array();
   auto beg_array = index_array[{0, -rollingWindow}];
   auto end_array = index_array[{rollingWindow, std::nullopt}];
@@ -86,6 +91,8 @@ GetTopDrawDownsFromReturns(epoch_frame::Series const &ret, int top) {
 }
 MaxDrawDownUnderwaterList
 GetTopDrawDownsFromCumReturns(epoch_frame::Series const &dfCum, int top) {
+  trace::Span span{"GetTopDrawDownsFromCumReturns"};
+  span.SetRows(static_cast<int64_t>(dfCum.size()));
   Series underWater = GetUnderwaterFromCumReturns(dfCum);
   MaxDrawDownUnderwaterList drawDowns;
 
@@ -111,6 +118,8 @@ GetTopDrawDownsFromCumReturns(epoch_frame::Series const &dfCum, int top) {
 
 DrawDownTable GenerateDrawDownTable(epoch_frame::Series const &returns,
                                     int64_t top) {
+  trace::Span span{"GenerateDrawDownTable"};
+  span.SetRows(static_cast<int64_t>(returns.size()));
   auto dfCum = ep::CumReturns(returns, 1.0);
   auto drawDownPeriods = GetTopDrawDownsFromCumReturns(dfCum, top);
 
@@ -144,8 +153,81 @@ DrawDownTable GenerateDrawDownTable(epoch_frame::Series const &returns,
   return table;
 }
 
+DataFrame DrawDownTableToFrame(DrawDownTable const &table) {
+  const auto timestampType = arrow::timestamp(arrow::TimeUnit::NANO);
+  arrow::Int64Builder indexBuilder;
+  arrow::TimestampBuilder peakBuilder(timestampType,
+                                      arrow::default_memory_pool());
+  arrow::TimestampBuilder valleyBuilder(timestampType,
+                                        arrow::default_memory_pool());
+  arrow::TimestampBuilder recoveryBuilder(timestampType,
+                                          arrow::default_memory_pool());
+  arrow::DoubleBuilder netDrawdownBuilder;
+  arrow::UInt64Builder durationBuilder;
+
+  auto nanoseconds = [](Date const &date) {
+    return DateTime{date}.m_nanoseconds.count();
+  };
+  for (auto const &row : table) {
+    ThrowIfNotOk(indexBuilder.Append(row.index));
+    ThrowIfNotOk(peakBuilder.Append(nanoseconds(row.peakDate)));
+    ThrowIfNotOk(valleyBuilder.Append(nanoseconds(row.valleyDate)));
+    ThrowIfNotOk(row.recoveryDate
+                     ? recoveryBuilder.Append(nanoseconds(*row.recoveryDate))
+                     : recoveryBuilder.AppendNull());
+    ThrowIfNotOk(row.netDrawdown.is_valid()
+                     ? netDrawdownBuilder.Append(
+                           row.netDrawdown.cast_double().as_double())
+                     : netDrawdownBuilder.AppendNull());
+    ThrowIfNotOk(row.duration.is_valid()
+                     ? durationBuilder.Append(
+                           row.duration.value<uint64_t>().value())
+                     : durationBuilder.AppendNull());
+  }
+
+  auto finish = [](arrow::ArrayBuilder &builder) {
+    return builder.Finish().ValueOrDie();
+  };
+  return make_dataframe(arrow::Table::Make(
+      arrow::schema({arrow::field("episode", arrow::int64()),
+                     arrow::field("peakDate", timestampType),
+                     arrow::field("valleyDate", timestampType),
+                     arrow::field("recoveryDate", timestampType),
+                     arrow::field("netDrawdown", arrow::float64()),
+                     arrow::field("duration", arrow::uint64())}),
+      std::vector{finish(indexBuilder), finish(peakBuilder),
+                  finish(valleyBuilder), finish(recoveryBuilder),
+                  finish(netDrawdownBuilder), finish(durationBuilder)}));
+}
+
+DrawDownTable DrawDownTableFromFrame(DataFrame const &frame) {
+  DrawDownTable table;
+  table.reserve(frame.num_rows());
+  const auto episode = frame["episode"];
+  const auto peak = frame["peakDate"];
+  const auto valley = frame["valleyDate"];
+  const auto recovery = frame["recoveryDate"];
+  const auto netDrawdown = frame["netDrawdown"];
+  const auto duration = frame["duration"];
+  for (int64_t i = 0; i < static_cast<int64_t>(frame.num_rows()); ++i) {
+    DrawDownTableRow row{.index = episode.iloc(i).value<int64_t>().value(),
+                         .peakDate = peak.iloc(i).to_date().date(),
+                         .valleyDate = valley.iloc(i).to_date().date(),
+                         .recoveryDate = std::nullopt,
+                         .netDrawdown = netDrawdown.iloc(i),
+                         .duration = duration.iloc(i)};
+    if (const auto date = recovery.iloc(i); date.is_valid()) {
+      row.recoveryDate = date.to_date().date();
+    }
+    table.push_back(std::move(row));
+  }
+  return table;
+}
+
 Series RollingVolatility(epoch_frame::Series const &returns,
                          int64_t rollingVolWindow) {
+  trace::Span span{"RollingVolatility"};
+  span.SetRows(static_cast<int64_t>(returns.size()));
   static const Scalar multiplier{std::sqrt(ep::APPROX_BDAYS_PER_YEAR)};
   return returns
              .rolling_agg(
@@ -156,6 +238,8 @@ Series RollingVolatility(epoch_frame::Series const &returns,
 
 Series RollingSharpe(epoch_frame::Series const &returns,
                      int64_t rollingVolWindow) {
+  trace::Span span{"RollingSharpe"};
+  span.SetRows(static_cast<int64_t>(returns.size()));
   static const Scalar multiplier{std::sqrt(ep::APPROX_BDAYS_PER_YEAR)};
   auto agg = returns.rolling_agg(
       window::RollingWindowOptions{.window_size = rollingVolWindow});
@@ -165,7 +249,7 @@ Series RollingSharpe(epoch_frame::Series const &returns,
 InterestingDateRangeReturns
 ExtractInterestingDateRanges(epoch_frame::Series const &returns,
                              InterestingDateRanges const &periods) {
-
+  EPOCH_FOLIO_TRACE("ExtractInterestingDateRanges");
   InterestingDateRangeReturns ranges;
   for (auto const &[name, start, end] : periods) {
     try {
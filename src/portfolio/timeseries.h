@@ -55,6 +55,11 @@ namespace epoch_folio {
 
     DrawDownTable GenerateDrawDownTable(epoch_frame::Series const &returns, int64_t top);
 
+    // columnar form of a drawdown table, one row per episode, for storing it
+    // with other frames
+    epoch_frame::DataFrame DrawDownTableToFrame(DrawDownTable const &table);
+    DrawDownTable DrawDownTableFromFrame(epoch_frame::DataFrame const &frame);
+
     epoch_frame::Series RollingVolatility(epoch_frame::Series const &returns, int64_t rollingVolWindow);
 
     epoch_frame::Series RollingSharpe(epoch_frame::Series const &returns, int64_t rollingSharpeWindow);
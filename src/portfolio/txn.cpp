@@ -3,12 +3,15 @@
 //
 
 #include "txn.h"
+#include "common/trace.h"
 
 namespace epoch_folio {
 epoch_frame::Series
 GetTurnover(epoch_frame::DataFrame const &positions,
             epoch_frame::DataFrame const &transactions,
             epoch_core::TurnoverDenominator turnoverDenominator) {
+  trace::Span span{"GetTurnover"};
+  span.SetRows(transactions.num_rows());
   epoch_frame::Series tradedValue =
       GetTransactionVolume(transactions)["txn_volume"];
 
@@ -31,6 +34,8 @@ GetTurnover(epoch_frame::DataFrame const &positions,
 }
 
 epoch_frame::DataFrame GetTransactionVolume(epoch_frame::DataFrame const &df) {
+  trace::Span span{"GetTransactionVolume"};
+  span.SetRows(df.num_rows());
   epoch_frame::Series amounts = df["amount"].abs();
   epoch_frame::Series values =
       df.contains("txn_volume") ? df["txn_volume"] : amounts * df["price"];
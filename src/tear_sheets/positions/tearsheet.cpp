@@ -2,6 +2,7 @@
 // Created by adesola on 1/14/25.
 //
 
+#include "common/downsample.h"
 #include "tearsheet.h"
 
 #include "common/type_helper.h"
@@ -19,13 +20,62 @@ using namespace epoch_core;
 namespace epoch_folio::positions {
 const Scalar ZERO{0.0};
 
+namespace {
+struct TopPositions {
+  DataFrame positions; // with cash
+  DataFrame allocations; // top absolute positions only
+  std::array<Series, 3> top;
+};
+
+struct HoldingMasks {
+  DataFrame noZero;
+  DataFrame isLong;
+  DataFrame isShort;
+};
+
+std::optional<TopPositions> MakeTopPositions(DataFrame const &positionsNoCash,
+                                             Series const &cash) {
+  auto positions = epoch_frame::concat({.frames = {positionsNoCash,
+                                                   cash.to_frame("cash")},
+                                        .axis = epoch_frame::AxisType::Column});
+
+  auto positionsAlloc = epoch_folio::GetPercentAlloc(positions);
+  auto topPositions = epoch_folio::GetTopLongShortAbs(positionsAlloc);
+
+  if (topPositions[2].size() == 0) {
+    SPDLOG_WARN("No top positions found");
+    return std::nullopt;
+  }
+
+  auto columns = topPositions[2].index()->array();
+  return TopPositions{std::move(positions), positionsAlloc[columns],
+                      std::move(topPositions)};
+}
+
+HoldingMasks MakeHoldingMasks(DataFrame const &positionsNoCash) {
+  auto noZero = positionsNoCash.where(positionsNoCash != ZERO, Scalar{});
+  auto isLong = noZero.where(noZero > ZERO, Scalar{});
+  auto isShort = noZero.where(noZero < ZERO, Scalar{});
+  return {std::move(noZero), std::move(isLong), std::move(isShort)};
+}
+} // namespace
+
 TearSheetFactory::TearSheetFactory(
     epoch_frame::Series cash, epoch_frame::DataFrame positions,
     epoch_frame::Series returns,
-    std::unordered_map<std::string, std::string> sectorMappings)
+    std::unordered_map<std::string, std::string> sectorMappings,
+    std::optional<AssetClassification> classification)
     : m_cash(std::move(cash).rename("cash")),
-      m_positionsNoCash(std::move(positions)), m_strategy(std::move(returns)),
-      m_sectorMappings(std::move(sectorMappings)) {}
+      m_positionsNoCash(std::move(positions)), m_strategy(std::move(returns)) {
+  if (classification) {
+    m_classification = std::move(*classification);
+  } else {
+    auto assets = m_positionsNoCash.column_names();
+    m_classification.levels.emplace_back(
+        MakeClassificationLevel("sector", "Sector", assets, sectorMappings));
+    m_classification.assets = std::move(assets);
+  }
+}
 
 epoch_proto::Table MakeTopPositionsTable(std::string const &id,
                                          std::string const &name,
@@ -52,7 +102,7 @@ epoch_proto::Table MakeTopPositionsTable(std::string const &id,
       epoch_proto::TableRow row;
       *row.add_values() = epoch_tearsheet::ScalarFactory::create(index && i < index->size() ? index->at(i) : Scalar{});
       *row.add_values() = epoch_tearsheet::ScalarFactory::fromPercentValue(x.iloc(i).as_double() * 100);
-      builder.addRow(row);
+      builder.addRow(std::move(row));
     }
     return builder.build();
   } catch (std::exception const &e) {
@@ -90,7 +140,7 @@ MakeTopPositionsTables(std::array<Series, 3> const &topPositions, uint64_t k) {
 epoch_proto::Chart TearSheetFactory::MakeExposureOverTimeChart(
     epoch_frame::DataFrame const &positions,
     epoch_frame::DataFrame const &isLong,
-    epoch_frame::DataFrame const &isShort) const {
+    epoch_frame::DataFrame const &isShort, size_t maxPoints) const {
   try {
     auto positionSum = positions.sum(AxisType::Column);
 
@@ -109,16 +159,16 @@ epoch_proto::Chart TearSheetFactory::MakeExposureOverTimeChart(
 
     // Long/Short lines
     epoch_tearsheet::LineBuilder longLineBuilder;
-    longLineBuilder.setName("Long").fromSeries(longExposure);
+    longLineBuilder.setName("Long").fromSeries(Downsample(longExposure, maxPoints));
     builder.addLine(longLineBuilder.build());
 
     epoch_tearsheet::LineBuilder shortLineBuilder;
-    shortLineBuilder.setName("Short").fromSeries(shortExposure);
+    shortLineBuilder.setName("Short").fromSeries(Downsample(shortExposure, maxPoints));
     builder.addLine(shortLineBuilder.build());
 
     // Net overlay as an additional line
     epoch_tearsheet::LineBuilder netLineBuilder;
-    netLineBuilder.setName("Net").fromSeries(netExposure);
+    netLineBuilder.setName("Net").fromSeries(Downsample(netExposure, maxPoints));
     builder.addLine(netLineBuilder.build());
 
     return builder.build();
@@ -133,17 +183,18 @@ epoch_proto::Chart TearSheetFactory::MakeExposureOverTimeChart(
 }
 
 epoch_proto::Chart TearSheetFactory::MakeAllocationOverTimeChart(
-    epoch_frame::DataFrame const &topPositionAllocations) const {
+    epoch_frame::DataFrame const &topPositionAllocations,
+    size_t maxPoints) const {
+  const auto allocations = Downsample(topPositionAllocations, maxPoints);
   epoch_tearsheet::LinesChartBuilder builder;
   builder.setId("allocationOverTime")
       .setTitle("Allocation over time")
       .setCategory(epoch_folio::categories::Positions);
 
   // Add a line for each column in the DataFrame
-  for (const auto &columnName : topPositionAllocations.column_names()) {
+  for (const auto &columnName : allocations.column_names()) {
     epoch_tearsheet::LineBuilder lineBuilder;
-    lineBuilder.setName(columnName)
-        .fromSeries(topPositionAllocations[columnName]);
+    lineBuilder.setName(columnName).fromSeries(allocations[columnName]);
     builder.addLine(lineBuilder.build());
   }
   return builder.build();
@@ -166,9 +217,9 @@ epoch_proto::Chart TearSheetFactory::MakeAllocationSummaryChart(
   return builder.build();
 }
 
-epoch_proto::Chart TearSheetFactory::MakeTotalHoldingsChart(
-    epoch_frame::DataFrame const &positionsNoCashNoZero) const {
-  auto dailyHoldings = positionsNoCashNoZero.count_valid(AxisType::Column);
+epoch_proto::Chart
+TearSheetFactory::MakeTotalHoldingsChart(epoch_frame::Series const &dailyHoldings,
+                                         size_t maxPoints) const {
   auto holdingsByMonth =
       dailyHoldings.resample_by_agg({factory::offset::month_end(1)}).mean();
   auto avgDailyHoldings = dailyHoldings.mean();
@@ -180,7 +231,8 @@ epoch_proto::Chart TearSheetFactory::MakeTotalHoldingsChart(
 
   // Daily holdings line
   epoch_tearsheet::LineBuilder dailyLineBuilder;
-  dailyLineBuilder.setName("Daily holdings").fromSeries(dailyHoldings.cast(arrow::float64()));
+  dailyLineBuilder.setName("Daily holdings")
+      .fromSeries(Downsample(dailyHoldings.cast(arrow::float64()), maxPoints));
   builder.addLine(dailyLineBuilder.build());
 
   // Monthly average line with thicker width
@@ -202,7 +254,7 @@ epoch_proto::Chart TearSheetFactory::MakeTotalHoldingsChart(
 
 epoch_proto::Chart TearSheetFactory::MakeLongShortHoldingsChart(
     epoch_frame::DataFrame const &isLong,
-    epoch_frame::DataFrame const &isShort) const {
+    epoch_frame::DataFrame const &isShort, size_t maxPoints) const {
   try {
     auto longHoldings = isLong.count_valid(AxisType::Column);
     auto shortHoldings = isShort.count_valid(AxisType::Column);
@@ -247,12 +299,16 @@ epoch_proto::Chart TearSheetFactory::MakeLongShortHoldingsChart(
 
     // Add long holdings line
     epoch_tearsheet::LineBuilder longLineBuilder;
-    longLineBuilder.setName(longHoldingLegend).fromSeries(longHoldings.cast(arrow::float64()));
+    longLineBuilder.setName(longHoldingLegend)
+        .fromSeries(
+            Downsample(longHoldings.cast(arrow::float64()), maxPoints));
     builder.addLine(longLineBuilder.build());
 
     // Add short holdings line
     epoch_tearsheet::LineBuilder shortLineBuilder;
-    shortLineBuilder.setName(shortHoldingLegend).fromSeries(shortHoldings.cast(arrow::float64()));
+    shortLineBuilder.setName(shortHoldingLegend)
+        .fromSeries(
+            Downsample(shortHoldings.cast(arrow::float64()), maxPoints));
     builder.addLine(shortLineBuilder.build());
 
     return builder.build();
@@ -266,10 +322,10 @@ epoch_proto::Chart TearSheetFactory::MakeLongShortHoldingsChart(
   }
 }
 
-epoch_proto::Chart TearSheetFactory::MakeGrossLeverageChart() const {
+epoch_proto::Chart
+TearSheetFactory::MakeGrossLeverageChart(epoch_frame::Series const &grossLeverage,
+                                         size_t maxPoints) const {
   try {
-    auto grossLeverage =
-        GrossLeverage(m_positionsNoCash.assign("cash", m_cash));
     auto glMean = grossLeverage.mean();
 
     epoch_tearsheet::LinesChartBuilder builder;
@@ -278,7 +334,8 @@ epoch_proto::Chart TearSheetFactory::MakeGrossLeverageChart() const {
         .setCategory(epoch_folio::categories::Positions);
 
     epoch_tearsheet::LineBuilder lineBuilder;
-    lineBuilder.setName("Gross Leverage").fromSeries(grossLeverage);
+    lineBuilder.setName("Gross Leverage")
+        .fromSeries(Downsample(grossLeverage, maxPoints));
     builder.addLine(lineBuilder.build());
 
     epoch_proto::StraightLineDef straightLine;
@@ -298,121 +355,127 @@ epoch_proto::Chart TearSheetFactory::MakeGrossLeverageChart() const {
   }
 }
 
-epoch_proto::Chart TearSheetFactory::MakeSectorExposureChart() const {
-  auto sectorExposures = GetSectorExposure(m_positionsNoCash, m_sectorMappings);
-  sectorExposures = sectorExposures.assign("cash", m_cash);
-  auto sectorAlloc = GetPercentAlloc(sectorExposures).drop("cash");
+std::vector<epoch_proto::Chart> TearSheetFactory::MakeExposureCharts() const {
+  std::vector<epoch_proto::Chart> charts;
+  for (auto const &level : GetExposures(m_positionsNoCash, m_classification)) {
+    // allocation relative to the classified book plus cash
+    auto alloc = level.net / (level.net.sum(AxisType::Column) + m_cash);
 
-  epoch_tearsheet::LinesChartBuilder builder;
-  builder.setId("sectorExposure")
-      .setTitle("Sector Allocation over time")
-      .setCategory(epoch_folio::categories::Positions);
+    epoch_tearsheet::LinesChartBuilder builder;
+    builder.setId(std::format("{}Exposure", level.id))
+        .setTitle(std::format("{} Allocation over time", level.name))
+        .setCategory(epoch_folio::categories::Positions);
 
-  // Add a line for each sector column
-  for (const auto &columnName : sectorAlloc.column_names()) {
-    epoch_tearsheet::LineBuilder lineBuilder;
-    lineBuilder.setName(columnName).fromSeries(sectorAlloc[columnName]);
-    builder.addLine(lineBuilder.build());
+    // Add a line for each label column
+    for (const auto &columnName : alloc.column_names()) {
+      epoch_tearsheet::LineBuilder lineBuilder;
+      lineBuilder.setName(columnName).fromSeries(alloc[columnName]);
+      builder.addLine(lineBuilder.build());
+    }
+    charts.push_back(builder.build());
   }
-
-  return builder.build();
+  return charts;
 }
 
-std::vector<epoch_proto::Chart> TearSheetFactory::MakeTopPositionsLineCharts(
-    DataFrame const &positions, DataFrame const &topPositionAllocations) const {
-  auto positionsNoCashNoZero =
-      m_positionsNoCash.where(m_positionsNoCash != ZERO, Scalar{});
-
-  auto isLong =
-      positionsNoCashNoZero.where(positionsNoCashNoZero > ZERO, Scalar{});
-  auto isShort =
-      positionsNoCashNoZero.where(positionsNoCashNoZero < ZERO, Scalar{});
-
-  std::vector<epoch_proto::Chart> result;
-
-  try {
-    result.push_back(MakeExposureOverTimeChart(positions, isLong, isShort));
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create exposure over time chart: {}", e.what());
-  }
-
-  try {
-    result.push_back(MakeAllocationOverTimeChart(topPositionAllocations));
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create allocation over time chart: {}", e.what());
-  }
-
-  try {
-    result.push_back(MakeAllocationSummaryChart(positions));
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create allocation summary chart: {}", e.what());
-  }
-
-  try {
-    result.push_back(MakeTotalHoldingsChart(positionsNoCashNoZero));
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create total holdings chart: {}", e.what());
-  }
-
-  try {
-    result.push_back(MakeLongShortHoldingsChart(isLong, isShort));
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create long short holdings chart: {}", e.what());
-  }
-
-  try {
-    result.push_back(MakeGrossLeverageChart());
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create gross leverage chart: {}", e.what());
-  }
-
-  try {
-    result.push_back(MakeSectorExposureChart());
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create sector exposure chart: {}", e.what());
-  }
+Series TearSheetFactory::GrossLeverageSeries() const {
+  return GrossLeverage(m_positionsNoCash.assign("cash", m_cash));
+}
 
-  return result;
+void TearSheetFactory::Schedule(WidgetGraph &graph, uint32_t k,
+                                size_t maxPoints) const {
+  using epoch_folio::categories::Positions;
+  constexpr auto kInputs = widget_inputs::Positions;
+
+  // every widget is skipped when there are no top positions
+  auto top = MakeIntermediate<TopPositions>();
+  auto topNode = graph.Add(
+      {"topPositionsFrame", "", {}, kInputs}, [this, top](WidgetList &) {
+        *top = MakeTopPositions(m_positionsNoCash, m_cash);
+      });
+  graph.Releases(topNode, top);
+
+  auto masks = MakeIntermediate<HoldingMasks>();
+  auto masksNode =
+      graph.Add({"holdingMasks", "", {}, kInputs}, [this, masks](WidgetList &) {
+        *masks = MakeHoldingMasks(m_positionsNoCash);
+      });
+  graph.Releases(masksNode, masks);
+
+  graph.Add({"exposure", Positions, {topNode, masksNode}, kInputs},
+            [this, top, masks, maxPoints](WidgetList &out) {
+              if (!top->has_value()) {
+                return;
+              }
+              out.emplace_back(MakeExposureOverTimeChart(
+                  (*top)->positions, masks->value().isLong,
+                  masks->value().isShort, maxPoints));
+            });
+
+  graph.Add({"allocationOverTime", Positions, {topNode}, kInputs},
+            [this, &graph, top, maxPoints](WidgetList &out) {
+              if (top->has_value()) {
+                graph.Publish(
+                    {"allocationOverTime", Positions, (*top)->allocations});
+                out.emplace_back(MakeAllocationOverTimeChart(
+                    (*top)->allocations, maxPoints));
+              }
+            });
+
+  graph.Add({"allocationSummary", Positions, {topNode}, kInputs},
+            [this, top](WidgetList &out) {
+              if (top->has_value()) {
+                out.emplace_back(MakeAllocationSummaryChart((*top)->positions));
+              }
+            });
+
+  graph.Add({"totalHoldings", Positions, {topNode, masksNode}, kInputs},
+            [this, &graph, top, masks, maxPoints](WidgetList &out) {
+              if (top->has_value()) {
+                const auto dailyHoldings =
+                    masks->value().noZero.count_valid(AxisType::Column);
+                graph.Publish({"totalHoldings", Positions,
+                               dailyHoldings.to_frame("Daily holdings")});
+                out.emplace_back(
+                    MakeTotalHoldingsChart(dailyHoldings, maxPoints));
+              }
+            });
+
+  graph.Add({"longShortHoldings", Positions, {topNode, masksNode}, kInputs},
+            [this, top, masks, maxPoints](WidgetList &out) {
+              if (top->has_value()) {
+                out.emplace_back(MakeLongShortHoldingsChart(
+                    masks->value().isLong, masks->value().isShort, maxPoints));
+              }
+            });
+
+  graph.Add({"grossLeverage", Positions, {topNode}, kInputs},
+            [this, &graph, top, maxPoints](WidgetList &out) {
+              if (top->has_value()) {
+                const auto grossLeverage = GrossLeverageSeries();
+                graph.Publish({"grossLeverage", Positions,
+                               grossLeverage.to_frame("Gross Leverage")});
+                out.emplace_back(
+                    MakeGrossLeverageChart(grossLeverage, maxPoints));
+              }
+            });
+
+  graph.Add({"classificationExposure", Positions, {topNode}, kInputs},
+            [this, top](WidgetList &out) {
+              if (top->has_value()) {
+                AppendWidgets(out, MakeExposureCharts());
+              }
+            });
+
+  graph.Add({"topPositions", Positions, {topNode}, kInputs},
+            [k, top](WidgetList &out) {
+              if (top->has_value()) {
+                AppendWidgets(out, MakeTopPositionsTables((*top)->top, k));
+              }
+            });
 }
 
 void TearSheetFactory::Make(uint32_t k,
                             epoch_tearsheet::DashboardBuilder &output) const {
-  try {
-    auto positions = epoch_frame::concat(
-        {.frames = {m_positionsNoCash, m_cash.to_frame("cash")},
-         .axis = epoch_frame::AxisType::Column});
-
-    auto positionsAlloc = epoch_folio::GetPercentAlloc(positions);
-    auto topPositions = epoch_folio::GetTopLongShortAbs(positionsAlloc);
-
-    if (topPositions[2].size() == 0) {
-      SPDLOG_WARN("No top positions found");
-      return;
-    }
-
-    auto columns = topPositions[2].index()->array();
-
-    // Charts for top positions and summaries
-    try {
-      auto charts =
-          MakeTopPositionsLineCharts(positions, positionsAlloc[columns]);
-      for (auto &chart : charts) {
-        output.addChart(chart);
-      }
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to build positions charts: {}", e.what());
-    }
-    // Tables for top positions
-    try {
-      auto tables = MakeTopPositionsTables(topPositions, k);
-      for (auto &table : tables) {
-        output.addTable(table);
-      }
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to build positions tables: {}", e.what());
-    }
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Exception in TearSheetFactory::Make: {}", e.what());
-  }
+  RunSerial(output, [&](WidgetGraph &graph) { Schedule(graph, k); });
 }
-} // namespace epoch_folio::positions
\ No newline at end of file
+} // namespace epoch_folio::positions
@@ -6,6 +6,7 @@
 #include "epoch_dashboard/tearsheet/dashboard_builders.h"
 #include "epoch_frame/dataframe.h"
 #include "portfolio/model.h"
+#include "tear_sheets/widget_graph.h"
 #include <epoch_protos/tearsheet.pb.h>
 
 namespace epoch_folio::positions {
@@ -13,10 +14,14 @@ class TearSheetFactory {
 public:
   TearSheetFactory(epoch_frame::Series cash, epoch_frame::DataFrame positions,
                    epoch_frame::Series returns,
-                   std::unordered_map<std::string, std::string> sectorMappings);
+                   std::unordered_map<std::string, std::string> sectorMappings,
+                   std::optional<AssetClassification> classification = std::nullopt);
 
   void Make(uint32_t k, epoch_tearsheet::DashboardBuilder &output) const;
 
+  // maxPoints caps the points of each line chart, 0 keeps all of them
+  void Schedule(WidgetGraph &graph, uint32_t k, size_t maxPoints = 0) const;
+
 protected:
   TearSheetFactory() = default;
 
@@ -30,30 +35,33 @@ protected:
     m_positionsNoCash = std::move(positions);
   }
 
-  std::vector<epoch_proto::Chart> MakeTopPositionsLineCharts(
-      epoch_frame::DataFrame const &positions,
-      epoch_frame::DataFrame const &topPositionAllocations) const;
-
 private:
   epoch_frame::Series m_cash;
   epoch_frame::DataFrame m_positionsNoCash;
   epoch_frame::Series m_strategy;
-  std::unordered_map<std::string, std::string> m_sectorMappings;
+  AssetClassification m_classification;
 
   epoch_proto::Chart
   MakeExposureOverTimeChart(epoch_frame::DataFrame const &positions,
                             epoch_frame::DataFrame const &isLong,
-                            epoch_frame::DataFrame const &isShort) const;
+                            epoch_frame::DataFrame const &isShort,
+                            size_t maxPoints = 0) const;
   epoch_proto::Chart MakeAllocationOverTimeChart(
-      epoch_frame::DataFrame const &topPositionAllocations) const;
+      epoch_frame::DataFrame const &topPositionAllocations,
+      size_t maxPoints = 0) const;
   epoch_proto::Chart
   MakeAllocationSummaryChart(epoch_frame::DataFrame const &positions) const;
   epoch_proto::Chart
-  MakeTotalHoldingsChart(epoch_frame::DataFrame const &positions) const;
+  MakeTotalHoldingsChart(epoch_frame::Series const &dailyHoldings,
+                         size_t maxPoints = 0) const;
   epoch_proto::Chart
   MakeLongShortHoldingsChart(epoch_frame::DataFrame const &isLong,
-                             epoch_frame::DataFrame const &isShort) const;
-  epoch_proto::Chart MakeGrossLeverageChart() const;
-  epoch_proto::Chart MakeSectorExposureChart() const;
+                             epoch_frame::DataFrame const &isShort,
+                             size_t maxPoints = 0) const;
+  epoch_frame::Series GrossLeverageSeries() const;
+  epoch_proto::Chart
+  MakeGrossLeverageChart(epoch_frame::Series const &grossLeverage,
+                         size_t maxPoints = 0) const;
+  std::vector<epoch_proto::Chart> MakeExposureCharts() const;
 };
 } // namespace epoch_folio::positions
\ No newline at end of file
@@ -4,12 +4,16 @@
 
 #include "tearsheet.h"
 
+#include "common/downsample.h"
+#include "common/trace.h"
 #include "common/type_helper.h"
 #include "epoch_folio/tearsheet.h"
 #include <algorithm>
+#include <format>
 #include <spdlog/spdlog.h>
 
 #include "epoch_frame/scalar.h"
+#include "portfolio/align.h"
 #include "portfolio/timeseries.h"
 #include "portfolio/txn.h"
 #include <epoch_folio/empyrical_all.h>
@@ -31,6 +35,10 @@ using epoch_proto::Chart;
 using epoch_proto::StraightLineDef;
 
 namespace epoch_folio::returns {
+  // returns widgets read nothing but the strategy and benchmark returns
+  constexpr uint8_t kInputs =
+      widget_inputs::Returns | widget_inputs::Benchmark;
+
   StraightLineDef MakeStraightLine(const std::string& title, const Scalar& value, bool vertical) {
     StraightLineDef straightLine;
     straightLine.set_title(title);
@@ -47,6 +55,44 @@ namespace epoch_folio::returns {
 
   constexpr const char *kBenchmarkColumnName = "benchmark";
   constexpr const char *kStrategyColumnName = "strategy";
+  static_assert(kRollingWindow == 6 * ep::APPROX_BDAYS_PER_MONTH);
+
+  namespace {
+    std::shared_ptr<const BenchmarkArtifacts>
+    DeriveArtifacts(epoch_frame::Series source, epoch_frame::Series returns,
+                    int64_t rollingWindow,
+                    std::optional<ReturnsAlignment> alignment) {
+      auto cumReturns = ep::CumReturns(returns, 1.0);
+      auto interesting = ExtractInterestingDateRanges(returns);
+      auto rollingSharpe = RollingSharpe(returns, rollingWindow);
+      auto rollingVolatility = RollingVolatility(returns, rollingWindow);
+      return std::make_shared<const BenchmarkArtifacts>(BenchmarkArtifacts{
+          std::move(source), std::move(returns), std::move(cumReturns),
+          std::move(interesting), rollingWindow, std::move(rollingSharpe),
+          std::move(rollingVolatility), std::move(alignment)});
+    }
+  } // namespace
+
+  std::shared_ptr<const BenchmarkArtifacts>
+  BenchmarkArtifacts::Make(epoch_frame::Series const &benchmark,
+                           int64_t rollingWindow) {
+    EPOCH_FOLIO_TRACE("returns::BenchmarkArtifacts::Make");
+    // alignment forward fills and drops nulls, doing it up front keeps the
+    // shared series identical to an aligned one
+    return DeriveArtifacts(benchmark, benchmark.ffill().drop_null(),
+                           rollingWindow, std::nullopt);
+  }
+
+  std::shared_ptr<const BenchmarkArtifacts>
+  BenchmarkArtifacts::MakeAligned(epoch_frame::Series const &benchmark,
+                                  epoch_frame::Series const &strategy,
+                                  AlignFill fill, int64_t rollingWindow) {
+    EPOCH_FOLIO_TRACE("returns::BenchmarkArtifacts::MakeAligned");
+    ReturnsAlignment alignment{strategy, benchmark, fill};
+    auto returns = alignment.Benchmark();
+    return DeriveArtifacts(benchmark, std::move(returns), rollingWindow,
+                           std::move(alignment));
+  }
 
   void TearSheetFactory::SetStrategyReturns(
       epoch_frame::Series const &strategyReturns) {
@@ -59,43 +105,109 @@ namespace epoch_folio::returns {
   }
 
   DataFrame TearSheetFactory::GetStrategyAndBenchmark() const {
-    if (!m_benchmark.has_value()) {
-      return MakeDataFrame({m_strategyCumReturns}, {kStrategyColumnName});
+    std::vector<Series> series{m_strategyCumReturns};
+    std::vector<std::string> columns{kStrategyColumnName};
+    if (m_benchmark.has_value()) {
+      series.push_back(m_benchmarkCumReturns);
+      columns.emplace_back(kBenchmarkColumnName);
+    }
+    for (auto const &benchmark : m_extraBenchmarks) {
+      series.push_back(benchmark.cumReturns);
+      columns.push_back(benchmark.name);
     }
-    return MakeDataFrame({m_strategyCumReturns, m_benchmarkCumReturns},
-                         {kStrategyColumnName, kBenchmarkColumnName});
+    return MakeDataFrame(series, columns);
   }
 
   void TearSheetFactory::AlignReturnsAndBenchmark(
-      epoch_frame::Series const &returns, std::optional<epoch_frame::Series> const &benchmark) {
-    if (!benchmark.has_value()) {
+      epoch_frame::Series const &returns,
+      std::optional<epoch_frame::Series> const &benchmark,
+      std::vector<NamedBenchmark> const &extraBenchmarks,
+      AlignFill fill) {
+    trace::Span span{"returns::AlignReturnsAndBenchmark"};
+    span.SetRows(static_cast<int64_t>(returns.size()));
+    m_extraBenchmarks.clear();
+    if (!benchmark.has_value() && extraBenchmarks.empty()) {
       m_strategy = returns;
       m_benchmark = std::nullopt;
       return;
     }
 
-    auto merged =
-        epoch_frame::concat({.frames = {returns.to_frame(kStrategyColumnName),
-                                        benchmark->to_frame(kBenchmarkColumnName)},
-                             .axis = epoch_frame::AxisType::Column})
-            .ffill()
-            .drop_null();
-    m_strategy = merged[kStrategyColumnName];
-    m_benchmark = merged[kBenchmarkColumnName];
+    // one merge pass puts the strategy and every benchmark on one index
+    std::vector<Series> series{returns};
+    if (benchmark.has_value()) {
+      series.push_back(*benchmark);
+    }
+    for (auto const &extra : extraBenchmarks) {
+      series.push_back(extra.returns);
+    }
+    auto aligned = AlignReturns(series, fill);
+
+    auto next = aligned.begin();
+    m_strategy = std::move(*next++);
+    m_benchmark = benchmark.has_value() ? std::optional{std::move(*next++)}
+                                        : std::nullopt;
+    for (auto const &extra : extraBenchmarks) {
+      m_extraBenchmarks.push_back({extra.name, std::move(*next++), {}});
+    }
+  }
+
+  TearSheetFactory::TearSheetFactory(epoch_frame::DataFrame positions,
+                                     epoch_frame::DataFrame transactions,
+                                     epoch_frame::Series cash,
+                                     epoch_frame::Series strategy,
+                                     std::optional<epoch_frame::Series> benchmark,
+                                     std::vector<NamedBenchmark> extraBenchmarks,
+                                     AlignFill fill)
+      : m_cash(std::move(cash)), m_positions(std::move(positions)),
+        m_transactions(std::move(transactions)) {
+    AlignReturnsAndBenchmark(strategy, benchmark, extraBenchmarks, fill);
+    ComputeCumulativeReturns();
   }
 
   TearSheetFactory::TearSheetFactory(epoch_frame::DataFrame positions,
                                      epoch_frame::DataFrame transactions,
                                      epoch_frame::Series cash,
                                      epoch_frame::Series strategy,
-                                     std::optional<epoch_frame::Series> benchmark)
+                                     SharedBenchmark benchmark,
+                                     std::vector<NamedBenchmark> extraBenchmarks,
+                                     AlignFill fill)
       : m_cash(std::move(cash)), m_positions(std::move(positions)),
         m_transactions(std::move(transactions)) {
-    AlignReturnsAndBenchmark(std::move(strategy), std::move(benchmark));
+    if (benchmark && extraBenchmarks.empty() && benchmark->alignment &&
+        benchmark->alignment->Applies(strategy, fill)) {
+      // aligned once for every strategy on this index
+      m_strategy = benchmark->alignment->Apply(strategy);
+      m_benchmark = benchmark->returns;
+      m_sharedBenchmark = std::move(benchmark);
+    } else if (benchmark && extraBenchmarks.empty() &&
+               !benchmark->alignment &&
+               strategy.index()->equals(benchmark->returns.index()) &&
+               strategy.drop_null().size() == strategy.size()) {
+      // on the same index and without nulls the alignment is the identity
+      m_strategy = std::move(strategy);
+      m_benchmark = benchmark->returns;
+      m_sharedBenchmark = std::move(benchmark);
+    } else {
+      AlignReturnsAndBenchmark(
+          strategy, benchmark ? std::optional{benchmark->source} : std::nullopt,
+          extraBenchmarks, fill);
+    }
+    ComputeCumulativeReturns();
+  }
+
+  bool TearSheetFactory::SharesRollingWindow() const {
+    return m_sharedBenchmark &&
+           m_sharedBenchmark->rollingWindow == kRollingWindow;
+  }
 
+  void TearSheetFactory::ComputeCumulativeReturns() {
+    EPOCH_FOLIO_TRACE("returns::ComputeCumulativeReturns");
     m_strategyCumReturns = ep::CumReturns(m_strategy, 1.0);
 
-    if (m_benchmark.has_value()) {
+    if (m_sharedBenchmark) {
+      m_benchmarkCumReturns = m_sharedBenchmark->cumReturns;
+      m_benchmarkReturnsInteresting = m_sharedBenchmark->interesting;
+    } else if (m_benchmark.has_value()) {
       m_benchmarkCumReturns = ep::CumReturns(*m_benchmark, 1.0);
       m_benchmarkReturnsInteresting = ExtractInterestingDateRanges(*m_benchmark);
     } else {
@@ -103,122 +215,125 @@ namespace epoch_folio::returns {
       m_benchmarkReturnsInteresting = InterestingDateRangeReturns{};
     }
 
+    for (auto &benchmark : m_extraBenchmarks) {
+      benchmark.cumReturns = ep::CumReturns(benchmark.returns, 1.0);
+    }
+
     m_strategyReturnsInteresting = ExtractInterestingDateRanges(m_strategy);
   }
 
-  std::vector<Chart> TearSheetFactory::MakeReturnsLineCharts(
-      const epoch_frame::DataFrame &df) const {
-    std::vector<Chart> result;
+  Chart TearSheetFactory::MakeCumReturnsChart(const epoch_frame::DataFrame &df,
+                                              std::string const &id,
+                                              std::string const &title,
+                                              size_t maxPoints) const {
+    epoch_tearsheet::LinesChartBuilder builder;
+    builder.setId(id).setTitle(title).setCategory(
+        epoch_folio::categories::StrategyBenchmark);
+
+    // Add lines from DataFrame - specify all columns as y columns
+    auto columns = df.column_names();
+    builder.fromDataFrame(Downsample(df, maxPoints), columns);
+    builder.addStraightLine(kStraightLineAtOne);
+    return builder.build();
+  }
 
-    // Only calculate volatility matched returns if benchmark exists
-    epoch_frame::Series volatilityMatchedCumReturns;
-    epoch_frame::Series cumFactorReturns;
+  Chart TearSheetFactory::MakeVolMatchedCumReturnsChart(
+      const epoch_frame::DataFrame &df, size_t maxPoints) const {
+    const auto stddevOptions = arrow::compute::VarianceOptions{1};
+    const auto bmarkVol = m_benchmark->stddev(stddevOptions);
+    const auto returns =
+        (m_strategy / m_strategy.stddev(stddevOptions)) * bmarkVol;
+    const auto volatilityMatchedCumReturns = ep::CumReturns(returns, 1.0);
+
+    epoch_tearsheet::LinesChartBuilder builder;
+    builder.setId("cumReturnsVolMatched")
+        .setTitle("Cumulative returns volatility matched to benchmark")
+        .setCategory(epoch_folio::categories::StrategyBenchmark);
+
+    // Create lines manually for volatility matched returns
+    epoch_tearsheet::LineBuilder strategyLine;
+    strategyLine.setName(kStrategyColumnName)
+        .fromSeries(Downsample(volatilityMatchedCumReturns, maxPoints));
+    builder.addLine(strategyLine.build());
+
+    epoch_tearsheet::LineBuilder benchmarkLine;
+    benchmarkLine.setName(kBenchmarkColumnName)
+        .fromSeries(Downsample(df[kBenchmarkColumnName], maxPoints));
+    builder.addLine(benchmarkLine.build());
+
+    builder.addStraightLine(kStraightLineAtOne);
+    return builder.build();
+  }
 
-    if (m_benchmark.has_value()) {
-      const auto stddevOptions = arrow::compute::VarianceOptions{1};
-      const auto bmarkVol = m_benchmark->stddev(stddevOptions);
-      const auto returns =
-          (m_strategy / m_strategy.stddev(stddevOptions)) * bmarkVol;
-      volatilityMatchedCumReturns = ep::CumReturns(returns, 1.0);
-      cumFactorReturns = df[kBenchmarkColumnName];
-    }
+  Chart TearSheetFactory::MakeReturnsChart(size_t maxPoints) const {
+    epoch_tearsheet::LinesChartBuilder builder;
+    builder.setId("returns")
+        .setTitle("Returns")
+        .setCategory(epoch_folio::categories::StrategyBenchmark);
 
-    // Cumulative returns chart
-    try {
-      epoch_tearsheet::LinesChartBuilder builder;
-      builder.setId("cumReturns")
-          .setTitle("Cumulative returns")
-          .setCategory(epoch_folio::categories::StrategyBenchmark);
+    // Add strategy returns line (converted to percentage)
+    epoch_tearsheet::LineBuilder strategyLine;
+    strategyLine.setName(kStrategyColumnName).fromSeries(
+        Downsample(m_strategy * Scalar{100.0}, maxPoints));
+    builder.addLine(strategyLine.build());
 
-      // Add lines from DataFrame - specify all columns as y columns
-      auto columns = df.column_names();
-      builder.fromDataFrame(df, columns);
-      builder.addStraightLine(kStraightLineAtOne);
-      result.push_back(builder.build());
-    } catch (const std::exception &e) {
-      SPDLOG_ERROR("Failed to create cumulative returns chart: {}", e.what());
-    }
+    builder.addStraightLine(kStraightLineAtZero);
+    return builder.build();
+  }
 
-    // Volatility matched returns chart (only if benchmark exists)
+  DataFrame TearSheetFactory::RollingBetas() const {
+    std::vector<DataFrame> betas;
+    auto addBetas = [&](Series const &benchmark, std::string const &suffix) {
+      // the strategy and every benchmark already share one index
+      const auto df = epoch_frame::make_dataframe(
+          m_strategy.index(), {m_strategy.array(), benchmark.array()},
+          {kStrategyColumnName, kBenchmarkColumnName});
+      betas.push_back(RollingBeta(df, 6 * ep::APPROX_BDAYS_PER_MONTH)
+                          .to_frame("6-mo" + suffix));
+      betas.push_back(RollingBeta(df, 12 * ep::APPROX_BDAYS_PER_MONTH)
+                          .to_frame("12-mo" + suffix));
+    };
     if (m_benchmark.has_value()) {
-      try {
-        epoch_tearsheet::LinesChartBuilder builder;
-        builder.setId("cumReturnsVolMatched")
-            .setTitle("Cumulative returns volatility matched to benchmark")
-            .setCategory(epoch_folio::categories::StrategyBenchmark);
-
-        // Create lines manually for volatility matched returns
-        epoch_tearsheet::LineBuilder strategyLine;
-        strategyLine.setName(kStrategyColumnName).fromSeries(volatilityMatchedCumReturns);
-        builder.addLine(strategyLine.build());
-
-        epoch_tearsheet::LineBuilder benchmarkLine;
-        benchmarkLine.setName(kBenchmarkColumnName).fromSeries(cumFactorReturns);
-        builder.addLine(benchmarkLine.build());
-
-        builder.addStraightLine(kStraightLineAtOne);
-        result.push_back(builder.build());
-      } catch (const std::exception &e) {
-        SPDLOG_ERROR("Failed to create volatility matched returns chart: {}", e.what());
-      }
+      addBetas(*m_benchmark, "");
     }
-
-    // Log scale chart
-    try {
-      epoch_tearsheet::LinesChartBuilder builder;
-      builder.setId("cumReturnsLogScale")
-          .setTitle("Cumulative returns on log scale")
-          .setCategory(epoch_folio::categories::StrategyBenchmark);
-
-      // Add lines from DataFrame - specify all columns as y columns
-      auto columns = df.column_names();
-      builder.fromDataFrame(df, columns);
-      builder.addStraightLine(kStraightLineAtOne);
-      result.push_back(builder.build());
-    } catch (const std::exception &e) {
-      SPDLOG_ERROR("Failed to create log scale returns chart: {}", e.what());
+    for (auto const &benchmark : m_extraBenchmarks) {
+      addBetas(benchmark.returns, " " + benchmark.name);
     }
+    return epoch_frame::concat(
+        {.frames = std::move(betas), .axis = AxisType::Column});
+  }
 
-    // Returns chart
-    try {
-      epoch_tearsheet::LinesChartBuilder builder;
-      builder.setId("returns")
-          .setTitle("Returns")
-          .setCategory(epoch_folio::categories::StrategyBenchmark);
-
-      // Add strategy returns line (converted to percentage)
-      epoch_tearsheet::LineBuilder strategyLine;
-      strategyLine.setName(kStrategyColumnName).fromSeries(m_strategy * Scalar{100.0});
-      builder.addLine(strategyLine.build());
-
-      builder.addStraightLine(kStraightLineAtZero);
-      result.push_back(builder.build());
-    } catch (const std::exception &e) {
-      SPDLOG_ERROR("Failed to create returns chart: {}", e.what());
+  DataFrame TearSheetFactory::RollingSharpeFrame() const {
+    std::vector<Series> series{RollingSharpe(m_strategy, kRollingWindow)};
+    std::vector<std::string> columns{"Sharpe"};
+    if (m_benchmark.has_value()) {
+      series.push_back(SharesRollingWindow()
+                           ? m_sharedBenchmark->rollingSharpe
+                           : RollingSharpe(*m_benchmark, kRollingWindow));
+      columns.emplace_back("Benchmark Sharpe");
     }
-
-    return result;
+    return MakeDataFrame(series, columns);
   }
 
-  void TearSheetFactory::MakeRollingBetaCharts(std::vector<Chart> &lines) const {
-    // Skip if no benchmark
-    if (!m_benchmark.has_value()) {
-      return;
+  DataFrame TearSheetFactory::RollingVolatilityFrame() const {
+    std::vector<Series> series{RollingVolatility(m_strategy, kRollingWindow)};
+    std::vector<std::string> columns{"Volatility"};
+    if (m_benchmark.has_value()) {
+      series.push_back(SharesRollingWindow()
+                           ? m_sharedBenchmark->rollingVolatility
+                           : RollingVolatility(*m_benchmark, kRollingWindow));
+      columns.emplace_back("Benchmark Volatility");
     }
+    return MakeDataFrame(series, columns);
+  }
 
+  void TearSheetFactory::MakeRollingBetaCharts(std::vector<Chart> &lines,
+                                               DataFrame const &rollingBeta,
+                                               size_t maxPoints) const {
     try {
-      const auto df =
-          concat({.frames = {m_strategy, *m_benchmark}, .axis = AxisType::Column});
-      const auto rolling6MonthBeta =
-          RollingBeta(df, 6 * ep::APPROX_BDAYS_PER_MONTH);
-      const auto rolling6MonthMean = rolling6MonthBeta.mean();
-      const auto rolling12MonthBeta =
-          RollingBeta(df, 12 * ep::APPROX_BDAYS_PER_MONTH);
-
-      const auto rollingBeta =
-          epoch_frame::concat({.frames = {rolling6MonthBeta.to_frame("6-mo"),
-                                          rolling12MonthBeta.to_frame("12-mo")},
-                               .axis = AxisType::Column});
+      // the first column is the 6 month beta against the first benchmark
+      const auto rolling6MonthMean =
+          rollingBeta[rollingBeta.column_names().front()].mean();
 
       epoch_tearsheet::LinesChartBuilder builder;
       builder.setId("rolling_beta")
@@ -227,9 +342,10 @@ namespace epoch_folio::returns {
 
       // Add lines from DataFrame - specify all columns as y columns
       auto columns = rollingBeta.column_names();
-      builder.fromDataFrame(rollingBeta, columns);
+      builder.fromDataFrame(Downsample(rollingBeta, maxPoints), columns);
       builder.addStraightLine(kStraightLineAtOne);
-      builder.addStraightLine(MakeStraightLine("6-mo Average", rolling6MonthMean, false));
+      builder.addStraightLine(
+          MakeStraightLine("6-mo Average", rolling6MonthMean, false));
 
       lines.push_back(builder.build());
     } catch (const std::exception &e) {
@@ -237,11 +353,11 @@ namespace epoch_folio::returns {
     }
   }
 
-  void TearSheetFactory::MakeRollingSharpeCharts(
-      std::vector<Chart> &lines) const {
+  void TearSheetFactory::MakeRollingSharpeCharts(std::vector<Chart> &lines,
+                                                 DataFrame const &rolling,
+                                                 size_t maxPoints) const {
     try {
-      const auto strategySharpe =
-          RollingSharpe(m_strategy, 6 * ep::APPROX_BDAYS_PER_MONTH);
+      const auto strategySharpe = rolling["Sharpe"];
 
       epoch_tearsheet::LinesChartBuilder builder;
       builder.setId("rollingSharpe")
@@ -250,14 +366,14 @@ namespace epoch_folio::returns {
 
       // Add strategy Sharpe line
       epoch_tearsheet::LineBuilder strategyLine;
-      strategyLine.setName("Sharpe").fromSeries(strategySharpe);
+      strategyLine.setName("Sharpe").fromSeries(Downsample(strategySharpe, maxPoints));
       builder.addLine(strategyLine.build());
 
       if (m_benchmark.has_value()) {
-        const auto benchmarkSharpe =
-            RollingSharpe(*m_benchmark, 6 * ep::APPROX_BDAYS_PER_MONTH);
+        const auto benchmarkSharpe = rolling["Benchmark Sharpe"];
         epoch_tearsheet::LineBuilder benchmarkLine;
-        benchmarkLine.setName("Benchmark Sharpe").fromSeries(benchmarkSharpe);
+        benchmarkLine.setName("Benchmark Sharpe").fromSeries(
+            Downsample(benchmarkSharpe, maxPoints));
         builder.addLine(benchmarkLine.build());
       }
 
@@ -271,10 +387,10 @@ namespace epoch_folio::returns {
   }
 
   void TearSheetFactory::MakeRollingVolatilityCharts(
-      std::vector<Chart> &lines) const {
+      std::vector<Chart> &lines, DataFrame const &rolling,
+      size_t maxPoints) const {
     try {
-      auto strategyVol =
-          RollingVolatility(m_strategy, 6 * ep::APPROX_BDAYS_PER_MONTH);
+      const auto strategyVol = rolling["Volatility"];
 
       epoch_tearsheet::LinesChartBuilder builder;
       builder.setId("rollingVol")
@@ -283,14 +399,14 @@ namespace epoch_folio::returns {
 
       // Add strategy volatility line
       epoch_tearsheet::LineBuilder strategyLine;
-      strategyLine.setName("Volatility").fromSeries(strategyVol);
+      strategyLine.setName("Volatility").fromSeries(Downsample(strategyVol, maxPoints));
       builder.addLine(strategyLine.build());
 
       if (m_benchmark.has_value()) {
-        auto benchmarkVol =
-            RollingVolatility(*m_benchmark, 6 * ep::APPROX_BDAYS_PER_MONTH);
+        const auto benchmarkVol = rolling["Benchmark Volatility"];
         epoch_tearsheet::LineBuilder benchmarkLine;
-        benchmarkLine.setName("Benchmark Volatility").fromSeries(benchmarkVol);
+        benchmarkLine.setName("Benchmark Volatility").fromSeries(
+            Downsample(benchmarkVol, maxPoints));
         builder.addLine(benchmarkLine.build());
       }
 
@@ -343,15 +459,6 @@ namespace epoch_folio::returns {
     }
   }
 
-  std::vector<Chart> TearSheetFactory::MakeStrategyBenchmarkLineCharts() const {
-    const DataFrame df = GetStrategyAndBenchmark();
-
-    std::vector<Chart> lines = MakeReturnsLineCharts(df);
-    MakeRollingBetaCharts(lines);
-    MakeInterestingDateRangeLineCharts(lines);
-    return lines;
-  }
-
   epoch_proto::CardDef TearSheetFactory::MakePerformanceStats(
       epoch_core::TurnoverDenominator turnoverDenominator) const {
     try {
@@ -452,15 +559,22 @@ namespace epoch_folio::returns {
         }
       }
 
-      if (m_benchmark.has_value()) {
+      // alpha, beta, ... against every benchmark, titled by benchmark name
+      // past the primary one
+      auto addFactorStats = [&](Series const &benchmark,
+                                std::string const &name) {
         try {
           auto merged_returns = epoch_frame::make_dataframe(
-              m_strategy.index(), {m_strategy.array(), m_benchmark->array()},
+              m_strategy.index(), {m_strategy.array(), benchmark.array()},
               {kStrategyColumnName, kBenchmarkColumnName});
           for (auto const &[stat, func] : ep::get_factor_stats()) {
             try {
+              const auto title =
+                  name.empty() ? ep::get_stat_name(stat)
+                               : std::format("{} ({})",
+                                             ep::get_stat_name(stat), name);
               epoch_tearsheet::CardDataBuilder factorBuilder;
-              factorBuilder.setTitle(ep::get_stat_name(stat))
+              factorBuilder.setTitle(title)
                   .setValue(epoch_tearsheet::ScalarFactory::create(epoch_frame::Scalar{func(merged_returns)}))
                   .setType(epoch_proto::TypeDecimal)
                   .setGroup(kGroup3);
@@ -474,6 +588,12 @@ namespace epoch_folio::returns {
           SPDLOG_WARN("Failed to create merged returns for benchmark stats: {}",
                       e.what());
         }
+      };
+      if (m_benchmark.has_value()) {
+        addFactorStats(*m_benchmark, "");
+      }
+      for (auto const &benchmark : m_extraBenchmarks) {
+        addFactorStats(benchmark.returns, benchmark.name);
       }
 
       return cardBuilder.build();
@@ -504,7 +624,7 @@ namespace epoch_folio::returns {
           *row.add_values() = epoch_tearsheet::ScalarFactory::fromPercentValue(strategy.mean().cast_double().as_double() * 100);
           *row.add_values() = epoch_tearsheet::ScalarFactory::fromPercentValue(strategy.min().cast_double().as_double() * 100);
           *row.add_values() = epoch_tearsheet::ScalarFactory::fromPercentValue(strategy.max().cast_double().as_double() * 100);
-          builder.addRow(row);
+          builder.addRow(std::move(row));
         }
       }
 
@@ -515,11 +635,9 @@ namespace epoch_folio::returns {
     }
   }
 
-  epoch_proto::Table TearSheetFactory::MakeWorstDrawdownTable(int64_t top,
-                                                 DrawDownTable &data) const {
+  epoch_proto::Table
+  TearSheetFactory::MakeWorstDrawdownTable(DrawDownTable const &data) const {
     try {
-      data = GenerateDrawDownTable(m_strategy, top);
-
       epoch_tearsheet::TableBuilder builder;
       builder.setType(epoch_proto::WidgetDataTable)
           .setCategory(epoch_folio::categories::RiskAnalysis)
@@ -543,7 +661,7 @@ namespace epoch_folio::returns {
             epoch_tearsheet::ScalarFactory::fromDate(*row.recoveryDate) :
             epoch_tearsheet::ScalarFactory::create(Scalar{});
           *table_row.add_values() = epoch_tearsheet::ScalarFactory::fromDayDuration(row.duration.value<size_t>().value());
-          builder.addRow(table_row);
+          builder.addRow(std::move(table_row));
         }
       }
 
@@ -554,34 +672,113 @@ namespace epoch_folio::returns {
     }
   }
 
- void TearSheetFactory::MakeStrategyBenchmark(
-      TurnoverDenominator turnoverDenominator, epoch_tearsheet::DashboardBuilder& ts) const {
-    try {
-      ts.addCard(MakePerformanceStats(turnoverDenominator));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create performance stats: {}", e.what());
-    }
+  void TearSheetFactory::ScheduleStrategyBenchmark(
+      WidgetGraph &graph, TurnoverDenominator turnoverDenominator,
+      size_t maxPoints) const {
+    using epoch_folio::categories::StrategyBenchmark;
+
+    // reads positions and transactions for turnover
+    graph.Add({"performanceStats", StrategyBenchmark},
+              [this, turnoverDenominator](WidgetList &out) {
+                out.emplace_back(MakePerformanceStats(turnoverDenominator));
+              });
+
+    auto frame = MakeIntermediate<DataFrame>();
+    auto frameNode = graph.Add({"strategyBenchmarkFrame", "", {}, kInputs},
+                               [this, frame](WidgetList &) {
+                                 *frame = GetStrategyAndBenchmark();
+                               });
+    graph.Releases(frameNode, frame);
+
+    graph.Add({"cumReturns", StrategyBenchmark, {frameNode}, kInputs},
+              [this, &graph, frame, maxPoints](WidgetList &out) {
+                graph.Publish({"cumReturns", StrategyBenchmark, frame->value()});
+                out.emplace_back(MakeCumReturnsChart(frame->value(),
+                                                     "cumReturns",
+                                                     "Cumulative returns",
+                                                     maxPoints));
+              });
 
-    try {
-      auto charts = MakeStrategyBenchmarkLineCharts();
-      for (auto &chart : charts) {
-        ts.addChart(std::move(chart));
-      }
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create strategy benchmark charts: {}", e.what());
+    if (m_benchmark.has_value()) {
+      graph.Add(
+          {"cumReturnsVolMatched", StrategyBenchmark, {frameNode}, kInputs},
+          [this, frame, maxPoints](WidgetList &out) {
+            out.emplace_back(
+                MakeVolMatchedCumReturnsChart(frame->value(), maxPoints));
+          });
     }
 
-    try {
-      auto table = MakeStressEventTable();
-      ts.addTable(std::move(table));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create stress event table: {}", e.what());
-    }
+    graph.Add({"cumReturnsLogScale", StrategyBenchmark, {frameNode}, kInputs},
+              [this, frame, maxPoints](WidgetList &out) {
+                out.emplace_back(MakeCumReturnsChart(
+                    frame->value(), "cumReturnsLogScale",
+                    "Cumulative returns on log scale", maxPoints));
+              });
+
+    graph.Add({"returns", StrategyBenchmark, {}, kInputs},
+              [this, &graph, maxPoints](WidgetList &out) {
+                graph.Publish({"returns", StrategyBenchmark,
+                               m_strategy.to_frame(kStrategyColumnName)});
+                out.emplace_back(MakeReturnsChart(maxPoints));
+              });
+
+    graph.Add({"rolling_beta", StrategyBenchmark, {}, kInputs},
+              [this, &graph, maxPoints](WidgetList &out) {
+                // no beta without a benchmark
+                if (!m_benchmark.has_value() && m_extraBenchmarks.empty()) {
+                  return;
+                }
+                auto rollingBeta = RollingBetas();
+                graph.Publish({"rolling_beta", StrategyBenchmark, rollingBeta});
+                std::vector<Chart> lines;
+                MakeRollingBetaCharts(lines, rollingBeta, maxPoints);
+                AppendWidgets(out, std::move(lines));
+              });
+
+    graph.Add({"interestingDateRanges", StrategyBenchmark, {}, kInputs},
+              [this](WidgetList &out) {
+                std::vector<Chart> lines;
+                MakeInterestingDateRangeLineCharts(lines);
+                AppendWidgets(out, std::move(lines));
+              });
+
+    graph.Add({"stressEvents", StrategyBenchmark, {}, kInputs},
+              [this](WidgetList &out) {
+                out.emplace_back(MakeStressEventTable());
+              });
   }
 
+  void TearSheetFactory::MakeStrategyBenchmark(
+      TurnoverDenominator turnoverDenominator, epoch_tearsheet::DashboardBuilder& ts) const {
+    RunSerial(ts, [&](WidgetGraph &graph) {
+      ScheduleStrategyBenchmark(graph, turnoverDenominator);
+    });
+  }
+
+  namespace {
+    // the peak, valley and recovery of every drawdown, kept by Downsample so
+    // the drawdown bands and the underwater troughs stay on the line
+    std::vector<int64_t>
+    DrawDownBandEdges(DrawDownTable const &drawDownTable) {
+      std::vector<int64_t> bandEdges;
+      for (auto const &row : drawDownTable) {
+        bandEdges.push_back(
+            epoch_frame::DateTime{row.peakDate}.m_nanoseconds.count());
+        bandEdges.push_back(
+            epoch_frame::DateTime{row.valleyDate}.m_nanoseconds.count());
+        if (row.recoveryDate) {
+          bandEdges.push_back(
+              epoch_frame::DateTime{*row.recoveryDate}.m_nanoseconds.count());
+        }
+      }
+      std::ranges::sort(bandEdges);
+      return bandEdges;
+    }
+  } // namespace
+
   void TearSheetFactory::MakeRollingMaxDrawdownCharts(
-      std::vector<Chart> &lines, DrawDownTable &drawDownTable,
-      int64_t topKDrawDowns) const {
+      std::vector<Chart> &lines, DrawDownTable const &drawDownTable,
+      int64_t topKDrawDowns, size_t maxPoints) const {
     try {
       epoch_tearsheet::LinesChartBuilder builder;
       builder.setId("drawdowns")
@@ -590,7 +787,8 @@ namespace epoch_folio::returns {
 
       // Add strategy line
       epoch_tearsheet::LineBuilder lineBuilder;
-      lineBuilder.setName("Strategy").fromSeries(m_strategyCumReturns);
+      lineBuilder.setName("Strategy").fromSeries(Downsample(
+          m_strategyCumReturns, maxPoints, DrawDownBandEdges(drawDownTable)));
       builder.addLine(lineBuilder.build());
 
       // Add straight line at one
@@ -619,18 +817,19 @@ namespace epoch_folio::returns {
     }
   }
 
-  void TearSheetFactory::MakeUnderwaterCharts(std::vector<Chart> &lines) const {
+  void TearSheetFactory::MakeUnderwaterCharts(std::vector<Chart> &lines,
+                                              Series const &underwaterData,
+                                              DrawDownTable const &drawDownTable,
+                                              size_t maxPoints) const {
     try {
-      auto underwaterData =
-          Scalar{100} * GetUnderwaterFromCumReturns(m_strategyCumReturns);
-
       epoch_tearsheet::AreaChartBuilder builder;
       builder.setId("underwater")
           .setTitle("Underwater plot")
           .setCategory(epoch_folio::categories::RiskAnalysis);
 
       epoch_tearsheet::LineBuilder lineBuilder;
-      lineBuilder.setName("Underwater").fromSeries(underwaterData);
+      lineBuilder.setName("Underwater").fromSeries(Downsample(
+          underwaterData, maxPoints, DrawDownBandEdges(drawDownTable)));
       builder.addArea(lineBuilder.build());
 
       lines.push_back(builder.build());
@@ -644,50 +843,99 @@ namespace epoch_folio::returns {
     }
   }
 
-  void
-  TearSheetFactory::MakeRiskAnalysis(int64_t topKDrawDowns, epoch_tearsheet::DashboardBuilder &output) const {
-    try {
-      DrawDownTable drawDownTable;
-      auto table = MakeWorstDrawdownTable(topKDrawDowns, drawDownTable);
-
-      std::vector<epoch_proto::Chart> lines;
-
-      try {
-        MakeRollingVolatilityCharts(lines);
-      } catch (const std::exception &e) {
-        SPDLOG_ERROR("Failed in MakeRollingVolatilityCharts: {}", e.what());
-        throw;
-      }
-
-      try {
-        MakeRollingSharpeCharts(lines);
-      } catch (const std::exception &e) {
-        SPDLOG_ERROR("Failed in MakeRollingSharpeCharts: {}", e.what());
-        throw;
-      }
-
-      try {
-        MakeRollingMaxDrawdownCharts(lines, drawDownTable, topKDrawDowns);
-      } catch (const std::exception &e) {
-        SPDLOG_ERROR("Failed in MakeRollingMaxDrawdownCharts: {}", e.what());
-        throw;
-      }
+  void TearSheetFactory::ScheduleRiskAnalysis(WidgetGraph &graph,
+                                              int64_t topKDrawDowns,
+                                              size_t maxPoints) const {
+    using epoch_folio::categories::RiskAnalysis;
 
-      try {
-        MakeUnderwaterCharts(lines);
-      } catch (const std::exception &e) {
-        SPDLOG_ERROR("Failed in MakeUnderwaterCharts: {}", e.what());
-        throw;
-      }
+    auto drawDowns = MakeIntermediate<DrawDownTable>();
+    auto drawDownNode = graph.Add(
+        {"drawDownTable", "", {}, kInputs},
+        [this, drawDowns, topKDrawDowns](WidgetList &) {
+          try {
+            *drawDowns = GenerateDrawDownTable(m_strategy, topKDrawDowns);
+          } catch (std::exception const &e) {
+            SPDLOG_ERROR("Failed to generate drawdown table: {}", e.what());
+            *drawDowns = DrawDownTable{};
+          }
+        });
+    graph.Releases(drawDownNode, drawDowns);
+    graph.Persists<DrawDownTable>(
+        drawDownNode, drawDowns, std::format("drawDownTable|{}", topKDrawDowns),
+        DrawDownTableToFrame, DrawDownTableFromFrame);
+
+    auto rollingVol = MakeIntermediate<DataFrame>();
+    auto rollingVolNode =
+        graph.Add({"rollingVolFrame", "", {}, kInputs},
+                  [this, rollingVol](WidgetList &) {
+                    *rollingVol = RollingVolatilityFrame();
+                  });
+    graph.Releases(rollingVolNode, rollingVol);
+    graph.Persists(rollingVolNode, rollingVol,
+                   std::format("rollingVolatility|{}", kRollingWindow));
+
+    auto rollingSharpe = MakeIntermediate<DataFrame>();
+    auto rollingSharpeNode =
+        graph.Add({"rollingSharpeFrame", "", {}, kInputs},
+                  [this, rollingSharpe](WidgetList &) {
+                    *rollingSharpe = RollingSharpeFrame();
+                  });
+    graph.Releases(rollingSharpeNode, rollingSharpe);
+    graph.Persists(rollingSharpeNode, rollingSharpe,
+                   std::format("rollingSharpe|{}", kRollingWindow));
+
+    graph.Add({"rollingVol", RiskAnalysis, {rollingVolNode}, kInputs},
+              [this, &graph, rollingVol, maxPoints](WidgetList &out) {
+                graph.Publish(
+                    {"rollingVol", RiskAnalysis, rollingVol->value()});
+                std::vector<Chart> lines;
+                MakeRollingVolatilityCharts(lines, rollingVol->value(),
+                                            maxPoints);
+                AppendWidgets(out, std::move(lines));
+              });
+
+    graph.Add({"rollingSharpe", RiskAnalysis, {rollingSharpeNode}, kInputs},
+              [this, &graph, rollingSharpe, maxPoints](WidgetList &out) {
+                graph.Publish(
+                    {"rollingSharpe", RiskAnalysis, rollingSharpe->value()});
+                std::vector<Chart> lines;
+                MakeRollingSharpeCharts(lines, rollingSharpe->value(),
+                                        maxPoints);
+                AppendWidgets(out, std::move(lines));
+              });
+
+    graph.Add({"drawdowns", RiskAnalysis, {drawDownNode}, kInputs},
+              [this, drawDowns, topKDrawDowns, maxPoints](WidgetList &out) {
+                std::vector<Chart> lines;
+                MakeRollingMaxDrawdownCharts(lines, drawDowns->value(),
+                                             topKDrawDowns, maxPoints);
+                AppendWidgets(out, std::move(lines));
+              });
+
+    graph.Add({"underwater", RiskAnalysis, {drawDownNode}, kInputs},
+              [this, &graph, drawDowns, maxPoints](WidgetList &out) {
+                const auto underwater =
+                    Scalar{100} *
+                    GetUnderwaterFromCumReturns(m_strategyCumReturns);
+                graph.Publish({"underwater", RiskAnalysis,
+                               underwater.to_frame("Underwater")});
+                std::vector<Chart> lines;
+                MakeUnderwaterCharts(lines, underwater, drawDowns->value(),
+                                     maxPoints);
+                AppendWidgets(out, std::move(lines));
+              });
+
+    graph.Add({"worstDrawdowns", RiskAnalysis, {drawDownNode}, kInputs},
+              [this, drawDowns](WidgetList &out) {
+                out.emplace_back(MakeWorstDrawdownTable(drawDowns->value()));
+              });
+  }
 
-      for (auto &chart : lines) {
-        output.addChart(std::move(chart));
-      }
-      output.addTable(std::move(table));
-    } catch (const std::exception &e) {
-      SPDLOG_ERROR("MakeRiskAnalysis failed: {}", e.what());
-      throw;
-    }
+  void
+  TearSheetFactory::MakeRiskAnalysis(int64_t topKDrawDowns, epoch_tearsheet::DashboardBuilder &output) const {
+    RunSerial(output, [&](WidgetGraph &graph) {
+      ScheduleRiskAnalysis(graph, topKDrawDowns);
+    });
   }
 
   std::unordered_map<std::string, std::string> month_to_string{
@@ -945,52 +1193,46 @@ namespace epoch_folio::returns {
     }
   }
 
-  void TearSheetFactory::MakeReturnsDistribution(epoch_tearsheet::DashboardBuilder &output) const {
-    try {
-      output.addChart(BuildMonthlyReturnsHeatMap());
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create monthly returns heatmap: {}", e.what());
-    }
-
-    try {
-      output.addChart(BuildAnnualReturnsBar());
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create annual returns bar chart: {}", e.what());
-    }
+  void TearSheetFactory::ScheduleReturnsDistribution(WidgetGraph &graph) const {
+    using epoch_folio::categories::ReturnsDistribution;
+
+    graph.Add({"monthlyReturns", ReturnsDistribution, {}, kInputs},
+              [this](WidgetList &out) {
+                out.emplace_back(BuildMonthlyReturnsHeatMap());
+              });
+    graph.Add({"annualReturns", ReturnsDistribution, {}, kInputs},
+              [this](WidgetList &out) {
+                out.emplace_back(BuildAnnualReturnsBar());
+              });
+    graph.Add({"monthlyReturnsHistogram", ReturnsDistribution, {}, kInputs},
+              [this](WidgetList &out) {
+                out.emplace_back(BuildMonthlyReturnsHistogram());
+              });
+    graph.Add({"returnQuantiles", ReturnsDistribution, {}, kInputs},
+              [this](WidgetList &out) {
+                out.emplace_back(BuildReturnQuantiles());
+              });
+  }
 
-    try {
-      output.addChart(BuildMonthlyReturnsHistogram());
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create monthly returns histogram: {}", e.what());
-    }
+  void TearSheetFactory::MakeReturnsDistribution(epoch_tearsheet::DashboardBuilder &output) const {
+    RunSerial(output,
+              [&](WidgetGraph &graph) { ScheduleReturnsDistribution(graph); });
+  }
 
-    try {
-      output.addChart(BuildReturnQuantiles());
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create return quantiles chart: {}", e.what());
-    }
+  void TearSheetFactory::Schedule(WidgetGraph &graph,
+                                  TurnoverDenominator turnoverDenominator,
+                                  int64_t topKDrawDowns,
+                                  size_t maxPoints) const {
+    ScheduleStrategyBenchmark(graph, turnoverDenominator, maxPoints);
+    ScheduleRiskAnalysis(graph, topKDrawDowns, maxPoints);
+    ScheduleReturnsDistribution(graph);
   }
 
   void TearSheetFactory::Make(TurnoverDenominator turnoverDenominator,
                               int64_t topKDrawDowns,
                               epoch_tearsheet::DashboardBuilder &output) const {
-    try {
-      MakeStrategyBenchmark(turnoverDenominator, output);
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create strategy benchmark tearsheet: {}", e.what());
-    }
-
-    try {
-      MakeRiskAnalysis(topKDrawDowns, output);
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create risk analysis tearsheet: {}", e.what());
-    }
-
-    try {
-      MakeReturnsDistribution(output);
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create returns distribution tearsheet: {}",
-                   e.what());
-    }
+    RunSerial(output, [&](WidgetGraph &graph) {
+      Schedule(graph, turnoverDenominator, topKDrawDowns);
+    });
   }
 } // namespace epoch_folio::returns
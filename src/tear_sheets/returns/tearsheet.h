@@ -4,23 +4,74 @@
 
 #pragma once
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include "epoch_dashboard/tearsheet/dashboard_builders.h"
 #include "epoch_frame/dataframe.h"
+#include "portfolio/align.h"
 #include "portfolio/model.h"
+#include "tear_sheets/widget_graph.h"
 #include <epoch_protos/tearsheet.pb.h>
 
 namespace epoch_folio::returns {
+  // window of the rolling Sharpe and volatility charts, six months of bars
+  constexpr int64_t kRollingWindow = 6 * 21;
+
+  // Benchmark series derived once and shared by every strategy of a batch.
+  // Make derives them from the benchmark on its own index, they are used for
+  // strategies indexed exactly like it. MakeAligned derives them from the
+  // benchmark aligned with one strategy, they are used for every strategy
+  // sharing that strategy's index. Other strategies align `source` and derive
+  // their own.
+  struct BenchmarkArtifacts {
+    // the benchmark as given, before any fill or alignment
+    epoch_frame::Series source;
+    epoch_frame::Series returns;
+    epoch_frame::Series cumReturns;
+    InterestingDateRangeReturns interesting;
+    int64_t rollingWindow{};
+    epoch_frame::Series rollingSharpe;
+    epoch_frame::Series rollingVolatility;
+    // set by MakeAligned, `returns` is then on the aligned index
+    std::optional<ReturnsAlignment> alignment;
+
+    static std::shared_ptr<const BenchmarkArtifacts>
+    Make(epoch_frame::Series const &benchmark,
+         int64_t rollingWindow = kRollingWindow);
+
+    static std::shared_ptr<const BenchmarkArtifacts>
+    MakeAligned(epoch_frame::Series const &benchmark,
+                epoch_frame::Series const &strategy, epoch_core::AlignFill fill,
+                int64_t rollingWindow = kRollingWindow);
+  };
+  using SharedBenchmark = std::shared_ptr<const BenchmarkArtifacts>;
+
   class TearSheetFactory {
   public:
     TearSheetFactory(epoch_frame::DataFrame positions,
                      epoch_frame::DataFrame transactions,
                      epoch_frame::Series cash, epoch_frame::Series strategy,
-                     std::optional<epoch_frame::Series> benchmark);
+                     std::optional<epoch_frame::Series> benchmark,
+                     std::vector<NamedBenchmark> extraBenchmarks = {},
+                     epoch_core::AlignFill fill =
+                         epoch_core::AlignFill::ForwardFill);
+
+    TearSheetFactory(epoch_frame::DataFrame positions,
+                     epoch_frame::DataFrame transactions,
+                     epoch_frame::Series cash, epoch_frame::Series strategy,
+                     SharedBenchmark benchmark,
+                     std::vector<NamedBenchmark> extraBenchmarks = {},
+                     epoch_core::AlignFill fill =
+                         epoch_core::AlignFill::ForwardFill);
 
     void Make(epoch_core::TurnoverDenominator turnoverDenominator,
               int64_t topKDrawDowns, epoch_tearsheet::DashboardBuilder &output) const;
 
+    // maxPoints caps the points of each line chart, 0 keeps all of them
+    void Schedule(WidgetGraph &graph,
+                  epoch_core::TurnoverDenominator turnoverDenominator,
+                  int64_t topKDrawDowns, size_t maxPoints = 0) const;
+
     epoch_frame::DataFrame GetStrategyAndBenchmark() const;
 
   protected:
@@ -40,16 +91,13 @@ namespace epoch_folio::returns {
       m_transactions = std::move(transactions);
     }
 
-    std::vector<epoch_proto::Chart> MakeStrategyBenchmarkLineCharts() const;
-
     epoch_proto::CardDef
     MakePerformanceStats(epoch_core::TurnoverDenominator turnoverDenominator =
                              epoch_core::TurnoverDenominator::AGB) const;
 
     epoch_proto::Table MakeStressEventTable() const;
 
-    epoch_proto::Table MakeWorstDrawdownTable(int64_t top,
-                                              DrawDownTable &data) const;
+    epoch_proto::Table MakeWorstDrawdownTable(DrawDownTable const &data) const;
 
     void MakeStrategyBenchmark(
         epoch_core::TurnoverDenominator turnoverDenominator, epoch_tearsheet::DashboardBuilder &output) const;
@@ -58,6 +106,16 @@ namespace epoch_folio::returns {
 
     void MakeReturnsDistribution(epoch_tearsheet::DashboardBuilder &output) const;
 
+    void ScheduleStrategyBenchmark(
+        WidgetGraph &graph,
+        epoch_core::TurnoverDenominator turnoverDenominator,
+        size_t maxPoints = 0) const;
+
+    void ScheduleRiskAnalysis(WidgetGraph &graph, int64_t topKDrawDowns,
+                              size_t maxPoints = 0) const;
+
+    void ScheduleReturnsDistribution(WidgetGraph &graph) const;
+
   private:
     epoch_frame::Series m_cash;
     epoch_frame::DataFrame m_positions;
@@ -65,6 +123,16 @@ namespace epoch_folio::returns {
 
     epoch_frame::Series m_strategy;
     std::optional<epoch_frame::Series> m_benchmark;
+    // set when m_benchmark is the shared benchmark's returns
+    SharedBenchmark m_sharedBenchmark;
+
+    struct AlignedBenchmark {
+      std::string name;
+      epoch_frame::Series returns;
+      epoch_frame::Series cumReturns;
+    };
+    // benchmarks compared next to m_benchmark, on the strategy's index
+    std::vector<AlignedBenchmark> m_extraBenchmarks;
 
     epoch_frame::Series m_strategyCumReturns;
     epoch_frame::Series m_benchmarkCumReturns;
@@ -72,20 +140,52 @@ namespace epoch_folio::returns {
     InterestingDateRangeReturns m_strategyReturnsInteresting;
     InterestingDateRangeReturns m_benchmarkReturnsInteresting;
 
-    void AlignReturnsAndBenchmark(epoch_frame::Series const &returns,
-                                  std::optional<epoch_frame::Series> const &benchmark);
-
-    std::vector<epoch_proto::Chart>
-    MakeReturnsLineCharts(const epoch_frame::DataFrame &df) const;
-
-    void MakeRollingBetaCharts(std::vector<epoch_proto::Chart> &lines) const;
-    void MakeRollingSharpeCharts(std::vector<epoch_proto::Chart> &lines) const;
-    void
-    MakeRollingVolatilityCharts(std::vector<epoch_proto::Chart> &lines) const;
+    void AlignReturnsAndBenchmark(
+        epoch_frame::Series const &returns,
+        std::optional<epoch_frame::Series> const &benchmark,
+        std::vector<NamedBenchmark> const &extraBenchmarks,
+        epoch_core::AlignFill fill);
+
+    void ComputeCumulativeReturns();
+
+    // the shared rolling series were derived with this factory's window
+    bool SharesRollingWindow() const;
+
+    // 6 and 12 month betas against every benchmark
+    epoch_frame::DataFrame RollingBetas() const;
+
+    // the strategy's rolling stat, and the benchmark's when there is one
+    epoch_frame::DataFrame RollingSharpeFrame() const;
+    epoch_frame::DataFrame RollingVolatilityFrame() const;
+
+    // the line charts below keep at most about maxPoints points per chart,
+    // 0 keeps every point
+    epoch_proto::Chart MakeCumReturnsChart(const epoch_frame::DataFrame &df,
+                                           std::string const &id,
+                                           std::string const &title,
+                                           size_t maxPoints = 0) const;
+    epoch_proto::Chart
+    MakeVolMatchedCumReturnsChart(const epoch_frame::DataFrame &df,
+                                  size_t maxPoints = 0) const;
+    epoch_proto::Chart MakeReturnsChart(size_t maxPoints = 0) const;
+
+    void MakeRollingBetaCharts(std::vector<epoch_proto::Chart> &lines,
+                               epoch_frame::DataFrame const &rollingBeta,
+                               size_t maxPoints = 0) const;
+    void MakeRollingSharpeCharts(std::vector<epoch_proto::Chart> &lines,
+                                 epoch_frame::DataFrame const &rolling,
+                                 size_t maxPoints = 0) const;
+    void MakeRollingVolatilityCharts(std::vector<epoch_proto::Chart> &lines,
+                                     epoch_frame::DataFrame const &rolling,
+                                     size_t maxPoints = 0) const;
     void MakeRollingMaxDrawdownCharts(std::vector<epoch_proto::Chart> &lines,
-                                      DrawDownTable &drawDownTable,
-                                      int64_t topKDrawDowns) const;
-    void MakeUnderwaterCharts(std::vector<epoch_proto::Chart> &lines) const;
+                                      DrawDownTable const &drawDownTable,
+                                      int64_t topKDrawDowns,
+                                      size_t maxPoints = 0) const;
+    void MakeUnderwaterCharts(std::vector<epoch_proto::Chart> &lines,
+                              epoch_frame::Series const &underwaterData,
+                              DrawDownTable const &drawDownTable,
+                              size_t maxPoints = 0) const;
     void MakeInterestingDateRangeLineCharts(
         std::vector<epoch_proto::Chart> &lines) const;
 
@@ -4,11 +4,14 @@
 
 #include "tearsheet.h"
 #include "epoch_folio/tearsheet.h"
-#include <arrow/acero/exec_plan.h>
-#include <arrow/acero/options.h>
 #include <epoch_core/common_utils.h>
+#include <format>
+#include <numeric>
 #include <oneapi/tbb/parallel_for.h>
 
+#include "common/asof_join.h"
+#include "common/series_helper.h"
+#include "common/type_helper.h"
 #include "portfolio/round_trip.h"
 #include <boost/math/distributions/beta.hpp>
 #include <epoch_frame/factory/index_factory.h>
@@ -18,7 +21,6 @@
 using namespace epoch_core;
 using namespace epoch_frame;
 using namespace epoch_folio;
-namespace ac = arrow::acero;
 
 namespace epoch_folio::round_trip {
 std::vector<double> linspace(double start, double end, int64_t num,
@@ -218,65 +220,127 @@ epoch_proto::Chart TearSheetFactory::MakeReturnsPerRoundTripDollarsChart(
       .build();
 }
 
-void TearSheetFactory::Make(epoch_tearsheet::DashboardBuilder &output) const {
-  try {
-    auto trades = ExtractRoundTrips();
-    if (trades.num_rows() == 0) {
-      SPDLOG_WARN("No trades found, skipping round trip tear sheet");
-      return;
-    }
-
-    try {
-      for (auto const &table : GetRoundTripStats(trades)) {
-        output.addTable(table);
-      }
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to get round trip stats: {}", e.what());
-    }
-
-    try {
-      output.addChart(MakeProfitabilityPieChart(trades));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create profitability pie chart: {}", e.what());
-    }
-
-    try {
-      output.addChart(MakeXRangeDef(trades));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create x-range chart: {}", e.what());
-    }
-
-    try {
-      output.addChart(MakeProbProfitChart(trades));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create probability profit chart: {}", e.what());
-    }
+void TearSheetFactory::Schedule(
+    WidgetGraph &graph, size_t topKSymbols,
+    std::optional<std::chrono::nanoseconds> valueTolerance) const {
+  using epoch_folio::categories::RoundTripAnalysis;
+  using epoch_folio::categories::RoundTripPerformance;
+  // the portfolio value joined onto each trip reads positions and returns
+  constexpr auto kInputs = widget_inputs::RoundTrips | widget_inputs::Returns |
+                           widget_inputs::Positions;
+
+  // every widget is skipped when there are no trades
+  auto trades = MakeIntermediate<DataFrame>();
+  auto tradesNode = graph.Add(
+      {"roundTrips", "", {}, kInputs},
+      [this, trades, valueTolerance](WidgetList &) {
+        auto extracted = ExtractRoundTrips(valueTolerance);
+        if (extracted.num_rows() == 0) {
+          SPDLOG_WARN("No trades found, skipping round trip tear sheet");
+          return;
+        }
+        *trades = std::move(extracted);
+      });
+  graph.Releases(tradesNode, trades);
+  graph.Persists(
+      tradesNode, trades,
+      std::format("roundTrips|{}",
+                  valueTolerance
+                      .transform([](auto tolerance) { return tolerance.count(); })
+                      .value_or(-1)));
+
+  auto addChart = [&](std::string id, std::string category,
+                      epoch_proto::Chart (TearSheetFactory::*make)(
+                          DataFrame const &) const) {
+    graph.Add({std::move(id), std::move(category), {tradesNode}, kInputs},
+              [this, trades, make](WidgetList &out) {
+                if (trades->has_value()) {
+                  out.emplace_back((this->*make)(trades->value()));
+                }
+              });
+  };
+
+  graph.Add({"roundTripStats", RoundTripPerformance, {tradesNode}, kInputs},
+            [trades, topKSymbols](WidgetList &out) {
+              if (trades->has_value()) {
+                AppendWidgets(out,
+                              GetRoundTripStats(trades->value(), topKSymbols));
+              }
+            });
+
+  addChart("profitability_pie", RoundTripPerformance,
+           &TearSheetFactory::MakeProfitabilityPieChart);
+  // one bar per trip, the exported table is the trips themselves
+  graph.Add({"xrange", RoundTripAnalysis, {tradesNode}, kInputs},
+            [this, &graph, trades](WidgetList &out) {
+              if (trades->has_value()) {
+                graph.Publish({"xrange", RoundTripAnalysis, trades->value()});
+                out.emplace_back(MakeXRangeDef(trades->value()));
+              }
+            });
+  addChart("prob_profit_trade", RoundTripPerformance,
+           &TearSheetFactory::MakeProbProfitChart);
+  addChart("holding_time", RoundTripAnalysis,
+           &TearSheetFactory::MakeHoldingTimeChart);
+  addChart("pnl_per_round_trip", RoundTripAnalysis,
+           &TearSheetFactory::MakePnlPerRoundTripDollarsChart);
+  addChart("returns_per_round_trip", RoundTripAnalysis,
+           &TearSheetFactory::MakeReturnsPerRoundTripDollarsChart);
+}
 
-    try {
-      output.addChart(MakeHoldingTimeChart(trades));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create holding time chart: {}", e.what());
-    }
+void TearSheetFactory::Make(
+    size_t topKSymbols, epoch_tearsheet::DashboardBuilder &output,
+    std::optional<std::chrono::nanoseconds> valueTolerance) const {
+  RunSerial(output, [&](WidgetGraph &graph) {
+    Schedule(graph, topKSymbols, valueTolerance);
+  });
+}
 
-    try {
-      output.addChart(MakePnlPerRoundTripDollarsChart(trades));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create PnL per round trip chart: {}", e.what());
-    }
+namespace {
+// positions that visit `values` in ascending order
+std::vector<int64_t> AscendingOrder(std::vector<int64_t> const &values) {
+  std::vector<int64_t> order(values.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (!std::ranges::is_sorted(values)) {
+    std::ranges::stable_sort(order, {}, [&](int64_t i) { return values[i]; });
+  }
+  return order;
+}
 
-    try {
-      output.addChart(MakeReturnsPerRoundTripDollarsChart(trades));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create returns per round trip chart: {}",
-                   e.what());
-    }
+std::vector<int64_t> Gather(std::vector<int64_t> const &values,
+                            std::vector<int64_t> const &order) {
+  std::vector<int64_t> out(order.size());
+  std::ranges::transform(order, out.begin(),
+                         [&](int64_t i) { return values[i]; });
+  return out;
+}
 
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create round trip tearsheet: {}", e.what());
+// `tolerance` in the unit of a timestamp column of `type`
+std::optional<int64_t>
+InTimestampUnit(std::optional<std::chrono::nanoseconds> tolerance,
+                arrow::DataTypePtr const &type) {
+  if (!tolerance || type->id() != arrow::Type::TIMESTAMP) {
+    return tolerance.transform([](auto value) { return value.count(); });
+  }
+  switch (static_cast<arrow::TimestampType const &>(*type).unit()) {
+  case arrow::TimeUnit::SECOND:
+    return std::chrono::duration_cast<std::chrono::seconds>(*tolerance)
+        .count();
+  case arrow::TimeUnit::MILLI:
+    return std::chrono::duration_cast<std::chrono::milliseconds>(*tolerance)
+        .count();
+  case arrow::TimeUnit::MICRO:
+    return std::chrono::duration_cast<std::chrono::microseconds>(*tolerance)
+        .count();
+  case arrow::TimeUnit::NANO:
+  default:
+    return tolerance->count();
   }
 }
+} // namespace
 
-DataFrame TearSheetFactory::ExtractRoundTrips() const {
+DataFrame TearSheetFactory::ExtractRoundTrips(
+    std::optional<std::chrono::nanoseconds> valueTolerance) const {
 
   Series open_dt = m_round_trip["open_datetime"];
   auto close_dt = m_round_trip["close_datetime"];
@@ -287,16 +351,53 @@ DataFrame TearSheetFactory::ExtractRoundTrips() const {
 
   auto portfolio_value =
       m_positions.sum(AxisType::Column) / (1.0_scalar + m_returns);
-  auto pv_date = portfolio_value.index()->as_chunked_array();
-  auto pv_table = arrow::Table::Make(
-      arrow::schema({
-          arrow::field("portfolio_value", portfolio_value.array()->type()),
-          arrow::field("date", pv_date->type()),
-      }),
-      {portfolio_value.array(), pv_date});
 
-  auto rt_date = close_dt.dt().normalize().as_chunked_array();
-  auto round_trip_table = arrow::Table::Make(
+  // every round trip takes the last portfolio value at or before its close,
+  // so intraday books keep all their values instead of one per day
+  auto pv_index = portfolio_value.index();
+  auto close_array = close_dt.array();
+  if (!close_array->type()->Equals(*pv_index->dtype())) {
+    close_array = AssertResultIsOk(
+                      arrow::compute::Cast(close_array, pv_index->dtype()))
+                      .chunked_array();
+  }
+  const auto pv_times = ToTimestampVector(pv_index);
+  const auto close_times = ToTimestampVector(close_array);
+  const auto pv_values = ToDoubleVector(portfolio_value);
+  const auto pnl_values = ToDoubleVector(pnl);
+
+  const auto pv_order = AscendingOrder(pv_times);
+  const auto close_order = AscendingOrder(close_times);
+  const auto matches = AsOfJoinBackward(
+      Gather(close_times, close_order), Gather(pv_times, pv_order),
+      InTimestampUnit(valueTolerance, pv_index->dtype()));
+
+  std::vector<double> trip_pv(close_times.size(),
+                              std::numeric_limits<double>::quiet_NaN());
+  for (size_t k = 0; k < matches.size(); ++k) {
+    if (matches[k] != kNoMatch) {
+      trip_pv[close_order[k]] = pv_values[pv_order[matches[k]]];
+    }
+  }
+
+  arrow::DoubleBuilder pv_builder, returns_builder;
+  ThrowIfNotOk(pv_builder.Reserve(static_cast<int64_t>(trip_pv.size())));
+  ThrowIfNotOk(returns_builder.Reserve(static_cast<int64_t>(trip_pv.size())));
+  for (size_t i = 0; i < trip_pv.size(); ++i) {
+    if (std::isnan(trip_pv[i])) {
+      pv_builder.UnsafeAppendNull();
+      returns_builder.UnsafeAppendNull();
+      continue;
+    }
+    pv_builder.UnsafeAppend(trip_pv[i]);
+    returns_builder.UnsafeAppend(pnl_values[i] / trip_pv[i]);
+  }
+  auto finish = [](arrow::DoubleBuilder &builder) {
+    return std::make_shared<arrow::ChunkedArray>(
+        builder.Finish().ValueOrDie());
+  };
+
+  return make_dataframe(arrow::Table::Make(
       arrow::schema({
           arrow::field("open_dt", open_dt.array()->type()),
           arrow::field("close_dt", close_dt.array()->type()),
@@ -304,35 +405,12 @@ DataFrame TearSheetFactory::ExtractRoundTrips() const {
           arrow::field("symbol", symbol.array()->type()),
           arrow::field("duration", duration->type()),
           arrow::field("pnl", pnl.array()->type()),
-          arrow::field("date", rt_date->type()),
+          float64_field("portfolio_value"),
+          float64_field("returns"),
       }),
       {open_dt.array(), close_dt.array(), is_long.array(), symbol.array(),
        std::make_shared<arrow::ChunkedArray>(duration.value()), pnl.array(),
-       rt_date});
-
-  ac::Declaration left{"table_source",
-                       ac::TableSourceNodeOptions(round_trip_table)};
-  ac::Declaration right{"table_source", ac::TableSourceNodeOptions(pv_table)};
-
-  ac::HashJoinNodeOptions join_opts{
-      ac::JoinType::LEFT_OUTER,
-      /*left_keys=*/{"date"},
-      /*right_keys=*/{"date"},
-      /*null_handling=*/arrow::compute::literal(true),
-      /*left_suffix=*/"_",
-      /*right_suffix=*/""};
-
-  ac::Declaration join{"hashjoin", {left, right}, join_opts};
-  auto tmp = AssertTableResultIsOk(ac::DeclarationToTable(join));
-
-  auto returns = AssertArrayResultIsOk(arrow::compute::Divide(
-      tmp->GetColumnByName("pnl"), tmp->GetColumnByName("portfolio_value")));
-  tmp = AssertTableResultIsOk(tmp->AddColumn(
-      tmp->num_columns(), arrow::field("returns", returns->type()), returns));
-  tmp = AssertTableResultIsOk(
-      tmp->RemoveColumn(tmp->schema()->GetFieldIndex("date")));
-
-  return make_dataframe(tmp);
+       finish(pv_builder), finish(returns_builder)}));
 }
 
 epoch_proto::Chart TearSheetFactory::MakeProfitabilityPieChart(
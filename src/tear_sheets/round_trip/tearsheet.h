@@ -7,6 +7,7 @@
 #include "epoch_dashboard/tearsheet/numeric_line_builder.h"
 #include "epoch_frame/dataframe.h"
 #include "portfolio/model.h"
+#include "tear_sheets/widget_graph.h"
 #include <epoch_protos/tearsheet.pb.h>
 
 namespace epoch_folio::round_trip {
@@ -17,7 +18,13 @@ public:
                    epoch_frame::DataFrame positions,
                    SectorMapping sector_mapping);
 
-  void Make(epoch_tearsheet::DashboardBuilder &output) const;
+  void Make(size_t topKSymbols, epoch_tearsheet::DashboardBuilder &output,
+            std::optional<std::chrono::nanoseconds> valueTolerance = {}) const;
+
+  // `valueTolerance`: see TearSheetOption::roundTripValueTolerance
+  void Schedule(WidgetGraph &graph, size_t topKSymbols,
+                std::optional<std::chrono::nanoseconds> valueTolerance =
+                    {}) const;
 
 private:
   epoch_frame::DataFrame m_round_trip;
@@ -25,7 +32,8 @@ private:
   epoch_frame::DataFrame m_positions;
   SectorMapping m_sector_mapping;
 
-  epoch_frame::DataFrame ExtractRoundTrips() const;
+  epoch_frame::DataFrame ExtractRoundTrips(
+      std::optional<std::chrono::nanoseconds> valueTolerance = {}) const;
 
   epoch_proto::Chart MakeXRangeDef(epoch_frame::DataFrame const &trades) const;
 
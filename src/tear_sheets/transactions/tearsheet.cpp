@@ -190,39 +190,47 @@ epoch_proto::Chart TearSheetFactory::MakeTransactionTimeHistogram(
   }
 }
 
+void TearSheetFactory::Schedule(
+    WidgetGraph &graph, epoch_core::TurnoverDenominator turnoverDenominator,
+    size_t binSize, std::string const &timezone) const {
+  using epoch_folio::categories::Transactions;
+  constexpr auto kInputs = widget_inputs::Transactions;
+
+  auto turnover = MakeIntermediate<epoch_frame::Series>();
+  auto turnoverNode = graph.Add(
+      {"turnover", "", {}, kInputs | widget_inputs::Positions},
+      [this, turnover, turnoverDenominator](WidgetList &) {
+        *turnover =
+            GetTurnover(m_positions, m_transactions, turnoverDenominator);
+      });
+  graph.Releases(turnoverNode, turnover);
+
+  graph.Add({"turnoverOverTime", Transactions, {turnoverNode}, kInputs},
+            [this, turnover](WidgetList &out) {
+              out.emplace_back(MakeTurnoverOverTimeChart(turnover->value()));
+            });
+
+  graph.Add({"dailyVolume", Transactions, {}, kInputs},
+            [this](WidgetList &out) {
+              out.emplace_back(MakeDailyVolumeChart());
+            });
+
+  graph.Add({"dailyTurnoverHistogram", Transactions, {turnoverNode}, kInputs},
+            [this, turnover](WidgetList &out) {
+              out.emplace_back(MakeDailyTurnoverHistogram(turnover->value()));
+            });
+
+  graph.Add({"transactionTimeHistogram", Transactions, {}, kInputs},
+            [this, binSize, timezone](WidgetList &out) {
+              out.emplace_back(MakeTransactionTimeHistogram(binSize, timezone));
+            });
+}
+
 void TearSheetFactory::Make(epoch_core::TurnoverDenominator turnoverDenominator,
                             size_t binSize, std::string const &timezone,
                             epoch_tearsheet::DashboardBuilder &output) const {
-  try {
-    auto df_turnover =
-        GetTurnover(m_positions, m_transactions, turnoverDenominator);
-
-    try {
-      output.addChart(MakeTurnoverOverTimeChart(df_turnover));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create turnover over time chart: {}", e.what());
-    }
-
-    try {
-      output.addChart(MakeDailyVolumeChart());
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create daily volume chart: {}", e.what());
-    }
-
-    try {
-      output.addChart(MakeDailyTurnoverHistogram(df_turnover));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create daily turnover histogram: {}", e.what());
-    }
-
-    try {
-      output.addChart(MakeTransactionTimeHistogram(binSize, timezone));
-    } catch (std::exception const &e) {
-      SPDLOG_ERROR("Failed to create transaction time histogram: {}", e.what());
-    }
-
-  } catch (std::exception const &e) {
-    SPDLOG_ERROR("Failed to create transactions tearsheet: {}", e.what());
-  }
+  RunSerial(output, [&](WidgetGraph &graph) {
+    Schedule(graph, turnoverDenominator, binSize, timezone);
+  });
 }
 } // namespace epoch_folio::txn
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "epoch_dashboard/tearsheet/dashboard_builders.h"
 #include "epoch_frame/dataframe.h"
 #include "portfolio/model.h"
+#include "tear_sheets/widget_graph.h"
 #include <epoch_protos/tearsheet.pb.h>
 
 namespace epoch_folio::txn {
@@ -20,6 +21,10 @@ public:
             std::string const &timezone,
             epoch_tearsheet::DashboardBuilder &output) const;
 
+  void Schedule(WidgetGraph &graph,
+                epoch_core::TurnoverDenominator turnoverDenominator,
+                size_t binSize, std::string const &timezone) const;
+
 private:
   epoch_frame::Series m_returns;
   epoch_frame::DataFrame m_positions;
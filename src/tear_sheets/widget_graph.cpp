@@ -0,0 +1,413 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "widget_graph.h"
+#include "common/memory_tracker.h"
+#include "common/trace.h"
+#include <algorithm>
+#include <format>
+#include <oneapi/tbb/flow_graph.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace epoch_folio {
+WidgetGraph::NodeId WidgetGraph::Add(NodeSpec spec, Task task) {
+  const auto id = m_nodes.size();
+  for (auto dep : spec.deps) {
+    if (dep >= id) {
+      throw std::runtime_error(std::format(
+          "widget node {} depends on undeclared node {}", spec.id, dep));
+    }
+  }
+  auto inputs = spec.inputs;
+  for (auto dep : spec.deps) {
+    inputs |= m_nodes[dep].inputs;
+  }
+  m_nodes.push_back(
+      Node{.spec = std::move(spec), .task = std::move(task), .inputs = inputs});
+  return id;
+}
+
+void WidgetGraph::Select(WidgetSelection const &selection) {
+  if (selection.empty()) {
+    for (auto &node : m_nodes) {
+      node.active = true;
+    }
+    return;
+  }
+
+  // dependencies are declared before their dependents, so one backward sweep
+  // reaches every intermediate a selected widget needs
+  std::vector<bool> needed(m_nodes.size(), false);
+  for (size_t i = m_nodes.size(); i-- > 0;) {
+    auto const &spec = m_nodes[i].spec;
+    if (!spec.category.empty() && selection.Selects(spec.id, spec.category)) {
+      needed[i] = true;
+    }
+    if (needed[i]) {
+      for (auto dep : spec.deps) {
+        needed[dep] = true;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    m_nodes[i].active = needed[i];
+  }
+}
+
+void WidgetGraph::Reuse(WidgetCache const &cache, uint8_t changedInputs) {
+  for (auto &node : m_nodes) {
+    if (!node.active || node.spec.category.empty() ||
+        (node.inputs & changedInputs) != 0) {
+      continue;
+    }
+    if (auto it = cache.find(node.spec.id); it != cache.end()) {
+      node.widgets = it->second;
+      node.reused = true;
+    }
+  }
+
+  // keep only the intermediates that a node which still runs depends on
+  std::vector<bool> needed(m_nodes.size(), false);
+  for (size_t i = m_nodes.size(); i-- > 0;) {
+    auto const &node = m_nodes[i];
+    const bool runs = node.active && !node.reused &&
+                      (!node.spec.category.empty() || needed[i]);
+    if (runs) {
+      needed[i] = true;
+      for (auto dep : node.spec.deps) {
+        needed[dep] = true;
+      }
+    }
+  }
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    if (m_nodes[i].spec.category.empty()) {
+      m_nodes[i].active = needed[i];
+    }
+  }
+}
+
+void WidgetGraph::Store(WidgetCache &cache, uint8_t changedInputs) const {
+  const auto failed = FailedNodes();
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    auto const &node = m_nodes[i];
+    if (node.spec.category.empty()) {
+      continue;
+    }
+    if (failed[i]) {
+      cache.erase(node.spec.id);
+    } else if (node.active) {
+      cache[node.spec.id] = node.widgets;
+    } else if ((node.inputs & changedInputs) != 0) {
+      cache.erase(node.spec.id);
+    }
+  }
+}
+
+std::vector<std::string> WidgetGraph::PendingWidgets() const {
+  std::vector<std::string> ids;
+  for (auto const &node : m_nodes) {
+    if (node.active && !node.reused && !node.spec.category.empty()) {
+      ids.push_back(node.spec.id);
+    }
+  }
+  return ids;
+}
+
+WidgetList const &WidgetGraph::Widgets(std::string const &id) const {
+  auto it = std::ranges::find_if(
+      m_nodes, [&](Node const &node) { return node.spec.id == id; });
+  if (it == m_nodes.end()) {
+    throw std::runtime_error(std::format("unknown widget node {}", id));
+  }
+  return it->widgets;
+}
+
+bool WidgetGraph::Restore(Node &node) const {
+  if (!m_store || !node.restore) {
+    return false;
+  }
+  try {
+    auto frame = m_store->load(node.storeKey);
+    if (!frame) {
+      return false;
+    }
+    node.restore(*frame);
+    return true;
+  } catch (std::exception const &e) {
+    SPDLOG_WARN("Failed to load stored {}: {}", node.spec.id, e.what());
+    return false;
+  }
+}
+
+void WidgetGraph::Save(Node const &node) const {
+  if (!m_store || !node.persist) {
+    return;
+  }
+  try {
+    if (auto frame = node.persist()) {
+      m_store->save(node.storeKey, *frame);
+    }
+  } catch (std::exception const &e) {
+    SPDLOG_WARN("Failed to store {}: {}", node.spec.id, e.what());
+  }
+}
+
+std::vector<bool> WidgetGraph::FailedNodes() const {
+  // dependencies are declared first, so one forward sweep propagates
+  std::vector<bool> failed(m_nodes.size(), false);
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    auto const &node = m_nodes[i];
+    failed[i] = node.active && !node.reused &&
+                (node.failed || std::ranges::any_of(node.spec.deps,
+                                                    [&](NodeId dep) {
+                                                      return failed[dep];
+                                                    }));
+  }
+  return failed;
+}
+
+bool WidgetGraph::Failed(std::string const &id) const {
+  auto it = std::ranges::find_if(
+      m_nodes, [&](Node const &node) { return node.spec.id == id; });
+  if (it == m_nodes.end()) {
+    throw std::runtime_error(std::format("unknown widget node {}", id));
+  }
+  return FailedNodes()[static_cast<size_t>(it - m_nodes.begin())];
+}
+
+bool WidgetGraph::AnyFailed() const {
+  return std::ranges::any_of(m_nodes, [](Node const &node) {
+    return node.active && node.failed;
+  });
+}
+
+void WidgetGraph::Execute(Node &node, RunControl const &control,
+                          std::mutex &callbackMutex) const {
+  if (node.reused) {
+    return;
+  }
+  node.widgets.clear();
+  node.skipped = false;
+  node.failed = false;
+  if (control.Expired()) {
+    node.skipped = true;
+    return;
+  }
+  {
+    const std::string_view category =
+        node.spec.category.empty() ? "intermediate" : node.spec.category;
+    trace::Span span{node.spec.id, category};
+    MemoryScope memory{node.spec.id, category};
+    if (!Restore(node)) {
+      try {
+        node.task(node.widgets);
+        Save(node);
+      } catch (std::exception const &e) {
+        SPDLOG_ERROR("Failed to build {}: {}", node.spec.id, e.what());
+        node.widgets.clear();
+        node.failed = true;
+      }
+    }
+  }
+
+  Notify(node, control, callbackMutex);
+}
+
+void WidgetGraph::Notify(Node const &node, RunControl const &control,
+                         std::mutex &callbackMutex) {
+  if (!control.onWidget || node.spec.category.empty()) {
+    return;
+  }
+  std::lock_guard lock{callbackMutex};
+  try {
+    control.onWidget(node.spec.id, node.spec.category, node.widgets);
+  } catch (std::exception const &e) {
+    SPDLOG_ERROR("Widget callback failed for {}: {}", node.spec.id, e.what());
+  }
+}
+
+bool WidgetGraph::Stopped() const {
+  return std::ranges::any_of(m_nodes, [](Node const &node) {
+    return node.active && node.skipped;
+  });
+}
+
+void WidgetGraph::Run(bool parallel, RunControl const &control) {
+  std::mutex callbackMutex;
+  for (auto &node : m_nodes) {
+    node.skipped = false;
+    node.failed = false;
+    if (node.active && node.reused) {
+      Notify(node, control, callbackMutex);
+    }
+  }
+
+  if (control.lowMemory) {
+    RunLowMemory(control, callbackMutex);
+    return;
+  }
+
+  if (!parallel) {
+    for (auto &node : m_nodes) {
+      if (node.active) {
+        Execute(node, control, callbackMutex);
+      }
+    }
+    return;
+  }
+
+  using tbb::flow::continue_msg;
+  using tbb::flow::continue_node;
+
+  tbb::flow::graph graph;
+  // only nodes that run get a flow node; inactive and reused dependencies
+  // are already settled and add no edge
+  std::vector<std::unique_ptr<continue_node<continue_msg>>> flowNodes(
+      m_nodes.size());
+  std::vector<size_t> roots;
+  for (size_t i = 0; i < m_nodes.size(); ++i) {
+    if (!m_nodes[i].active || m_nodes[i].reused) {
+      continue;
+    }
+    flowNodes[i] = std::make_unique<continue_node<continue_msg>>(
+        graph, [this, &node = m_nodes[i], &control,
+                &callbackMutex](continue_msg const &) {
+          Execute(node, control, callbackMutex);
+          return continue_msg{};
+        });
+    bool root = true;
+    for (auto dep : m_nodes[i].spec.deps) {
+      if (flowNodes[dep]) {
+        tbb::flow::make_edge(*flowNodes[dep], *flowNodes[i]);
+        root = false;
+      }
+    }
+    if (root) {
+      roots.push_back(i);
+    }
+  }
+
+  for (auto i : roots) {
+    flowNodes[i]->try_put(continue_msg{});
+  }
+  graph.wait_for_all();
+}
+
+void WidgetGraph::RunLowMemory(RunControl const &control,
+                               std::mutex &callbackMutex) {
+  const auto count = m_nodes.size();
+  auto runs = [&](size_t i) {
+    return m_nodes[i].active && !m_nodes[i].reused;
+  };
+
+  std::vector<std::vector<size_t>> consumers(count);
+  std::vector<size_t> remaining(count, 0);
+  for (size_t i = 0; i < count; ++i) {
+    if (!runs(i)) {
+      continue;
+    }
+    for (auto dep : m_nodes[i].spec.deps) {
+      if (runs(dep)) {
+        consumers[dep].push_back(i);
+        ++remaining[dep];
+      }
+    }
+  }
+
+  std::vector<bool> done(count, false);
+  auto ready = [&](size_t i) {
+    return std::ranges::all_of(m_nodes[i].spec.deps, [&](size_t dep) {
+      return !runs(dep) || done[dep];
+    });
+  };
+  auto release = [&](size_t i) {
+    if (remaining[i] == 0 && m_nodes[i].release) {
+      m_nodes[i].release();
+    }
+  };
+
+  // depth first from each widget in declaration order; a finished node
+  // pulls in the consumers it completes, so its output is dropped before
+  // the next intermediate is computed
+  std::function<void(size_t)> visit = [&](size_t i) {
+    if (done[i]) {
+      return;
+    }
+    for (auto dep : m_nodes[i].spec.deps) {
+      if (runs(dep)) {
+        visit(dep);
+      }
+    }
+    if (done[i]) {
+      return;
+    }
+    Execute(m_nodes[i], control, callbackMutex);
+    done[i] = true;
+    for (auto dep : m_nodes[i].spec.deps) {
+      if (runs(dep)) {
+        --remaining[dep];
+        release(dep);
+      }
+    }
+    for (auto consumer : consumers[i]) {
+      if (ready(consumer)) {
+        visit(consumer);
+      }
+    }
+    release(i);
+  };
+
+  for (size_t i = 0; i < count; ++i) {
+    if (runs(i)) {
+      visit(i);
+    }
+  }
+}
+
+void WidgetGraph::Flush(epoch_tearsheet::DashboardBuilder &output) {
+  for (auto &node : m_nodes) {
+    for (auto &widget : node.widgets) {
+      std::visit(
+          [&]<typename T>(T &value) {
+            if constexpr (std::is_same_v<T, epoch_proto::CardDef>) {
+              output.addCard(std::move(value));
+            } else if constexpr (std::is_same_v<T, epoch_proto::Chart>) {
+              output.addChart(std::move(value));
+            } else {
+              output.addTable(std::move(value));
+            }
+          },
+          widget);
+    }
+    node.widgets.clear();
+  }
+}
+
+void WidgetGraph::CollectSeries() {
+  if (!m_series) {
+    m_series = std::make_unique<PublishedSeries>();
+  }
+}
+
+void WidgetGraph::Publish(WidgetSeries series) {
+  if (!m_series) {
+    return;
+  }
+  std::lock_guard lock{m_series->mutex};
+  m_series->series.push_back(std::move(series));
+}
+
+WidgetSeriesList WidgetGraph::TakeSeries() {
+  if (!m_series) {
+    return {};
+  }
+  std::lock_guard lock{m_series->mutex};
+  auto series = std::move(m_series->series);
+  m_series->series.clear();
+  std::ranges::sort(series, {}, &WidgetSeries::id);
+  return series;
+}
+} // namespace epoch_folio
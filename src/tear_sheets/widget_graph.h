@@ -0,0 +1,292 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#pragma once
+#include "epoch_dashboard/tearsheet/dashboard_builders.h"
+#include "portfolio/model.h"
+#include <atomic>
+#include <chrono>
+#include <epoch_protos/tearsheet.pb.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace epoch_folio {
+using Widget =
+    std::variant<epoch_proto::CardDef, epoch_proto::Chart, epoch_proto::Table>;
+using WidgetList = std::vector<Widget>;
+
+// Value produced by one node and read by its dependents. It stays empty when
+// the producer failed or had nothing to produce, dependents check before use.
+template <typename T> using Intermediate = std::shared_ptr<std::optional<T>>;
+
+template <typename T> Intermediate<T> MakeIntermediate() {
+  return std::make_shared<std::optional<T>>();
+}
+
+// Full resolution data behind a chart or table, exported under its widget id
+// so clients can load it as typed arrays instead of parsing chart points.
+struct WidgetSeries {
+  std::string id;
+  std::string category;
+  epoch_frame::DataFrame data;
+};
+using WidgetSeriesList = std::vector<WidgetSeries>;
+
+// Keeps intermediates as frames across builds and processes, see
+// WidgetGraph::Persists. `load` returns nullopt on a miss; both are called
+// from the worker threads.
+struct IntermediateStore {
+  std::function<std::optional<epoch_frame::DataFrame>(std::string const &)>
+      load;
+  std::function<void(std::string const &, epoch_frame::DataFrame const &)>
+      save;
+};
+
+// Widgets of the last build keyed by node id, see WidgetGraph::Reuse.
+using WidgetCache = std::unordered_map<std::string, WidgetList>;
+
+// Factory inputs a node reads. An append only invalidates nodes whose inputs
+// (including those of their dependencies) changed.
+namespace widget_inputs {
+constexpr uint8_t Returns = 1 << 0;
+constexpr uint8_t Benchmark = 1 << 1;
+constexpr uint8_t Positions = 1 << 2; // positions and cash
+constexpr uint8_t Transactions = 1 << 3;
+constexpr uint8_t RoundTrips = 1 << 4;
+constexpr uint8_t All = 0xFF;
+} // namespace widget_inputs
+
+// Stops a build between widgets: nodes that have not started are skipped,
+// running ones finish. Copies share one flag, so the caller keeps a copy.
+class CancellationToken {
+public:
+  void Cancel() const { m_cancelled->store(true, std::memory_order_relaxed); }
+
+  bool IsCancelled() const {
+    return m_cancelled->load(std::memory_order_relaxed);
+  }
+
+private:
+  std::shared_ptr<std::atomic<bool>> m_cancelled =
+      std::make_shared<std::atomic<bool>>(false);
+};
+
+using Deadline = std::chrono::steady_clock::time_point;
+
+// receives the widgets of one node (id, category, widgets) once it is done
+using WidgetCallback = std::function<void(
+    std::string const &, std::string const &, WidgetList const &)>;
+
+struct RunControl {
+  CancellationToken token{};
+  std::optional<Deadline> deadline{};
+  // called from the worker threads, never concurrently; reused nodes are
+  // reported first
+  WidgetCallback onWidget{};
+  // Runs serially in an order that keeps few intermediates alive: each one
+  // is consumed as soon as it is ready and released (see
+  // WidgetGraph::Releases) after its last consumer.
+  bool lowMemory{false};
+
+  bool Expired() const {
+    return token.IsCancelled() ||
+           (deadline && std::chrono::steady_clock::now() >= *deadline);
+  }
+};
+
+// thrown by builds that were cancelled or ran past their deadline
+struct BuildCancelled : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+template <typename T>
+void AppendWidgets(WidgetList &out, std::vector<T> &&widgets) {
+  for (auto &widget : widgets) {
+    out.emplace_back(std::move(widget));
+  }
+}
+
+/*
+Dependency graph of tear sheet widgets. A node fills intermediates, emits
+widgets, or both. Nodes only read the factory inputs and the intermediates of
+their declared dependencies, so independent nodes run concurrently on a TBB
+flow graph. Widgets are flushed in node declaration order, which keeps the
+dashboard identical to a serial run.
+*/
+class WidgetGraph {
+public:
+  using NodeId = size_t;
+  using Task = std::function<void(WidgetList &)>;
+
+  struct NodeSpec {
+    std::string id;
+    // empty for nodes that only produce intermediates
+    std::string category{};
+    std::vector<NodeId> deps{};
+    uint8_t inputs{widget_inputs::All};
+  };
+
+  // dependencies must already be declared, which also rules out cycles
+  NodeId Add(NodeSpec spec, Task task);
+
+  // lets a low memory run drop `value`, produced by node `id`, once every
+  // consumer of the node has run
+  template <typename T> void Releases(NodeId id, Intermediate<T> value) {
+    m_nodes.at(id).release = [value = std::move(value)] { value->reset(); };
+  }
+
+  // Lets node `id` load `value` from the intermediate store under `key`
+  // instead of running, and saves what it computes on a miss. The store is
+  // addressed by the factory inputs, so `key` names the value and only the
+  // options it depends on.
+  template <typename T>
+  void Persists(
+      NodeId id, Intermediate<T> value, std::string key,
+      std::type_identity_t<std::function<epoch_frame::DataFrame(T const &)>>
+          encode,
+      std::type_identity_t<std::function<T(epoch_frame::DataFrame const &)>>
+          decode) {
+    auto &node = m_nodes.at(id);
+    node.storeKey = std::move(key);
+    node.restore = [value, decode = std::move(decode)](
+                       epoch_frame::DataFrame const &frame) {
+      *value = decode(frame);
+    };
+    node.persist = [value, encode = std::move(encode)]() {
+      return value->has_value() ? std::optional{encode(value->value())}
+                                : std::nullopt;
+    };
+  }
+
+  void Persists(NodeId id, Intermediate<epoch_frame::DataFrame> value,
+                std::string key) {
+    Persists(
+        id, std::move(value), std::move(key),
+        [](epoch_frame::DataFrame const &frame) { return frame; },
+        [](epoch_frame::DataFrame const &frame) { return frame; });
+  }
+
+  // where nodes registered with Persists load and save their values; without
+  // one they always run
+  void UseIntermediateStore(IntermediateStore store) {
+    m_store = std::move(store);
+  }
+
+  // deactivates widgets outside `selection` together with every intermediate
+  // that only they consume
+  void Select(WidgetSelection const &selection);
+
+  // Widget nodes that read none of `changedInputs` take their widgets from
+  // `cache` instead of running, intermediates only they consumed are skipped.
+  // Only valid when the nodes were scheduled with the same options as the
+  // cached build and widget nodes produce no intermediates.
+  void Reuse(WidgetCache const &cache, uint8_t changedInputs);
+
+  // Records the widgets of this build into `cache` and drops cached entries of
+  // inactive nodes that `changedInputs` invalidated. Failed nodes (see Failed)
+  // are dropped too, so the next build retries them. Call before Flush.
+  void Store(WidgetCache &cache, uint8_t changedInputs) const;
+
+  // ids of the active widget nodes that are not reused, i.e. would run
+  std::vector<std::string> PendingWidgets() const;
+
+  // widgets of node `id` as of the last run or Reuse, throws for unknown ids
+  WidgetList const &Widgets(std::string const &id) const;
+
+  // true when node `id` threw in the last run, or one of its dependencies
+  // did: its widgets are missing or drawn without the failed input, so they
+  // must not be cached. Throws for unknown ids
+  bool Failed(std::string const &id) const;
+
+  // true when any active node failed in the last run
+  bool AnyFailed() const;
+
+  // Keeps what nodes Publish from now on. Reused nodes do not run and publish
+  // nothing, so a collecting build skips Reuse.
+  void CollectSeries();
+
+  bool CollectsSeries() const { return m_series != nullptr; }
+
+  // Called by a widget node with the full resolution frame it drew its chart
+  // or table from; a no-op unless collecting. Safe from concurrent nodes.
+  void Publish(WidgetSeries series);
+
+  // the published frames ordered by widget id
+  WidgetSeriesList TakeSeries();
+
+  // runs the active nodes that are not reused, checking `control` before
+  // each node
+  void Run(bool parallel, RunControl const &control = {});
+
+  // true when the last Run skipped nodes because `control` expired, their
+  // widgets are missing
+  bool Stopped() const;
+
+  // moves every emitted widget into `output` in declaration order
+  void Flush(epoch_tearsheet::DashboardBuilder &output);
+
+  size_t size() const { return m_nodes.size(); }
+
+  bool IsActive(NodeId id) const { return m_nodes.at(id).active; }
+
+private:
+  struct Node {
+    NodeSpec spec;
+    Task task;
+    WidgetList widgets;
+    uint8_t inputs{widget_inputs::All}; // own inputs plus the dependencies'
+    std::function<void()> release{};
+    // set by Persists
+    std::string storeKey{};
+    std::function<void(epoch_frame::DataFrame const &)> restore{};
+    std::function<std::optional<epoch_frame::DataFrame>()> persist{};
+    bool active{true};
+    bool reused{false};
+    bool skipped{false};
+    // the task threw in the last run
+    bool failed{false};
+  };
+
+  std::vector<Node> m_nodes;
+
+  struct PublishedSeries {
+    std::mutex mutex;
+    WidgetSeriesList series;
+  };
+  std::unique_ptr<PublishedSeries> m_series;
+  std::optional<IntermediateStore> m_store;
+
+  void RunLowMemory(RunControl const &control, std::mutex &callbackMutex);
+
+  // per node, whether it or a dependency failed
+  std::vector<bool> FailedNodes() const;
+
+  void Execute(Node &node, RunControl const &control,
+               std::mutex &callbackMutex) const;
+  // true when `node` took its value from m_store
+  bool Restore(Node &node) const;
+  void Save(Node const &node) const;
+  static void Notify(Node const &node, RunControl const &control,
+                     std::mutex &callbackMutex);
+};
+
+// Runs a section on a private serial graph, backing the factories'
+// standalone Make entry points.
+template <typename ScheduleFn>
+void RunSerial(epoch_tearsheet::DashboardBuilder &output,
+               ScheduleFn &&schedule) {
+  WidgetGraph graph;
+  schedule(graph);
+  graph.Run(false);
+  graph.Flush(output);
+}
+} // namespace epoch_folio
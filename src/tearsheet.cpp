@@ -3,11 +3,30 @@
 //
 
 #include "epoch_folio/tearsheet.h"
+#include "common/content_hash.h"
+#include "common/memory_tracker.h"
+#include "common/trace.h"
+#include "epoch_dashboard/tearsheet/table_builder.h"
+#include "epoch_folio/tearsheet_cache.h"
+#include "epoch_folio/tearsheet_writer.h"
+#include "portfolio/round_trip.h"
+#include <arrow/util/byte_size.h>
+#include <epoch_frame/factory/index_factory.h>
 #include <epoch_protos/tearsheet.pb.h>
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <iterator>
 #include <google/protobuf/message.h>
 #include <google/protobuf/util/json_util.h>
+#include <mutex>
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+#include <optional>
 #include <spdlog/spdlog.h>
+#include <unistd.h>
 
 namespace glz
 {
@@ -34,67 +53,668 @@ namespace glz
 
 namespace epoch_folio
 {
+  namespace
+  {
+    epoch_frame::DataFrame ResolveRoundTrips(TearSheetDataOption const &options)
+    {
+      EPOCH_FOLIO_TRACE("ResolveRoundTrips");
+      if (!options.roundTrip.empty() || options.transactions.empty())
+      {
+        return options.roundTrip;
+      }
+      return ExtractRoundTripsFromTransactions(options.transactions,
+                                               options.roundTripMatching);
+    }
+
+    epoch_frame::DataFrame AppendRows(epoch_frame::DataFrame const &data,
+                                      epoch_frame::DataFrame const &delta)
+    {
+      if (delta.empty())
+      {
+        return data;
+      }
+      if (data.empty())
+      {
+        return delta;
+      }
+      return epoch_frame::concat(
+          {.frames = {data, delta}, .axis = epoch_frame::AxisType::Row});
+    }
+
+    epoch_frame::Series AppendRows(epoch_frame::Series const &data,
+                                   epoch_frame::Series const &delta)
+    {
+      if (delta.empty())
+      {
+        return data;
+      }
+      if (data.empty())
+      {
+        return delta;
+      }
+      return AppendRows(data.to_frame(), delta.to_frame()).to_series();
+    }
+
+    // widgets are only reused across builds scheduled with the same options
+    std::string ScheduleKey(TearSheetOption const &options)
+    {
+      return std::format(
+          "{}|{}|{}|{}|{}|{}|{}|{}",
+          static_cast<int>(options.turnoverDenominator),
+          options.topKDrawDowns, options.topKPositions,
+          options.transactionBinMinutes, options.transactionTimezone,
+          options.topKRoundTripSymbols, options.maxChartPoints,
+          options.roundTripValueTolerance
+              .transform([](auto tolerance) { return tolerance.count(); })
+              .value_or(-1));
+    }
+
+    epoch_proto::TearSheet ToMessage(WidgetList const &widgets)
+    {
+      epoch_proto::TearSheet output;
+      for (auto const &widget : widgets)
+      {
+        std::visit(
+            [&]<typename T>(T const &value)
+            {
+              if constexpr (std::is_same_v<T, epoch_proto::CardDef>)
+              {
+                *output.mutable_cards()->add_cards() = value;
+              }
+              else if constexpr (std::is_same_v<T, epoch_proto::Chart>)
+              {
+                *output.mutable_charts()->add_charts() = value;
+              }
+              else
+              {
+                *output.mutable_tables()->add_tables() = value;
+              }
+            },
+            widget);
+      }
+      return output;
+    }
+
+    // widgets are flushed into per kind lists, so regrouping them by kind
+    // leaves the dashboard unchanged
+    WidgetList ToWidgets(epoch_proto::TearSheet &&message)
+    {
+      WidgetList widgets;
+      for (auto &card : *message.mutable_cards()->mutable_cards())
+      {
+        widgets.emplace_back(std::move(card));
+      }
+      for (auto &chart : *message.mutable_charts()->mutable_charts())
+      {
+        widgets.emplace_back(std::move(chart));
+      }
+      for (auto &table : *message.mutable_tables()->mutable_tables())
+      {
+        widgets.emplace_back(std::move(table));
+      }
+      return widgets;
+    }
+
+    epoch_proto::Table MakeMemoryTable(TrackingMemoryPool const &pool)
+    {
+      epoch_tearsheet::TableBuilder builder;
+      builder.setType(epoch_proto::WidgetDataTable)
+          .setCategory(categories::Memory)
+          .setTitle("Arrow Memory by Widget");
+      builder.addColumn("scope", "Scope", epoch_proto::TypeString)
+          .addColumn("category", "Category", epoch_proto::TypeString)
+          .addColumn("sampledPeakBytes", "Sampled Peak Bytes",
+                     epoch_proto::TypeInteger)
+          .addColumn("totalBytes", "Total Bytes", epoch_proto::TypeInteger)
+          .addColumn("allocations", "Allocations", epoch_proto::TypeInteger);
+
+      using epoch_tearsheet::ScalarFactory;
+      for (auto const &usage : pool.Report())
+      {
+        epoch_proto::TableRow row;
+        *row.add_values() =
+            ScalarFactory::create(epoch_frame::Scalar{usage.scope});
+        *row.add_values() =
+            ScalarFactory::create(epoch_frame::Scalar{usage.category});
+        for (auto value :
+             {usage.sampledPeakBytes, usage.totalBytes, usage.allocations})
+        {
+          *row.add_values() =
+              ScalarFactory::create(epoch_frame::Scalar{value});
+        }
+        builder.addRow(std::move(row));
+      }
+      return builder.build();
+    }
+
+    uint64_t FrameBytes(epoch_frame::DataFrame const &frame)
+    {
+      if (frame.empty())
+      {
+        return 0;
+      }
+      return arrow::util::TotalBufferSize(*frame.table()) +
+             arrow::util::TotalBufferSize(*frame.index()->as_chunked_array());
+    }
+
+    // The spill file is unlinked once mapped: the mapping keeps its pages,
+    // which the kernel reads on demand and may evict under pressure.
+    epoch_frame::DataFrame SpillFrame(epoch_frame::DataFrame const &frame,
+                                      std::filesystem::path const &directory)
+    {
+      static std::atomic<uint64_t> spills{0};
+      const auto path =
+          directory / std::format("epoch_folio_spill_{}_{}.arrow", ::getpid(),
+                                  spills.fetch_add(1));
+      arrow::TablePtr table;
+      try
+      {
+        WriteWidgetSeries({"spill", "", frame}, path.string());
+        table = MapWidgetSeries(path.string());
+      }
+      catch (...)
+      {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        throw;
+      }
+      std::filesystem::remove(path);
+
+      epoch_frame::DataFrame mapped{
+          epoch_frame::factory::index::from_range(table->num_rows()), table};
+      return mapped.set_index("index");
+    }
+
+    [[noreturn]] void ThrowCancelled(RunControl const &control)
+    {
+      throw BuildCancelled(control.token.IsCancelled()
+                               ? "tear sheet build cancelled"
+                               : "tear sheet build ran past its deadline");
+    }
+
+    // a failed write only costs the next build a recompute
+    void Persist(TearSheetDiskCache &cache, std::string const &key,
+                 epoch_proto::TearSheet const &value)
+    {
+      try
+      {
+        cache.Put(key, value);
+      }
+      catch (std::exception const &e)
+      {
+        SPDLOG_ERROR("Failed to persist tear sheet cache entry: {}",
+                     e.what());
+      }
+    }
+  } // namespace
+
+  struct PortfolioTearSheetFactory::BuildCache
+  {
+    std::mutex mutex;
+    WidgetCache widgets;
+    // inputs appended since `widgets` was stored
+    uint8_t changedInputs{widget_inputs::All};
+    std::optional<std::string> key;
+    // HashTearSheetData of the current inputs, computed on first use
+    std::optional<std::string> dataHash;
+
+    std::string const &DataHash(TearSheetDataOption const &data,
+                                returns::SharedBenchmark const &shared)
+    {
+      if (!dataHash)
+      {
+        if (shared)
+        {
+          auto replaced = data;
+          replaced.benchmark = shared->source;
+          dataHash = HashTearSheetData(replaced);
+        }
+        else
+        {
+          dataHash = HashTearSheetData(data);
+        }
+      }
+      return *dataHash;
+    }
+  };
+
+  // a one per core arena, so async builds beyond that queue instead of each
+  // taking a thread
+  struct PortfolioTearSheetFactory::AsyncBuilds
+  {
+    tbb::task_arena arena{};
+    tbb::task_group group;
+
+    void Wait()
+    {
+      arena.execute([this] { group.wait(); });
+    }
+
+    ~AsyncBuilds() { Wait(); }
+  };
+
+  void PortfolioTearSheetFactory::WaitForAsyncBuilds() const
+  {
+    // null once moved from
+    if (m_async)
+    {
+      m_async->Wait();
+    }
+  }
+
+  epoch_frame::Series StrategyReturns(TearSheetDataOption const &options)
+  {
+    return options.isEquity ? options.equity.pct_change()
+                                  .iloc({.start = 1})
+                                  .ffill()
+                                  .drop_null()
+                            : options.equity;
+  }
+
   PortfolioTearSheetFactory::PortfolioTearSheetFactory(
-      TearSheetDataOption const &options)
-      : m_returns(options.isEquity ? options.equity.pct_change()
-                                         .iloc({.start = 1})
-                                         .ffill()
-                                         .drop_null()
-                                   : options.equity),
+      TearSheetDataOption const &options,
+      returns::SharedBenchmark sharedBenchmark)
+      : m_data(options), m_sharedBenchmark(std::move(sharedBenchmark)),
+        m_returns(StrategyReturns(options)),
         m_positions(options.positions.assign("cash", options.cash)),
-        m_returnsFactory(options.positions, options.transactions, options.cash,
-                         m_returns, options.benchmark),
+        m_returnsFactory(
+            m_sharedBenchmark
+                ? returns::TearSheetFactory{options.positions,
+                                            options.transactions, options.cash,
+                                            m_returns, m_sharedBenchmark,
+                                            options.benchmarks,
+                                            options.benchmarkFill}
+                : returns::TearSheetFactory{
+                      options.positions, options.transactions, options.cash,
+                      m_returns, options.benchmark, options.benchmarks,
+                      options.benchmarkFill}),
         m_positionsFactory(options.cash, options.positions, m_returns,
-                           options.sectorMapping),
+                           options.sectorMapping, options.classification),
         m_transactionsFactory(m_returns, m_positions, options.transactions),
-        m_roundTripFactory(options.roundTrip, m_returns, m_positions,
-                           options.sectorMapping) {}
+        m_roundTripFactory(ResolveRoundTrips(options), m_returns, m_positions,
+                           options.sectorMapping),
+        m_cache(std::make_unique<BuildCache>()),
+        m_async(std::make_unique<AsyncBuilds>()) {}
 
-  epoch_proto::TearSheet
-  PortfolioTearSheetFactory::MakeTearSheet(TearSheetOption const &options) const
+  PortfolioTearSheetFactory::PortfolioTearSheetFactory(
+      PortfolioTearSheetFactory &&) noexcept = default;
+  PortfolioTearSheetFactory &PortfolioTearSheetFactory::operator=(
+      PortfolioTearSheetFactory &&) noexcept = default;
+  PortfolioTearSheetFactory::~PortfolioTearSheetFactory() = default;
+
+  void PortfolioTearSheetFactory::Append(TearSheetDataOption const &delta)
   {
-    epoch_tearsheet::DashboardBuilder builder;
+    // queued builds read the members reassigned below
+    WaitForAsyncBuilds();
+    uint8_t changed = 0;
+    auto merged = m_data;
+    if (!delta.equity.empty())
+    {
+      merged.equity = AppendRows(merged.equity, delta.equity);
+      changed |= widget_inputs::Returns;
+    }
+    if (delta.benchmark && !delta.benchmark->empty())
+    {
+      auto benchmark = m_sharedBenchmark
+                           ? std::optional{m_sharedBenchmark->source}
+                           : merged.benchmark;
+      merged.benchmark = benchmark ? AppendRows(*benchmark, *delta.benchmark)
+                                   : *delta.benchmark;
+      changed |= widget_inputs::Benchmark;
+    }
+    for (auto const &extra : delta.benchmarks)
+    {
+      auto it = std::ranges::find(merged.benchmarks, extra.name,
+                                  &NamedBenchmark::name);
+      if (it == merged.benchmarks.end())
+      {
+        merged.benchmarks.push_back(extra);
+      }
+      else
+      {
+        it->returns = AppendRows(it->returns, extra.returns);
+      }
+      changed |= widget_inputs::Benchmark;
+    }
+    if (!delta.positions.empty() || !delta.cash.empty())
+    {
+      merged.positions = AppendRows(merged.positions, delta.positions);
+      merged.cash = AppendRows(merged.cash, delta.cash);
+      changed |= widget_inputs::Positions;
+    }
+    if (!delta.transactions.empty())
+    {
+      merged.transactions = AppendRows(merged.transactions, delta.transactions);
+      changed |= widget_inputs::Transactions;
+      if (m_data.roundTrip.empty())
+      {
+        // round trips are matched from the transactions
+        changed |= widget_inputs::RoundTrips;
+      }
+    }
+    if (!delta.roundTrip.empty())
+    {
+      merged.roundTrip = AppendRows(merged.roundTrip, delta.roundTrip);
+      changed |= widget_inputs::RoundTrips;
+    }
+    if (changed == 0)
+    {
+      return;
+    }
 
-    try
+    auto cache = std::move(m_cache);
+    auto async = std::move(m_async);
+    auto diskCache = std::move(m_diskCache);
+    auto budget = std::move(m_memoryBudget);
+    const auto spilledInputs = m_spilledInputs & ~changed;
+    auto sharedBenchmark = (changed & widget_inputs::Benchmark) == 0
+                               ? m_sharedBenchmark
+                               : nullptr;
+    *this = PortfolioTearSheetFactory{merged, std::move(sharedBenchmark)};
+    cache->changedInputs |= changed;
+    cache->dataHash.reset();
+    m_cache = std::move(cache);
+    m_async = std::move(async);
+    m_diskCache = std::move(diskCache);
+    m_memoryBudget = std::move(budget);
+    m_spilledInputs = static_cast<uint8_t>(spilledInputs);
+    if (m_memoryBudget)
     {
-      m_returnsFactory.Make(options.turnoverDenominator, options.topKDrawDowns,
-                            builder);
+      SpillInputs(changed);
     }
-    catch (std::exception const &e)
+  }
+
+  void PortfolioTearSheetFactory::UseDiskCache(
+      std::shared_ptr<TearSheetDiskCache> cache)
+  {
+    WaitForAsyncBuilds();
+    m_diskCache = std::move(cache);
+  }
+
+  void PortfolioTearSheetFactory::UseMemoryBudget(MemoryBudget budget)
+  {
+    WaitForAsyncBuilds();
+    m_memoryBudget = std::move(budget);
+    SpillInputs(widget_inputs::All);
+  }
+
+  void PortfolioTearSheetFactory::SpillInputs(uint8_t candidates)
+  {
+    EPOCH_FOLIO_TRACE("PortfolioTearSheetFactory::SpillInputs");
+    struct Input
     {
-      SPDLOG_ERROR("Failed to create returns tearsheet: {}", e.what());
+      uint8_t kind;
+      epoch_frame::DataFrame *frame;
+      uint64_t bytes;
+    };
+
+    auto data = m_data;
+    std::vector<Input> inputs;
+    uint64_t resident = 0;
+    for (auto [kind, frame] :
+         {std::pair{widget_inputs::Positions, &data.positions},
+          std::pair{widget_inputs::Transactions, &data.transactions},
+          std::pair{widget_inputs::RoundTrips, &data.roundTrip}})
+    {
+      if ((m_spilledInputs & kind) != 0)
+      {
+        continue;
+      }
+      const auto bytes = FrameBytes(*frame);
+      resident += bytes;
+      if ((candidates & kind) != 0 && bytes != 0)
+      {
+        inputs.push_back({kind, frame, bytes});
+      }
     }
 
-    try
+    const std::filesystem::path directory =
+        m_memoryBudget->spillDirectory.empty()
+            ? std::filesystem::temp_directory_path()
+            : std::filesystem::path{m_memoryBudget->spillDirectory};
+    std::ranges::sort(inputs, std::greater{}, &Input::bytes);
+    uint8_t spilled = 0;
+    for (auto const &input : inputs)
     {
-      m_positionsFactory.Make(options.topKPositions, builder);
+      if (resident <= m_memoryBudget->bytes / 2)
+      {
+        break;
+      }
+      *input.frame = SpillFrame(*input.frame, directory);
+      resident -= input.bytes;
+      spilled |= input.kind;
     }
-    catch (std::exception const &e)
+    if (spilled == 0)
     {
-      SPDLOG_ERROR("Failed to create positions tearsheet: {}", e.what());
+      return;
     }
 
-    try
+    // the content is unchanged, so every cached widget stays valid
+    auto cache = std::move(m_cache);
+    auto async = std::move(m_async);
+    auto diskCache = std::move(m_diskCache);
+    auto budget = std::move(m_memoryBudget);
+    const auto spilledInputs = m_spilledInputs | spilled;
+    *this = PortfolioTearSheetFactory{data, m_sharedBenchmark};
+    m_cache = std::move(cache);
+    m_async = std::move(async);
+    m_diskCache = std::move(diskCache);
+    m_memoryBudget = std::move(budget);
+    m_spilledInputs = static_cast<uint8_t>(spilledInputs);
+  }
+
+  std::string
+  PortfolioTearSheetFactory::SheetKey(TearSheetOption const &options) const
+  {
+    std::lock_guard lock{m_cache->mutex};
+    return std::format("sheet|{}|{}",
+                       m_cache->DataHash(m_data, m_sharedBenchmark),
+                       TearSheetOptionKey(options));
+  }
+
+  void PortfolioTearSheetFactory::BuildWidgets(
+      WidgetGraph &graph, TearSheetOption const &options,
+      RunControl const &control) const
+  {
+    EPOCH_FOLIO_TRACE("PortfolioTearSheetFactory::BuildWidgets");
+    auto runControl = control;
+    runControl.lowMemory = runControl.lowMemory || m_memoryBudget.has_value();
+    std::optional<InstallMemoryPool> installed;
+    if (options.memoryTracker)
     {
-      m_transactionsFactory.Make(options.turnoverDenominator,
-                                 options.transactionBinMinutes,
-                                 options.transactionTimezone, builder);
+      installed.emplace(*options.memoryTracker);
     }
-    catch (std::exception const &e)
+    MemoryScope memory{"tearsheet", "total"};
+    m_returnsFactory.Schedule(graph, options.turnoverDenominator,
+                              options.topKDrawDowns, options.maxChartPoints);
+    m_positionsFactory.Schedule(graph, options.topKPositions,
+                                options.maxChartPoints);
+    m_transactionsFactory.Schedule(graph, options.turnoverDenominator,
+                                   options.transactionBinMinutes,
+                                   options.transactionTimezone);
+    m_roundTripFactory.Schedule(graph, options.topKRoundTripSymbols,
+                                options.roundTripValueTolerance);
+
+    graph.Select(options.selection);
+
+    // the cache lock covers taking the snapshot and storing the result, never
+    // the run, so builds on one factory overlap
+    const auto key = ScheduleKey(options);
+    uint8_t changedInputs{};
+    std::string dataHash;
     {
-      SPDLOG_ERROR("Failed to create transactions tearsheet: {}", e.what());
+      std::lock_guard lock{m_cache->mutex};
+      if (m_cache->key != key)
+      {
+        m_cache->widgets.clear();
+        m_cache->changedInputs = widget_inputs::All;
+        m_cache->key = key;
+      }
+      if (!graph.CollectsSeries())
+      {
+        graph.Reuse(m_cache->widgets, m_cache->changedInputs);
+      }
+      changedInputs = m_cache->changedInputs;
+      if (m_diskCache)
+      {
+        dataHash = m_cache->DataHash(m_data, m_sharedBenchmark);
+      }
     }
 
-    try
+    // content addressed, so stored widgets are valid whatever changed
+    WidgetCache stored;
+    std::string prefix;
+    std::vector<std::string> pending;
+    if (m_diskCache)
     {
-      m_roundTripFactory.Make(builder);
+      // intermediates are keyed by the inputs and only the options they read,
+      // so builds with other options still share them
+      auto intermediates = std::format("intermediate|{}|", dataHash);
+      graph.UseIntermediateStore(
+          {.load = [cache = m_diskCache,
+                    intermediates](std::string const &id)
+           { return cache->GetFrame(intermediates + id); },
+           .save = [cache = m_diskCache, intermediates](
+                       std::string const &id,
+                       epoch_frame::DataFrame const &frame)
+           { cache->PutFrame(intermediates + id, frame); }});
+
+      prefix = std::format("widget|{}|{}|", dataHash, key);
+      pending = graph.PendingWidgets();
+      for (auto const &id : pending)
+      {
+        epoch_proto::TearSheet message;
+        if (!graph.CollectsSeries() && m_diskCache->Get(prefix + id, message))
+        {
+          stored.emplace(id, ToWidgets(std::move(message)));
+        }
+      }
+      graph.Reuse(stored, 0);
     }
-    catch (std::exception const &e)
+
+    graph.Run(options.parallel, runControl);
+    if (graph.Stopped())
+    {
+      // the skipped widgets are missing, nothing of this build is kept
+      ThrowCancelled(control);
+    }
+
     {
-      SPDLOG_ERROR("Failed to create round trip tearsheet: {}", e.what());
+      std::lock_guard lock{m_cache->mutex};
+      // a concurrent build with other options may have replaced the cache
+      if (m_cache->key == key)
+      {
+        graph.Store(m_cache->widgets, changedInputs);
+        m_cache->changedInputs = 0;
+      }
     }
 
-    return builder.build();
+    for (auto const &id : pending)
+    {
+      // a failure may be transient (e.g. bad_alloc), never make it permanent
+      if (!stored.contains(id) && !graph.Failed(id))
+      {
+        Persist(*m_diskCache, prefix + id, ToMessage(graph.Widgets(id)));
+      }
+    }
+  }
+
+  epoch_proto::TearSheet
+  PortfolioTearSheetFactory::MakeTearSheet(TearSheetOption const &options) const
+  {
+    return Build(options, {});
+  }
+
+  epoch_proto::TearSheet
+  PortfolioTearSheetFactory::Build(TearSheetOption const &options,
+                                   RunControl const &control) const
+  {
+    // a build cancelled while queued never touches the caches
+    if (control.Expired())
+    {
+      ThrowCancelled(control);
+    }
+    std::string key;
+    if (m_diskCache)
+    {
+      key = SheetKey(options);
+      // a tracked build runs so there is memory to report
+      epoch_proto::TearSheet cached;
+      if (!options.memoryTracker && m_diskCache->Get(key, cached))
+      {
+        return cached;
+      }
+    }
+
+    WidgetGraph graph;
+    BuildWidgets(graph, options, control);
+
+    epoch_tearsheet::DashboardBuilder builder;
+    graph.Flush(builder);
+    auto output = builder.build();
+    if (m_diskCache && !graph.AnyFailed())
+    {
+      Persist(*m_diskCache, key, output);
+    }
+    if (options.memoryTracker)
+    {
+      *output.mutable_tables()->add_tables() =
+          MakeMemoryTable(*options.memoryTracker);
+    }
+    return output;
+  }
+
+  std::future<epoch_proto::TearSheet>
+  PortfolioTearSheetFactory::MakeTearSheetAsync(
+      TearSheetOption const &options, CancellationToken token,
+      std::optional<Deadline> deadline, WidgetCallback onWidget) const
+  {
+    auto promise = std::make_shared<std::promise<epoch_proto::TearSheet>>();
+    auto future = promise->get_future();
+    m_async->arena.execute(
+        [&]
+        {
+          m_async->group.run(
+              [this, options, promise,
+               control = RunControl{std::move(token), deadline,
+                                    std::move(onWidget)}]
+              {
+                try
+                {
+                  promise->set_value(Build(options, control));
+                }
+                catch (...)
+                {
+                  promise->set_exception(std::current_exception());
+                }
+              });
+        });
+    return future;
+  }
+
+  void PortfolioTearSheetFactory::Export(
+      TearSheetOption const &options,
+      TearSheetExportOption const &exportOption) const
+  {
+    EPOCH_FOLIO_TRACE("PortfolioTearSheetFactory::Export");
+    const std::filesystem::path directory{exportOption.directory};
+    std::filesystem::create_directories(directory);
+
+    // one build yields the skeleton and the frames its widgets were drawn
+    // from; every widget runs, a reused one would publish nothing
+    auto skeletonOptions = options;
+    skeletonOptions.maxChartPoints = exportOption.previewPoints;
+    WidgetGraph graph;
+    graph.CollectSeries();
+    BuildWidgets(graph, skeletonOptions);
+
+    epoch_tearsheet::DashboardBuilder builder;
+    graph.Flush(builder);
+    WriteTearSheet(builder.build(), (directory / "tearsheet.pb").string());
+    for (auto const &widget : graph.TakeSeries())
+    {
+      WriteWidgetSeries(widget, (directory / (widget.id + ".arrow")).string());
+    }
   }
 
   template <typename T>
@@ -112,22 +732,15 @@ namespace epoch_folio
   template <typename T>
   void write_protobuf_(const T &output, std::string const &file_path)
   {
-    std::string binary_data;
-    if (!output.SerializeToString(&binary_data))
+    try
     {
-      SPDLOG_ERROR("Failed to serialize protobuf message to binary");
-      return;
+      WriteTearSheet(output, file_path);
     }
-
-    std::ofstream file(file_path, std::ios::binary);
-    if (!file.is_open())
+    catch (std::exception const &e)
     {
-      SPDLOG_ERROR("Failed to open file for writing: {}", file_path);
+      SPDLOG_ERROR("Failed to write protobuf data: {}", e.what());
       return;
     }
-
-    file.write(binary_data.data(), binary_data.size());
-    file.close();
     SPDLOG_INFO("Successfully wrote protobuf data to: {}", file_path);
   }
 
@@ -0,0 +1,224 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "epoch_folio/tearsheet_cache.h"
+#include "common/content_hash.h"
+#include "epoch_folio/tearsheet_writer.h"
+#include <algorithm>
+#include <epoch_frame/factory/index_factory.h>
+#include <fcntl.h>
+#include <format>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace epoch_folio
+{
+  namespace
+  {
+    constexpr std::string_view kExtension = ".pb";
+    constexpr std::string_view kFrameExtension = ".arrow";
+
+    struct Entry
+    {
+      std::filesystem::path path;
+      std::filesystem::file_time_type used;
+      uint64_t bytes;
+    };
+
+    // entries written by any process, temporaries of writers in flight are
+    // left alone
+    std::vector<Entry> ScanEntries(std::filesystem::path const &directory)
+    {
+      std::vector<Entry> entries;
+      std::error_code ec;
+      for (auto const &file :
+           std::filesystem::directory_iterator{directory, ec})
+      {
+        const auto extension = file.path().extension();
+        if (!file.is_regular_file(ec) ||
+            (extension != kExtension && extension != kFrameExtension))
+        {
+          continue;
+        }
+        const auto used = file.last_write_time(ec);
+        const auto bytes = file.file_size(ec);
+        if (!ec)
+        {
+          entries.push_back({file.path(), used, bytes});
+        }
+      }
+      return entries;
+    }
+  } // namespace
+
+  TearSheetDiskCache::TearSheetDiskCache(std::string const &directory,
+                                         uint64_t maxBytes)
+      : m_directory(directory), m_maxBytes(maxBytes)
+  {
+    std::filesystem::create_directories(m_directory);
+    std::lock_guard lock{m_mutex};
+    Evict();
+  }
+
+  std::filesystem::path
+  TearSheetDiskCache::Path(std::string const &key,
+                           std::string_view extension) const
+  {
+    return m_directory / (HashKey(key) + std::string{extension});
+  }
+
+  template <typename Write>
+  void TearSheetDiskCache::PutFile(std::filesystem::path const &path,
+                                   Write &&write)
+  {
+    uint64_t count;
+    {
+      std::lock_guard lock{m_mutex};
+      count = m_writes++;
+    }
+    auto temporary = path;
+    temporary += std::format(".{}.{}.tmp", ::getpid(), count);
+
+    try
+    {
+      write(temporary);
+      std::filesystem::rename(temporary, path);
+    }
+    catch (...)
+    {
+      std::error_code ec;
+      std::filesystem::remove(temporary, ec);
+      throw;
+    }
+
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(path, ec);
+    std::lock_guard lock{m_mutex};
+    m_bytes += ec ? 0 : bytes;
+    if (m_bytes > m_maxBytes)
+    {
+      Evict();
+    }
+  }
+
+  bool TearSheetDiskCache::Get(std::string const &key,
+                               epoch_proto::TearSheet &output) const
+  {
+    const auto path = Path(key, kExtension);
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      return false;
+    }
+
+    struct stat info{};
+    bool ok = ::fstat(fd, &info) == 0;
+    if (ok && info.st_size == 0)
+    {
+      // an empty message serializes to nothing
+      output.Clear();
+    }
+    else if (ok)
+    {
+      const auto size = static_cast<size_t>(info.st_size);
+      void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ok = mapped != MAP_FAILED;
+      if (ok)
+      {
+        ::madvise(mapped, size, MADV_SEQUENTIAL);
+        ok = output.ParseFromArray(mapped, static_cast<int>(size));
+        ::munmap(mapped, size);
+      }
+    }
+    if (ok)
+    {
+      // the modification time doubles as the last use for eviction
+      ::futimens(fd, nullptr);
+    }
+    else
+    {
+      output.Clear();
+    }
+    ::close(fd);
+    return ok;
+  }
+
+  void TearSheetDiskCache::Put(std::string const &key,
+                               epoch_proto::TearSheet const &value)
+  {
+    PutFile(Path(key, kExtension), [&](std::filesystem::path const &file)
+            { WriteTearSheet(value, file.string()); });
+  }
+
+  std::optional<epoch_frame::DataFrame>
+  TearSheetDiskCache::GetFrame(std::string const &key) const
+  {
+    const auto path = Path(key, kFrameExtension);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec))
+    {
+      return std::nullopt;
+    }
+    arrow::TablePtr table;
+    try
+    {
+      table = MapWidgetSeries(path.string());
+    }
+    catch (std::exception const &)
+    {
+      // removed by another process's eviction or unreadable, a miss either way
+      return std::nullopt;
+    }
+    std::filesystem::last_write_time(
+        path, std::filesystem::file_time_type::clock::now(), ec);
+
+    epoch_frame::DataFrame mapped{
+        epoch_frame::factory::index::from_range(table->num_rows()), table};
+    return mapped.set_index("index");
+  }
+
+  void TearSheetDiskCache::PutFrame(std::string const &key,
+                                    epoch_frame::DataFrame const &value)
+  {
+    PutFile(Path(key, kFrameExtension),
+            [&](std::filesystem::path const &file)
+            { WriteWidgetSeries({"intermediate", "", value}, file.string()); });
+  }
+
+  uint64_t TearSheetDiskCache::SizeBytes() const
+  {
+    std::lock_guard lock{m_mutex};
+    return m_bytes;
+  }
+
+  void TearSheetDiskCache::Evict()
+  {
+    auto entries = ScanEntries(m_directory);
+    uint64_t total = 0;
+    for (auto const &entry : entries)
+    {
+      total += entry.bytes;
+    }
+
+    if (total > m_maxBytes)
+    {
+      const auto target = m_maxBytes - m_maxBytes / 10;
+      std::ranges::sort(entries, {}, &Entry::used);
+      for (auto const &entry : entries)
+      {
+        if (total <= target)
+        {
+          break;
+        }
+        std::error_code ec;
+        // another process may have removed it already
+        std::filesystem::remove(entry.path, ec);
+        total -= entry.bytes;
+      }
+    }
+    m_bytes = total;
+  }
+} // namespace epoch_folio
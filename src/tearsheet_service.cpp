@@ -0,0 +1,219 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "epoch_folio/tearsheet_service.h"
+#include "common/content_hash.h"
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <spdlog/spdlog.h>
+
+namespace epoch_folio
+{
+  namespace
+  {
+    std::string SourceKey(TableSource const &source)
+    {
+      const std::filesystem::path path{source.path};
+      const auto modified = std::filesystem::last_write_time(path)
+                                .time_since_epoch()
+                                .count();
+      std::string key = std::format(
+          "{}:{}:{}:{}:{}", std::filesystem::absolute(path).string(),
+          std::filesystem::file_size(path), modified, source.timeColumn,
+          source.setIndex);
+      for (auto const &column : source.columns)
+      {
+        key += std::format(",{}", column);
+      }
+      // unordered, so sort the renames for a stable key
+      std::map<std::string, std::string> rename(source.rename.begin(),
+                                                source.rename.end());
+      for (auto const &[from, to] : rename)
+      {
+        key += std::format(",{}>{}", from, to);
+      }
+      return key;
+    }
+
+    std::string OptionalSourceKey(std::optional<TableSource> const &source)
+    {
+      return source ? SourceKey(*source) : "-";
+    }
+
+    epoch_proto::TearSheet BuildFromFiles(TearSheetRequest const &request)
+    {
+      auto data = LoadTearSheetData(request.sources);
+      data.isEquity = request.isEquity;
+      return PortfolioTearSheetFactory{data}.MakeTearSheet(request.options);
+    }
+  } // namespace
+
+  TearSheetService::TearSheetService(TearSheetServiceOption option,
+                                     Builder builder)
+      : m_option(option),
+        m_builder(builder ? std::move(builder) : Builder{BuildFromFiles}),
+        m_arena(option.workers > 0 ? option.workers
+                                   : tbb::task_arena::automatic) {}
+
+  TearSheetService::~TearSheetService()
+  {
+    m_arena.execute([this] { m_group.wait(); });
+  }
+
+  std::string TearSheetService::Key(TearSheetRequest const &request)
+  {
+    auto const &sources = request.sources;
+    return std::format(
+        "{}|{}|{}|{}|{}|{}|{}|{}|{}|{}", SourceKey(sources.equity),
+        OptionalSourceKey(sources.benchmark), OptionalSourceKey(sources.cash),
+        OptionalSourceKey(sources.positions),
+        OptionalSourceKey(sources.transactions),
+        OptionalSourceKey(sources.roundTrip), sources.start.value_or(-1),
+        sources.end.value_or(-1), request.isEquity,
+        TearSheetOptionKey(request.options));
+  }
+
+  std::shared_future<TearSheetService::Result>
+  TearSheetService::Build(TearSheetRequest const &request)
+  {
+    auto key = Key(request);
+
+    std::unique_lock lock{m_mutex};
+    if (auto it = m_cache.find(key); it != m_cache.end())
+    {
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+      std::promise<Result> ready;
+      ready.set_value(it->second->second);
+      return ready.get_future().share();
+    }
+    if (auto it = m_inFlight.find(key); it != m_inFlight.end())
+    {
+      return it->second;
+    }
+    if (auto it = m_failed.find(key); it != m_failed.end())
+    {
+      if (std::chrono::steady_clock::now() < it->second.expires)
+      {
+        return it->second.future;
+      }
+      m_failed.erase(it);
+    }
+    if (m_inFlight.size() >= m_option.maxPending)
+    {
+      throw ServiceBusy(std::format("{} tear sheets already pending",
+                                    m_inFlight.size()));
+    }
+
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future().share();
+    m_inFlight.emplace(key, future);
+    lock.unlock();
+
+    m_arena.execute(
+        [&]
+        {
+          m_group.run(
+              [this, key = std::move(key), request, promise, future]
+              {
+                try
+                {
+                  auto result = std::make_shared<const epoch_proto::TearSheet>(
+                      m_builder(request));
+                  Complete(key, result);
+                  promise->set_value(std::move(result));
+                }
+                catch (std::exception const &e)
+                {
+                  SPDLOG_ERROR("Failed to build tear sheet: {}", e.what());
+                  // set before Fail publishes the future, so a request
+                  // served from m_failed never waits
+                  promise->set_exception(std::current_exception());
+                  Fail(key, future);
+                }
+              });
+        });
+    return future;
+  }
+
+  void TearSheetService::Complete(std::string const &key, Result const &result)
+  {
+    std::lock_guard lock{m_mutex};
+    m_inFlight.erase(key);
+    if (m_option.cacheEntries == 0)
+    {
+      return;
+    }
+    m_lru.emplace_front(key, result);
+    m_cache[key] = m_lru.begin();
+    while (m_lru.size() > m_option.cacheEntries)
+    {
+      m_cache.erase(m_lru.back().first);
+      m_lru.pop_back();
+    }
+  }
+
+  void TearSheetService::Fail(std::string const &key,
+                              std::shared_future<Result> const &future)
+  {
+    std::lock_guard lock{m_mutex};
+    m_inFlight.erase(key);
+    if (m_option.failureTtl <= std::chrono::milliseconds::zero())
+    {
+      return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_failed,
+                  [&](auto const &entry) { return entry.second.expires <= now; });
+    m_failed.insert_or_assign(key, Failure{future, now + m_option.failureTtl});
+  }
+
+  std::string TearSheetService::Submit(TearSheetRequest const &request)
+  {
+    const auto id =
+        std::format("{:016x}", std::hash<std::string>{}(Key(request)));
+    {
+      std::lock_guard lock{m_mutex};
+      if (m_requests.emplace(id, request).second)
+      {
+        m_requestOrder.push_back(id);
+        while (m_requestOrder.size() > m_option.maxRequests)
+        {
+          m_requests.erase(m_requestOrder.front());
+          m_requestOrder.pop_front();
+        }
+      }
+    }
+    Build(request);
+    return id;
+  }
+
+  std::optional<std::shared_future<TearSheetService::Result>>
+  TearSheetService::Fetch(std::string const &id,
+                          std::optional<std::string> const &widget)
+  {
+    TearSheetRequest request;
+    {
+      std::lock_guard lock{m_mutex};
+      auto it = m_requests.find(id);
+      if (it == m_requests.end())
+      {
+        return std::nullopt;
+      }
+      request = it->second;
+    }
+    if (widget)
+    {
+      request.options.selection = WidgetSelection{.widgets = {*widget}};
+    }
+    return Build(request);
+  }
+
+  size_t TearSheetService::CacheSize() const
+  {
+    std::lock_guard lock{m_mutex};
+    return m_lru.size();
+  }
+} // namespace epoch_folio
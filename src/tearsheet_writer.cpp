@@ -0,0 +1,596 @@
+//
+// Created by adesola on 10/18/26.
+//
+
+#include "epoch_folio/tearsheet_writer.h"
+#include "common/series_helper.h"
+#include <algorithm>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/key_value_metadata.h>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <google/protobuf/io/gzip_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef EPOCH_FOLIO_WITH_ZSTD
+#include <memory>
+#include <optional>
+#include <zstd.h>
+#endif
+
+namespace io = google::protobuf::io;
+using epoch_core::TearSheetCompression;
+
+namespace epoch_folio
+{
+  namespace
+  {
+    constexpr std::array<char, 4> kMagic{'E', 'F', 'T', 'C'};
+    constexpr uint8_t kVersion = 1;
+    constexpr size_t kHeaderSize = kMagic.size() + 2;
+    constexpr size_t kLengthSize = sizeof(uint64_t);
+
+    [[noreturn]] void ThrowErrno(std::string const &what,
+                                 std::string const &path)
+    {
+      throw std::runtime_error(
+          std::format("{} {}: {}", what, path, std::strerror(errno)));
+    }
+
+    void EncodeLength(uint64_t length, std::array<uint8_t, kLengthSize> &out)
+    {
+      for (size_t i = 0; i < kLengthSize; ++i)
+      {
+        out[i] = static_cast<uint8_t>(length >> (8 * i));
+      }
+    }
+
+    uint64_t DecodeLength(std::array<uint8_t, kLengthSize> const &in)
+    {
+      uint64_t length = 0;
+      for (size_t i = 0; i < kLengthSize; ++i)
+      {
+        length |= static_cast<uint64_t>(in[i]) << (8 * i);
+      }
+      return length;
+    }
+
+    bool PreadAll(int fd, void *buffer, size_t size, uint64_t offset)
+    {
+      auto *out = static_cast<char *>(buffer);
+      while (size > 0)
+      {
+        const auto n = ::pread(fd, out, size, static_cast<off_t>(offset));
+        if (n <= 0)
+        {
+          if (n < 0 && errno == EINTR)
+          {
+            continue;
+          }
+          return false;
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+      }
+      return true;
+    }
+
+    bool PwriteAll(int fd, void const *buffer, size_t size, uint64_t offset)
+    {
+      auto const *in = static_cast<char const *>(buffer);
+      while (size > 0)
+      {
+        const auto n = ::pwrite(fd, in, size, static_cast<off_t>(offset));
+        if (n < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          return false;
+        }
+        in += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+      }
+      return true;
+    }
+
+    // positional reads of [begin, end), so readers never share a file cursor
+    class PreadSource final : public io::CopyingInputStream
+    {
+    public:
+      PreadSource(int fd, uint64_t begin, uint64_t end)
+          : m_fd(fd), m_position(begin), m_end(end) {}
+
+      int Read(void *buffer, int size) override
+      {
+        const auto want = std::min<uint64_t>(size, m_end - m_position);
+        if (want == 0)
+        {
+          return 0;
+        }
+        const auto n =
+            ::pread(m_fd, buffer, want, static_cast<off_t>(m_position));
+        if (n < 0)
+        {
+          return errno == EINTR ? Read(buffer, size) : -1;
+        }
+        m_position += static_cast<uint64_t>(n);
+        return static_cast<int>(n);
+      }
+
+    private:
+      int m_fd;
+      uint64_t m_position;
+      uint64_t m_end;
+    };
+
+#ifdef EPOCH_FOLIO_WITH_ZSTD
+    struct ZstdContextDeleter
+    {
+      void operator()(ZSTD_CCtx *ctx) const { ZSTD_freeCCtx(ctx); }
+      void operator()(ZSTD_DCtx *ctx) const { ZSTD_freeDCtx(ctx); }
+    };
+
+    // compresses the bytes handed over by CopyingOutputStreamAdaptor into the
+    // downstream zero-copy stream
+    class ZstdSink final : public io::CopyingOutputStream
+    {
+    public:
+      explicit ZstdSink(io::ZeroCopyOutputStream *out) : m_out(out) {}
+
+      bool Write(void const *buffer, int size) override
+      {
+        ZSTD_inBuffer in{buffer, static_cast<size_t>(size), 0};
+        while (in.pos < in.size)
+        {
+          if (!Compress(in, ZSTD_e_continue).has_value())
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      bool Finish()
+      {
+        ZSTD_inBuffer in{nullptr, 0, 0};
+        std::optional<size_t> remaining;
+        do
+        {
+          remaining = Compress(in, ZSTD_e_end);
+        } while (remaining.has_value() && *remaining != 0);
+        return remaining.has_value();
+      }
+
+    private:
+      io::ZeroCopyOutputStream *m_out;
+      std::unique_ptr<ZSTD_CCtx, ZstdContextDeleter> m_ctx{ZSTD_createCCtx()};
+
+      std::optional<size_t> Compress(ZSTD_inBuffer &in, ZSTD_EndDirective mode)
+      {
+        void *chunk = nullptr;
+        int chunkSize = 0;
+        if (!m_out->Next(&chunk, &chunkSize))
+        {
+          return std::nullopt;
+        }
+        ZSTD_outBuffer out{chunk, static_cast<size_t>(chunkSize), 0};
+        const auto remaining =
+            ZSTD_compressStream2(m_ctx.get(), &out, &in, mode);
+        m_out->BackUp(chunkSize - static_cast<int>(out.pos));
+        if (ZSTD_isError(remaining))
+        {
+          return std::nullopt;
+        }
+        return remaining;
+      }
+    };
+
+    class ZstdSource final : public io::CopyingInputStream
+    {
+    public:
+      explicit ZstdSource(io::ZeroCopyInputStream *in) : m_in(in) {}
+
+      int Read(void *buffer, int size) override
+      {
+        ZSTD_outBuffer out{buffer, static_cast<size_t>(size), 0};
+        while (out.pos == 0)
+        {
+          if (m_chunk.pos == m_chunk.size)
+          {
+            void const *data = nullptr;
+            int dataSize = 0;
+            if (!m_in->Next(&data, &dataSize))
+            {
+              return 0;
+            }
+            m_chunk = ZSTD_inBuffer{data, static_cast<size_t>(dataSize), 0};
+          }
+          if (ZSTD_isError(
+                  ZSTD_decompressStream(m_ctx.get(), &out, &m_chunk)))
+          {
+            return -1;
+          }
+        }
+        return static_cast<int>(out.pos);
+      }
+
+    private:
+      io::ZeroCopyInputStream *m_in;
+      std::unique_ptr<ZSTD_DCtx, ZstdContextDeleter> m_ctx{ZSTD_createDCtx()};
+      ZSTD_inBuffer m_chunk{nullptr, 0, 0};
+    };
+#else
+    [[noreturn]] void ThrowNoZstd()
+    {
+      throw std::runtime_error(
+          "zstd tear sheets need epoch_folio built with EPOCH_FOLIO_WITH_ZSTD");
+    }
+#endif
+
+    void Serialize(epoch_proto::TearSheet const &output,
+                   io::ZeroCopyOutputStream *raw,
+                   TearSheetCompression compression)
+    {
+      bool ok = false;
+      if (compression == TearSheetCompression::Gzip)
+      {
+        io::GzipOutputStream::Options options;
+        options.format = io::GzipOutputStream::GZIP;
+        io::GzipOutputStream gzip{raw, options};
+        ok = output.SerializeToZeroCopyStream(&gzip) && gzip.Close();
+      }
+      else if (compression == TearSheetCompression::Zstd)
+      {
+#ifdef EPOCH_FOLIO_WITH_ZSTD
+        ZstdSink sink{raw};
+        io::CopyingOutputStreamAdaptor zstd{&sink};
+        ok = output.SerializeToZeroCopyStream(&zstd) && zstd.Flush() &&
+             sink.Finish();
+#else
+        ThrowNoZstd();
+#endif
+      }
+      else
+      {
+        ok = output.SerializeToZeroCopyStream(raw);
+      }
+      if (!ok)
+      {
+        throw std::runtime_error("Failed to serialize tear sheet");
+      }
+    }
+
+    void Parse(epoch_proto::TearSheet &output, io::ZeroCopyInputStream *raw,
+               TearSheetCompression compression)
+    {
+      bool ok = false;
+      if (compression == TearSheetCompression::Gzip)
+      {
+        io::GzipInputStream gzip{raw, io::GzipInputStream::GZIP};
+        ok = output.ParseFromZeroCopyStream(&gzip);
+      }
+      else if (compression == TearSheetCompression::Zstd)
+      {
+#ifdef EPOCH_FOLIO_WITH_ZSTD
+        ZstdSource source{raw};
+        io::CopyingInputStreamAdaptor zstd{&source};
+        ok = output.ParseFromZeroCopyStream(&zstd);
+#else
+        ThrowNoZstd();
+#endif
+      }
+      else
+      {
+        ok = output.ParseFromZeroCopyStream(raw);
+      }
+      if (!ok)
+      {
+        throw std::runtime_error("Failed to parse tear sheet");
+      }
+    }
+  } // namespace
+
+  void WriteTearSheet(epoch_proto::TearSheet const &output,
+                      std::string const &file_path,
+                      TearSheetCompression compression)
+  {
+    const int fd =
+        ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+      ThrowErrno("Failed to open file for writing:", file_path);
+    }
+    io::FileOutputStream file{fd};
+    file.SetCloseOnDelete(true);
+    Serialize(output, &file, compression);
+    if (!file.Close())
+    {
+      errno = file.GetErrno();
+      ThrowErrno("Failed to write", file_path);
+    }
+  }
+
+  void ReadTearSheet(std::string const &file_path,
+                     epoch_proto::TearSheet &output,
+                     TearSheetCompression compression)
+  {
+    const int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      ThrowErrno("Failed to open file for reading:", file_path);
+    }
+    io::FileInputStream file{fd};
+    file.SetCloseOnDelete(true);
+    Parse(output, &file, compression);
+  }
+
+  void WriteWidgetSeries(WidgetSeries const &series,
+                         std::string const &file_path)
+  {
+    auto const &data = series.data;
+    auto index = data.index()->as_chunked_array();
+    auto fields = data.table()->schema()->fields();
+    auto columns = data.table()->columns();
+    fields.insert(fields.begin(), arrow::field("index", index->type()));
+    columns.insert(columns.begin(), std::move(index));
+
+    auto metadata = arrow::key_value_metadata({"widget_id", "category"},
+                                              {series.id, series.category});
+    auto schema = arrow::schema(std::move(fields), std::move(metadata));
+    auto table = arrow::Table::Make(schema, columns, data.num_rows());
+
+    auto sink = epoch_frame::AssertResultIsOk(
+        arrow::io::FileOutputStream::Open(file_path));
+    auto writer = epoch_frame::AssertResultIsOk(
+        arrow::ipc::MakeFileWriter(sink, table->schema()));
+    ThrowIfNotOk(writer->WriteTable(*table));
+    ThrowIfNotOk(writer->Close());
+    ThrowIfNotOk(sink->Close());
+  }
+
+  arrow::TablePtr MapWidgetSeries(std::string const &file_path)
+  {
+    auto file = epoch_frame::AssertResultIsOk(arrow::io::MemoryMappedFile::Open(
+        file_path, arrow::io::FileMode::READ));
+    auto reader = epoch_frame::AssertResultIsOk(
+        arrow::ipc::RecordBatchFileReader::Open(file));
+
+    arrow::RecordBatchVector batches;
+    batches.reserve(reader->num_record_batches());
+    for (int i = 0; i < reader->num_record_batches(); ++i)
+    {
+      batches.push_back(
+          epoch_frame::AssertResultIsOk(reader->ReadRecordBatch(i)));
+    }
+    return epoch_frame::AssertResultIsOk(
+        arrow::Table::FromRecordBatches(reader->schema(), std::move(batches)));
+  }
+
+  TearSheetContainerWriter::TearSheetContainerWriter(
+      std::string const &file_path, TearSheetCompression compression)
+      : m_path(file_path), m_compression(compression)
+  {
+    m_fd = ::open(file_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+    {
+      ThrowErrno("Failed to open container", file_path);
+    }
+
+    struct stat info{};
+    ::fstat(m_fd, &info);
+    if (info.st_size == 0)
+    {
+      std::array<char, kHeaderSize> header{};
+      std::memcpy(header.data(), kMagic.data(), kMagic.size());
+      header[kMagic.size()] = static_cast<char>(kVersion);
+      header[kMagic.size() + 1] = static_cast<char>(compression);
+      if (!PwriteAll(m_fd, header.data(), header.size(), 0))
+      {
+        ::close(m_fd);
+        ThrowErrno("Failed to write container header", file_path);
+      }
+      m_end = kHeaderSize;
+      return;
+    }
+
+    try
+    {
+      // appends after the last complete record
+      TearSheetContainerReader existing{file_path};
+      if (existing.Compression() != compression)
+      {
+        throw std::runtime_error(std::format(
+            "{} was written with another compression", file_path));
+      }
+      m_end = kHeaderSize;
+      if (existing.size() > 0)
+      {
+        std::array<uint8_t, kLengthSize> length{};
+        if (!PreadAll(m_fd, length.data(), length.size(),
+                      existing.Offsets().back()))
+        {
+          ThrowErrno("Failed to read", file_path);
+        }
+        m_end = existing.Offsets().back() + kLengthSize + DecodeLength(length);
+      }
+      // drop a torn record now, a shorter record appended over it would
+      // leave its tail behind until Close
+      if (static_cast<uint64_t>(info.st_size) > m_end &&
+          ::ftruncate(m_fd, static_cast<off_t>(m_end)) != 0)
+      {
+        ThrowErrno("Failed to truncate", file_path);
+      }
+    }
+    catch (...)
+    {
+      ::close(m_fd);
+      throw;
+    }
+  }
+
+  TearSheetContainerWriter::~TearSheetContainerWriter()
+  {
+    try
+    {
+      Close();
+    }
+    catch (std::exception const &e)
+    {
+      SPDLOG_ERROR("Failed to close container {}: {}", m_path, e.what());
+    }
+  }
+
+  uint64_t
+  TearSheetContainerWriter::Append(epoch_proto::TearSheet const &output)
+  {
+    if (m_fd < 0)
+    {
+      throw std::runtime_error("Append on a closed tear sheet container");
+    }
+
+    const auto offset = m_end;
+    const auto payload = offset + kLengthSize;
+    // an unpatched length runs past the end of the file, so a torn record
+    // reads as a truncated one
+    std::array<uint8_t, kLengthSize> length{};
+    length.fill(0xFF);
+    if (!PwriteAll(m_fd, length.data(), length.size(), offset))
+    {
+      ThrowErrno("Failed to write", m_path);
+    }
+    if (::lseek(m_fd, static_cast<off_t>(payload), SEEK_SET) < 0)
+    {
+      ThrowErrno("Failed to seek in", m_path);
+    }
+
+    int64_t written = 0;
+    {
+      io::FileOutputStream file{m_fd};
+      Serialize(output, &file, m_compression);
+      if (!file.Flush())
+      {
+        errno = file.GetErrno();
+        ThrowErrno("Failed to write", m_path);
+      }
+      written = file.ByteCount();
+    }
+
+    EncodeLength(static_cast<uint64_t>(written), length);
+    if (!PwriteAll(m_fd, length.data(), length.size(), offset))
+    {
+      ThrowErrno("Failed to write", m_path);
+    }
+    m_end = payload + static_cast<uint64_t>(written);
+    return offset;
+  }
+
+  void TearSheetContainerWriter::Close()
+  {
+    if (m_fd < 0)
+    {
+      return;
+    }
+    // drop a torn record left behind by a failed Append
+    const bool ok = ::ftruncate(m_fd, static_cast<off_t>(m_end)) == 0;
+    ::close(m_fd);
+    m_fd = -1;
+    if (!ok)
+    {
+      ThrowErrno("Failed to truncate", m_path);
+    }
+  }
+
+  TearSheetContainerReader::TearSheetContainerReader(
+      std::string const &file_path)
+      : m_path(file_path)
+  {
+    m_fd = ::open(file_path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+      ThrowErrno("Failed to open container", file_path);
+    }
+
+    std::array<char, kHeaderSize> header{};
+    if (!PreadAll(m_fd, header.data(), header.size(), 0) ||
+        std::memcmp(header.data(), kMagic.data(), kMagic.size()) != 0 ||
+        header[kMagic.size()] != static_cast<char>(kVersion))
+    {
+      ::close(m_fd);
+      throw std::runtime_error(
+          std::format("{} is not a tear sheet container", file_path));
+    }
+    const auto compression = header[kMagic.size() + 1];
+    if (compression != static_cast<char>(TearSheetCompression::None) &&
+        compression != static_cast<char>(TearSheetCompression::Gzip) &&
+        compression != static_cast<char>(TearSheetCompression::Zstd))
+    {
+      ::close(m_fd);
+      throw std::runtime_error(std::format(
+          "{} has unknown compression {}", file_path,
+          static_cast<int>(static_cast<unsigned char>(compression))));
+    }
+    m_compression = static_cast<TearSheetCompression>(compression);
+
+    struct stat info{};
+    ::fstat(m_fd, &info);
+    const auto fileSize = static_cast<uint64_t>(info.st_size);
+
+    uint64_t offset = kHeaderSize;
+    std::array<uint8_t, kLengthSize> length{};
+    while (offset + kLengthSize <= fileSize &&
+           PreadAll(m_fd, length.data(), length.size(), offset))
+    {
+      const auto size = DecodeLength(length);
+      if (size > fileSize - offset - kLengthSize)
+      {
+        break;
+      }
+      m_offsets.push_back(offset);
+      offset += kLengthSize + size;
+    }
+  }
+
+  TearSheetContainerReader::~TearSheetContainerReader()
+  {
+    if (m_fd >= 0)
+    {
+      ::close(m_fd);
+    }
+  }
+
+  epoch_proto::TearSheet TearSheetContainerReader::Read(size_t i) const
+  {
+    epoch_proto::TearSheet output;
+    ReadAt(m_offsets.at(i), output);
+    return output;
+  }
+
+  void TearSheetContainerReader::ReadAt(uint64_t offset,
+                                        epoch_proto::TearSheet &output) const
+  {
+    std::array<uint8_t, kLengthSize> length{};
+    if (!PreadAll(m_fd, length.data(), length.size(), offset))
+    {
+      throw std::runtime_error(
+          std::format("{} has no record at offset {}", m_path, offset));
+    }
+    const auto begin = offset + kLengthSize;
+    PreadSource source{m_fd, begin, begin + DecodeLength(length)};
+    io::CopyingInputStreamAdaptor record{&source};
+    Parse(output, &record, m_compression);
+  }
+} // namespace epoch_folio
@@ -0,0 +1,70 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "epoch_folio/tearsheet.h"
+#include <catch.hpp>
+#include <map>
+
+using namespace epoch_folio;
+
+namespace {
+// serializes every cell through the scalar route, the previous behavior
+std::string ScalarJson(arrow::TablePtr const &table) {
+  std::vector<glz::generic> rows;
+  for (int64_t row = 0; row < table->num_rows(); ++row) {
+    glz::generic object;
+    for (int col = 0; col < table->num_columns(); ++col) {
+      auto scalar = table->column(col)->GetScalar(row).MoveValueUnsafe();
+      object[table->field(col)->name()] =
+          glz::to_json(epoch_frame::Scalar{scalar});
+    }
+    rows.emplace_back(std::move(object));
+  }
+  return glz::write_json(rows).value_or("");
+}
+
+// round trips through a generic value so number formatting does not matter
+std::string Canonical(std::string const &json) {
+  glz::generic value;
+  REQUIRE_FALSE(glz::read_json(value, json));
+  return glz::write_json(value).value_or("");
+}
+} // namespace
+
+TEST_CASE("Columnar JSON") {
+  arrow::DoubleBuilder doubles;
+  REQUIRE(doubles.AppendValues({1.5, -2.25}).ok());
+  REQUIRE(doubles.AppendNull().ok());
+  arrow::Int64Builder ints;
+  REQUIRE(ints.AppendValues({7, -3, 42}).ok());
+  arrow::BooleanBuilder bools;
+  REQUIRE(bools.AppendValues(std::vector<bool>{true, false, true}).ok());
+  arrow::StringBuilder strings;
+  REQUIRE(strings.AppendValues({"AAPL", "say \"hi\"\n", ""}).ok());
+  arrow::TimestampBuilder timestamps{
+      arrow::timestamp(arrow::TimeUnit::NANO, "UTC"),
+      arrow::default_memory_pool()};
+  REQUIRE(timestamps.AppendValues({1'600'000'000'000'000'000, 0}).ok());
+  REQUIRE(timestamps.AppendNull().ok());
+
+  auto schema = arrow::schema({arrow::field("pnl", arrow::float64()),
+                               arrow::field("count", arrow::int64()),
+                               arrow::field("long", arrow::boolean()),
+                               arrow::field("symbol", arrow::utf8()),
+                               arrow::field("open_dt", timestamps.type())});
+  auto table = arrow::Table::Make(
+      schema, {doubles.Finish().ValueOrDie(), ints.Finish().ValueOrDie(),
+               bools.Finish().ValueOrDie(), strings.Finish().ValueOrDie(),
+               timestamps.Finish().ValueOrDie()});
+
+  auto json = glz::write_json(table).value_or("");
+  REQUIRE(Canonical(json) == Canonical(ScalarJson(table)));
+
+  arrow::TablePtr empty;
+  REQUIRE(glz::write_json(empty).value_or("") == "[]");
+
+  // written in place, the bytes around the table must stay intact
+  std::map<std::string, arrow::TablePtr> nested{{"a", table}, {"b", empty}};
+  REQUIRE(Canonical(glz::write_json(nested).value_or("")) ==
+          Canonical("{\"a\":" + ScalarJson(table) + ",\"b\":[]}"));
+}
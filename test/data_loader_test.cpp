@@ -0,0 +1,118 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/series_helper.h"
+#include "epoch_folio/data_loader.h"
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <catch.hpp>
+#include <filesystem>
+#include <parquet/arrow/writer.h>
+
+using namespace epoch_folio;
+
+namespace {
+constexpr int64_t kDay = 86'400'000'000'000;
+
+// ten daily rows, time in milliseconds without a zone, written in chunks of
+// four rows (IPC batches and Parquet row groups)
+arrow::TablePtr MakeTable() {
+  arrow::TimestampBuilder time{arrow::timestamp(arrow::TimeUnit::MILLI),
+                               arrow::default_memory_pool()};
+  arrow::DoubleBuilder equity, other;
+  for (int64_t i = 0; i < 10; ++i) {
+    REQUIRE(time.Append(i * kDay / 1'000'000).ok());
+    REQUIRE(equity.Append(100.0 + static_cast<double>(i)).ok());
+    REQUIRE(other.Append(-1.0).ok());
+  }
+  auto schema = arrow::schema({arrow::field("t", time.type()),
+                               arrow::field("equity", arrow::float64()),
+                               arrow::field("other", arrow::float64())});
+  return arrow::Table::Make(schema, {time.Finish().ValueOrDie(),
+                                     equity.Finish().ValueOrDie(),
+                                     other.Finish().ValueOrDie()});
+}
+
+void WriteIpc(arrow::TablePtr const &table, std::string const &path) {
+  auto sink = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+  auto writer = arrow::ipc::MakeFileWriter(sink, table->schema()).ValueOrDie();
+  REQUIRE(writer->WriteTable(*table, 4).ok());
+  REQUIRE(writer->Close().ok());
+}
+
+void WriteParquet(arrow::TablePtr const &table, std::string const &path) {
+  auto sink = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+  REQUIRE(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), sink,
+                                     4)
+              .ok());
+  REQUIRE(sink->Close().ok());
+}
+} // namespace
+
+TEST_CASE("Data Loader") {
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto table = MakeTable();
+  const auto ipc = (dir / "epoch_folio_loader.arrow").string();
+  const auto parquet = (dir / "epoch_folio_loader.parquet").string();
+  WriteIpc(table, ipc);
+  WriteParquet(table, parquet);
+
+  for (auto const &path : {ipc, parquet}) {
+    DYNAMIC_SECTION(path) {
+      TableSource source{.path = path,
+                         .timeColumn = "t",
+                         .columns = {"equity"},
+                         .rename = {{"equity", "value"}}};
+
+      SECTION("Projection and time range") {
+        // [day 3, day 7) skips the first chunk entirely
+        auto frame = LoadTable(source, 3 * kDay, 7 * kDay);
+        REQUIRE(frame.column_names() == std::vector<std::string>{"value"});
+
+        auto index = ToTimestampVector(frame.index());
+        REQUIRE(index == std::vector<int64_t>{3 * kDay, 4 * kDay, 5 * kDay,
+                                              6 * kDay});
+        REQUIRE(frame.index()->dtype()->Equals(
+            arrow::timestamp(arrow::TimeUnit::NANO, "UTC")));
+        REQUIRE(ToDoubleVector(frame["value"]) ==
+                std::vector<double>{103, 104, 105, 106});
+      }
+
+      SECTION("Tear sheet inputs") {
+        auto data = LoadTearSheetData(
+            {.equity = source, .benchmark = source, .start = 8 * kDay});
+        REQUIRE(data.equity.size() == 2);
+        REQUIRE(data.benchmark->size() == 2);
+        REQUIRE(data.positions.empty());
+
+        source.columns.clear();
+        REQUIRE_THROWS(LoadTearSheetData({.equity = source}));
+      }
+    }
+  }
+
+  SECTION("Parquet with a nested column") {
+    // the struct's two leaves come before the time column's
+    auto flat = MakeTable();
+    auto nested = arrow::StructArray::Make(
+                      {flat->column(1)->chunk(0), flat->column(2)->chunk(0)},
+                      std::vector<std::string>{"a", "b"})
+                      .ValueOrDie();
+    auto withStruct =
+        flat->AddColumn(0, arrow::field("s", nested->type()),
+                        std::make_shared<arrow::ChunkedArray>(nested))
+            .ValueOrDie();
+    const auto path = (dir / "epoch_folio_nested.parquet").string();
+    WriteParquet(withStruct, path);
+
+    TableSource source{.path = path, .timeColumn = "t", .columns = {"equity"}};
+    auto frame = LoadTable(source, 3 * kDay, 7 * kDay);
+    REQUIRE(ToTimestampVector(frame.index()) ==
+            std::vector<int64_t>{3 * kDay, 4 * kDay, 5 * kDay, 6 * kDay});
+    REQUIRE(ToDoubleVector(frame["equity"]) ==
+            std::vector<double>{103, 104, 105, 106});
+
+    source.columns = {"s"};
+    REQUIRE_THROWS_AS(LoadTable(source), std::runtime_error);
+  }
+}
@@ -0,0 +1,60 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/downsample.h"
+#include "common/series_helper.h"
+#include <catch.hpp>
+#include <cmath>
+#include <epoch_frame/factory/date_offset_factory.h>
+#include <epoch_frame/factory/index_factory.h>
+#include <epoch_frame/factory/scalar_factory.h>
+#include <epoch_frame/factory/series_factory.h>
+#include <numeric>
+
+using namespace epoch_folio;
+using namespace epoch_frame;
+using namespace epoch_frame::factory::index;
+using namespace epoch_frame::factory::scalar;
+
+TEST_CASE("Downsample") {
+  SECTION("LTTB keeps the endpoints and the spike") {
+    std::vector<double> x(100), y(100, 0.0);
+    std::iota(x.begin(), x.end(), 0.0);
+    y[37] = 5.0;
+
+    auto picked = Lttb(x, y, 10);
+    REQUIRE(picked.size() == 10);
+    REQUIRE(picked.front() == 0);
+    REQUIRE(picked.back() == 99);
+    REQUIRE(std::ranges::is_sorted(picked));
+    REQUIRE(std::ranges::contains(picked, size_t{37}));
+
+    REQUIRE(Lttb(x, y, 200).size() == 100);
+  }
+
+  SECTION("Series keeps extrema and requested timestamps") {
+    const auto index =
+        date_range({.start = "2020-01-01"_date,
+                    .periods = 500,
+                    .offset = factory::offset::days(1)});
+    std::vector<double> values(500);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = std::sin(static_cast<double>(i) / 20.0);
+    }
+    values[123] = -3.0;
+    values[321] = 4.0;
+    const auto series = make_series(index, values);
+    const auto keep = ToTimestampVector(index);
+    const std::vector<int64_t> keepTimestamps{keep[250]};
+
+    const auto result = Downsample(series, 50, keepTimestamps);
+    REQUIRE(result.size() < series.size());
+    REQUIRE(result.size() >= 50);
+    REQUIRE(result.min().as_double() == -3.0);
+    REQUIRE(result.max().as_double() == 4.0);
+    REQUIRE(std::ranges::contains(ToTimestampVector(result.index()),
+                                  keep[250]));
+
+    REQUIRE(Downsample(series, 0).size() == series.size());
+  }
+}
@@ -0,0 +1,95 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "epoch_folio/ireport.h"
+#include <arrow/builder.h>
+#include <atomic>
+#include <catch.hpp>
+#include <epoch_frame/factory/dataframe_factory.h>
+#include <epoch_frame/factory/index_factory.h>
+#include <thread>
+
+using namespace epoch_folio;
+
+namespace {
+// one table per input row, so every tear sheet names the frame it came from
+class StubReporter final : public IReporter {
+public:
+  using IReporter::IReporter;
+
+protected:
+  epoch_proto::TearSheet
+  generateTearsheet(epoch_frame::DataFrame const &normalizedDf) const override {
+    epoch_proto::TearSheet sheet;
+    for (size_t i = 0; i < normalizedDf.num_rows(); ++i) {
+      sheet.mutable_tables()->add_tables();
+    }
+    return sheet;
+  }
+};
+
+epoch_metadata::transform::TransformConfiguration MakeConfig() {
+  epoch_metadata::transforms::TransformsMetaData metadata;
+  metadata.id = "stub_report";
+  metadata.isReporter = true;
+
+  epoch_metadata::TransformDefinitionData data;
+  data.type = "stub_report";
+  data.id = "stub";
+  data.inputs = {{"returns", {"src#returns"}}};
+  data.metaData = metadata;
+  return epoch_metadata::transform::TransformConfiguration{
+      epoch_metadata::TransformDefinition{data}};
+}
+
+epoch_frame::DataFrame MakeFrame(int64_t rows) {
+  arrow::DoubleBuilder builder;
+  for (int64_t i = 0; i < rows; ++i) {
+    REQUIRE(builder.Append(static_cast<double>(i)).ok());
+  }
+  auto values =
+      std::make_shared<arrow::ChunkedArray>(builder.Finish().ValueOrDie());
+  return epoch_frame::make_dataframe(
+      epoch_frame::factory::index::from_range(rows), {values},
+      {"src#returns"});
+}
+} // namespace
+
+TEST_CASE("Reporter") {
+  const StubReporter reporter{MakeConfig()};
+
+  SECTION("Columns are renamed to their input ids") {
+    auto [data, tearsheet] = reporter.Report(MakeFrame(3));
+    REQUIRE(data.column_names() == std::vector<std::string>{"returns"});
+    REQUIRE(tearsheet->tables().tables_size() == 3);
+  }
+
+  SECTION("Concurrent executions keep their own tear sheets") {
+    constexpr int kThreads = 8;
+    constexpr int kRuns = 25;
+    std::vector<epoch_frame::DataFrame> frames;
+    for (int i = 0; i < kThreads; ++i) {
+      frames.push_back(MakeFrame(i + 1));
+    }
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+      threads.emplace_back([&, i] {
+        for (int run = 0; run < kRuns; ++run) {
+          // TransformData publishes a result of its own on the same instance
+          (void)reporter.TransformData(frames[(i + run) % kThreads]);
+          auto output = reporter.Report(frames[i]);
+          if (output.tearsheet->tables().tables_size() != i + 1 ||
+              output.data.num_rows() != static_cast<size_t>(i + 1)) {
+            ++mismatches;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    REQUIRE(mismatches == 0);
+  }
+}
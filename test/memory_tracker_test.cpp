@@ -0,0 +1,80 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/memory_tracker.h"
+#include <arrow/buffer.h>
+#include <catch.hpp>
+
+using namespace epoch_folio;
+
+namespace {
+std::shared_ptr<arrow::Buffer> Allocate(int64_t bytes) {
+  return arrow::AllocateBuffer(bytes, CurrentMemoryPool()).ValueOrDie();
+}
+} // namespace
+
+TEST_CASE("Tracking Memory Pool") {
+  TrackingMemoryPool pool;
+
+  SECTION("Scopes are no-ops until a pool is installed") {
+    REQUIRE(CurrentMemoryPool() == arrow::default_memory_pool());
+    {
+      MemoryScope scope{"ignored"};
+      Allocate(1024);
+    }
+    REQUIRE(pool.Report().empty());
+    REQUIRE(pool.num_allocations() == 0);
+  }
+
+  SECTION("Peaks and totals are attributed to the innermost scope") {
+    {
+      InstallMemoryPool installed{pool};
+      REQUIRE(CurrentMemoryPool() == &pool);
+      TrackingMemoryPool other;
+      REQUIRE_THROWS(InstallMemoryPool{other});
+      {
+        // the same pool nests
+        InstallMemoryPool again{pool};
+      }
+      REQUIRE(CurrentMemoryPool() == &pool);
+
+      MemoryScope outer{"outer", "total"};
+      for (int i = 0; i < 2; ++i) {
+        MemoryScope widget{"widget", "Positions"};
+        auto first = Allocate(1 << 20);
+        auto second = Allocate(1 << 20);
+      }
+      auto retained = Allocate(1 << 10);
+    }
+    REQUIRE(CurrentMemoryPool() == arrow::default_memory_pool());
+    REQUIRE(pool.bytes_allocated() == 0);
+    REQUIRE(pool.max_memory() >= 2 << 20);
+    REQUIRE(pool.num_allocations() == 5);
+
+    const auto report = pool.Report();
+    REQUIRE(report.size() == 2);
+    auto const &outer = report[0].scope == "outer" ? report[0] : report[1];
+    auto const &widget = report[0].scope == "widget" ? report[0] : report[1];
+    REQUIRE(widget.category == "Positions");
+    REQUIRE(widget.invocations == 2);
+    REQUIRE(widget.sampledPeakBytes >= 2 << 20);
+    REQUIRE(widget.totalBytes >= 4 << 20);
+    REQUIRE(outer.sampledPeakBytes >= widget.sampledPeakBytes);
+    REQUIRE(outer.totalBytes >= widget.totalBytes + (1 << 10));
+  }
+
+  SECTION("Peaks between samples are missed") {
+    {
+      InstallMemoryPool installed{pool};
+      MemoryScope scope{"kernel"};
+      // a temporary of the default pool, freed before the scope ends
+      arrow::AllocateBuffer(8 << 20, arrow::default_memory_pool())
+          .ValueOrDie()
+          .reset();
+    }
+    const auto report = pool.Report();
+    REQUIRE(report.size() == 1);
+    REQUIRE(report[0].totalBytes >= 8 << 20);
+    REQUIRE(report[0].sampledPeakBytes < 8 << 20);
+  }
+}
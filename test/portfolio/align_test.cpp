@@ -0,0 +1,76 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/series_helper.h"
+#include "portfolio/align.h"
+#include <epoch_core/catch_defs.h>
+#include <epoch_frame/factory/date_offset_factory.h>
+#include <epoch_frame/factory/index_factory.h>
+#include <epoch_frame/factory/scalar_factory.h>
+#include <epoch_frame/factory/series_factory.h>
+
+using namespace epoch_folio;
+using namespace epoch_frame;
+using namespace epoch_frame::factory::index;
+using namespace epoch_frame::factory::scalar;
+using epoch_core::AlignFill;
+
+TEST_CASE("Merge Align") {
+  // strategy every step, benchmark every other step and starting later
+  const std::vector<std::vector<int64_t>> indexes{{1, 2, 3, 4, 5, 6},
+                                                  {2, 4, 6}};
+
+  SECTION("ForwardFill") {
+    auto aligned = MergeAlign(indexes, AlignFill::ForwardFill);
+    REQUIRE(aligned.timestamps == std::vector<int64_t>{2, 3, 4, 5, 6});
+    REQUIRE(aligned.rows[0] == std::vector<int64_t>{1, 2, 3, 4, 5});
+    REQUIRE(aligned.rows[1] == std::vector<int64_t>{0, 0, 1, 1, 2});
+  }
+
+  SECTION("Zero") {
+    auto aligned = MergeAlign(indexes, AlignFill::Zero);
+    REQUIRE(aligned.timestamps == std::vector<int64_t>{2, 3, 4, 5, 6});
+    REQUIRE(aligned.rows[1] ==
+            std::vector<int64_t>{0, kNoMatch, 1, kNoMatch, 2});
+  }
+
+  SECTION("Intersect") {
+    auto aligned = MergeAlign(indexes, AlignFill::Intersect);
+    REQUIRE(aligned.timestamps == std::vector<int64_t>{2, 4, 6});
+    REQUIRE(aligned.rows[0] == std::vector<int64_t>{1, 3, 5});
+    REQUIRE(aligned.rows[1] == std::vector<int64_t>{0, 1, 2});
+  }
+
+  SECTION("Empty input") {
+    auto aligned =
+        MergeAlign(std::vector<std::vector<int64_t>>{{1, 2}, {}},
+                   AlignFill::ForwardFill);
+    REQUIRE(aligned.timestamps.empty());
+  }
+}
+
+TEST_CASE("Align Returns") {
+  auto daily = date_range({.start = "2015-01-01"_date,
+                           .periods = 6,
+                           .offset = factory::offset::days(1)});
+  auto everyOther = date_range({.start = "2015-01-02"_date,
+                                .periods = 3,
+                                .offset = factory::offset::days(2)});
+  auto strategy =
+      make_series(daily, std::vector<double>{0.1, 0.2, 0.3, 0.4, 0.5, 0.6});
+  auto benchmark = make_series(everyOther, std::vector<double>{1, 2, 3});
+
+  auto forward = AlignReturns({strategy, benchmark}, AlignFill::ForwardFill);
+  REQUIRE(forward.size() == 2);
+  REQUIRE(forward[0].index()->equals(forward[1].index()));
+  REQUIRE(ToDoubleVector(forward[0]) ==
+          std::vector<double>{0.2, 0.3, 0.4, 0.5, 0.6});
+  REQUIRE(ToDoubleVector(forward[1]) == std::vector<double>{1, 1, 2, 2, 3});
+
+  auto zero = AlignReturns({strategy, benchmark}, AlignFill::Zero);
+  REQUIRE(ToDoubleVector(zero[1]) == std::vector<double>{1, 0, 2, 0, 3});
+
+  auto intersect = AlignReturns({strategy, benchmark}, AlignFill::Intersect);
+  REQUIRE(ToDoubleVector(intersect[0]) == std::vector<double>{0.2, 0.4, 0.6});
+  REQUIRE(intersect[0].index()->equals(everyOther));
+}
@@ -171,6 +171,51 @@ TEST_CASE("Position Test") {
             }
         }
     }
+
+    SECTION("Test Get Exposures Across Levels") {
+        auto index = date_range({.start="2015-01-01"_date, .periods=2, .offset=offset::days(1)});
+        auto positions = make_dataframe(index,
+            std::vector{
+                std::vector<double>{10.0, 5.0},
+                std::vector<double>{-4.0, 2.0},
+                std::vector<double>{3.0, -6.0},
+                std::vector<double>{1.0, 1.0}
+            },
+            std::vector<std::string>{"AAPL", "MSFT", "BMW", "XYZ"});
+
+        AssetClassification classification{
+            {"AAPL", "MSFT", "BMW"},
+            {
+                ClassificationLevel{"sector", "Sector", {"Autos", "Tech"}, {1, 1, 0}},
+                ClassificationLevel{"country", "Country", {"DE", "US"}, {1, 1, 0}},
+                ClassificationLevel{"ticker", "Ticker", {"AAPL", "BMW", "MSFT"}, {0, 2, kUnclassified}}
+            }};
+
+        auto exposures = GetExposures(positions, classification);
+        REQUIRE(exposures.size() == 3);
+
+        auto const &sector = exposures[0];
+        REQUIRE(sector.id == "sector");
+        auto expect = [&](std::vector<std::vector<double>> const &data, std::vector<std::string> const &columns) {
+            return make_dataframe(index, data, columns);
+        };
+
+        auto sectorColumns = std::vector<std::string>{"Autos", "Tech"};
+        INFO(sector.net);
+        REQUIRE(sector.net.equals(expect({{3.0, -6.0}, {6.0, 7.0}}, sectorColumns)));
+        REQUIRE(sector.gross.equals(expect({{3.0, 6.0}, {14.0, 7.0}}, sectorColumns)));
+        REQUIRE(sector.longs.equals(expect({{3.0, 0.0}, {10.0, 7.0}}, sectorColumns)));
+        REQUIRE(sector.shorts.equals(expect({{0.0, -6.0}, {-4.0, 0.0}}, sectorColumns)));
+
+        REQUIRE(exposures[1].net.equals(expect({{3.0, -6.0}, {6.0, 7.0}}, {"DE", "US"})));
+
+        // labels without a classified column are dropped
+        REQUIRE(exposures[2].net.equals(expect({{10.0, 5.0}, {-4.0, 2.0}}, {"AAPL", "MSFT"})));
+
+        // codes must index the level's labels
+        classification.levels[2].codes = {0, 3, kUnclassified};
+        REQUIRE_THROWS_AS(GetExposures(positions, classification), std::runtime_error);
+    }
     
     SECTION("Test Get Top Long Short Abs") {
         // Create test data with mix of long and short positions
@@ -0,0 +1,180 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/asof_join.h"
+#include "common/series_helper.h"
+#include "portfolio/round_trip.h"
+#include <epoch_core/catch_defs.h>
+#include <epoch_frame/factory/dataframe_factory.h>
+#include <epoch_frame/factory/date_offset_factory.h>
+#include <epoch_frame/factory/index_factory.h>
+#include <epoch_frame/factory/scalar_factory.h>
+#include <epoch_frame/factory/series_factory.h>
+#include <limits>
+
+using namespace epoch_folio;
+using namespace epoch_frame;
+using namespace epoch_frame::factory::index;
+using namespace epoch_frame::factory::scalar;
+
+TEST_CASE("Round Trips From Transactions") {
+  auto dates = date_range({.start = "2015-01-01"_date,
+                           .periods = 7,
+                           .offset = factory::offset::days(1)});
+  auto index = factory::index::from_range(dates->size());
+
+  // A: buy 10@100, buy 10@110, sell 15@120, sell 10@100 (flips short 5),
+  // buy 5@90 covers. B: a single long trip interleaved with A.
+  auto transactions = make_dataframe(
+      index,
+      std::vector{
+          dates->array().as_chunked_array(),
+          factory::array::make_array(
+              std::vector<std::string>{"A", "A", "B", "A", "A", "B", "A"}),
+          factory::array::make_array(
+              std::vector<double>{10, 10, 4, -15, -10, -4, 5}),
+          factory::array::make_array(
+              std::vector<double>{100, 110, 50, 120, 100, 55, 90})},
+      {"timestamp", "symbol", "amount", "price"});
+  transactions = transactions.set_index("timestamp");
+
+  const auto fills = ToTimestampVector(transactions.index());
+
+  struct Expected {
+    epoch_core::RoundTripMatching matching;
+    std::vector<double> pnl;
+    std::vector<int64_t> openRow;
+  };
+
+  // one round trip per closing fill (rows 3, 4, 5 and 6), in close order
+  std::vector<Expected> cases{
+      {epoch_core::RoundTripMatching::FIFO, {250, -50, 20, 50}, {0, 1, 2, 4}},
+      {epoch_core::RoundTripMatching::LIFO, {200, 0, 20, 50}, {0, 0, 2, 4}},
+      {epoch_core::RoundTripMatching::AverageCost, {225, -25, 20, 50}, {0, 0, 2, 4}},
+  };
+
+  for (auto const &[matching, pnl, openRow] : cases) {
+    DYNAMIC_SECTION(epoch_core::RoundTripMatchingWrapper::ToString(matching)) {
+      auto result = ExtractRoundTripsFromTransactions(transactions, matching);
+      INFO(result);
+      REQUIRE(result.num_rows() == 4);
+
+      REQUIRE(ToDoubleVector(result["net_return"]) == pnl);
+
+      auto open = ToTimestampVector(result["open_datetime"].array());
+      auto close = ToTimestampVector(result["close_datetime"].array());
+      REQUIRE(close == std::vector{fills[3], fills[4], fills[5], fills[6]});
+      for (size_t i = 0; i < openRow.size(); ++i) {
+        REQUIRE(open[i] == fills[openRow[i]]);
+      }
+
+      REQUIRE(result["asset"].iloc(2) == "B"_scalar);
+      REQUIRE(result["side"].iloc(1) == "Long"_scalar);
+      REQUIRE(result["side"].iloc(3) == "Short"_scalar);
+    }
+  }
+}
+
+TEST_CASE("Aggregate Round Trips") {
+  auto index = factory::index::from_range(5);
+  auto column = [&](std::vector<double> const &values) {
+    return make_series(index, values, "").array();
+  };
+  auto is_long = make_series(index, std::vector<double>{1, 1, 0, 0, 1}, "") ==
+                 1.0_scalar;
+
+  auto round_trip = make_dataframe(
+      index,
+      std::vector{column({10, -5, 0, 20, -15}),
+                  column({0.1, -0.05, 0, 0.2, -0.15}), column({1, 2, 3, 4, 5}),
+                  is_long.array()},
+      {"pnl", "returns", "duration", "long"});
+
+  auto [all, longs, shorts] = AggregateRoundTrips(round_trip);
+
+  REQUIRE(all.pnl.rows == 5);
+  REQUIRE(all.pnl.all.Sum() == 10.0);
+  REQUIRE(all.pnl.winning.count == 2);
+  REQUIRE(all.pnl.losing.Sum() == -20.0);
+  REQUIRE(all.pnl.even == 1);
+  REQUIRE(all.returns.all.Median() == 0.0);
+  REQUIRE(*all.returns.winning.Median() == Catch::Approx(0.15));
+  REQUIRE(all.duration.all.Median() == 3.0);
+
+  REQUIRE(longs.pnl.rows == 3);
+  REQUIRE(longs.pnl.winning.Max() == 10.0);
+  REQUIRE(longs.pnl.losing.Mean() == -10.0);
+  REQUIRE(longs.returns.all.Median() == -0.05);
+
+  REQUIRE(shorts.pnl.even == 1);
+  REQUIRE(shorts.pnl.all.Max() == 20.0);
+  REQUIRE_FALSE(shorts.pnl.losing.Mean().has_value());
+  REQUIRE(shorts.duration.all.Median() == 3.5);
+}
+
+TEST_CASE("Symbols Table") {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  // means: A 0.3, B 0.1, C -0.2, D -0.05, E none, F 0.02; rows interleaved
+  // so the segmented pass has to gather each symbol
+  std::vector<std::string> symbols{"C", "A", "E", "B", "D", "F",
+                                   "A", "C", "E", "B", "D", "F"};
+  std::vector<double> returns{-0.3, 0.4, nan, 0.1, -0.05, 0.01,
+                              0.2,  -0.1, nan, 0.1, -0.05, 0.03};
+  auto round_trip = make_dataframe(
+      factory::index::from_range(symbols.size()),
+      std::vector{factory::array::make_array(returns),
+                  factory::array::make_array(symbols)},
+      {"returns", "symbol"});
+
+  auto columnIds = [](epoch_proto::Table const &table) {
+    std::vector<std::string> ids;
+    for (auto const &column : table.columns()) {
+      ids.push_back(column.id());
+    }
+    return ids;
+  };
+
+  SECTION("Every symbol in name order") {
+    for (size_t topK : {0, 3}) {
+      auto table = GetSymbolsTable(round_trip, topK);
+      REQUIRE(columnIds(table) == std::vector<std::string>{
+                                      "key", "A", "B", "C", "D", "E", "F"});
+      REQUIRE(table.title() == "Returns by Symbol");
+    }
+  }
+
+  SECTION("Best then worst by mean, symbols without returns left out") {
+    auto table = GetSymbolsTable(round_trip, 2);
+    REQUIRE(columnIds(table) ==
+            std::vector<std::string>{"key", "A", "B", "D", "C"});
+    REQUIRE(table.title() == "Returns by Symbol (top and bottom 2 of 6)");
+  }
+
+  SECTION("Fewer valid symbols than slots keeps all of them") {
+    auto few = make_dataframe(
+        factory::index::from_range(3),
+        std::vector{factory::array::make_array(
+                        std::vector<double>{0.1, nan, -0.1}),
+                    factory::array::make_array(
+                        std::vector<std::string>{"A", "B", "C"})},
+        {"returns", "symbol"});
+    REQUIRE(columnIds(GetSymbolsTable(few, 1)) ==
+            std::vector<std::string>{"key", "A", "C"});
+  }
+}
+
+TEST_CASE("As Of Join Backward") {
+  // several intraday values per "day", closes land between and on them
+  std::vector<int64_t> values{10, 20, 20, 30, 100};
+  std::vector<int64_t> closes{5, 10, 15, 20, 29, 90, 200};
+
+  REQUIRE(AsOfJoinBackward(closes, values) ==
+          std::vector<int64_t>{kNoMatch, 0, 0, 2, 2, 3, 4});
+
+  REQUIRE(AsOfJoinBackward(closes, values, 5) ==
+          std::vector<int64_t>{kNoMatch, 0, 0, 2, kNoMatch, kNoMatch,
+                               kNoMatch});
+
+  REQUIRE(AsOfJoinBackward(closes, {}) ==
+          std::vector<int64_t>(closes.size(), kNoMatch));
+}
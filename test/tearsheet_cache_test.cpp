@@ -0,0 +1,116 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/content_hash.h"
+#include "epoch_folio/tearsheet_cache.h"
+#include <catch.hpp>
+#include <chrono>
+#include <epoch_frame/factory/dataframe_factory.h>
+#include <epoch_frame/factory/index_factory.h>
+#include <filesystem>
+#include <thread>
+
+using namespace epoch_folio;
+
+namespace {
+std::shared_ptr<arrow::Array> MakeDoubles(std::vector<double> const &values) {
+  arrow::DoubleBuilder builder;
+  REQUIRE(builder.AppendValues(values).ok());
+  return builder.Finish().ValueOrDie();
+}
+
+std::string Hash(arrow::Array const &array) {
+  ContentHash hash;
+  hash.Update(*array.data());
+  return hash.Hex();
+}
+
+epoch_proto::TearSheet MakeSheet(int tables) {
+  epoch_proto::TearSheet sheet;
+  for (int i = 0; i < tables; ++i) {
+    sheet.mutable_tables()->add_tables();
+  }
+  return sheet;
+}
+} // namespace
+
+TEST_CASE("Content Hash") {
+  const auto full = MakeDoubles({1, 2, 3, 4, 5, 6});
+  const auto copy = MakeDoubles({3, 4, 5});
+
+  REQUIRE(Hash(*full->Slice(2, 3)) == Hash(*copy));
+  REQUIRE(Hash(*full->Slice(1, 3)) != Hash(*copy));
+  REQUIRE(Hash(*full) != Hash(*MakeDoubles({1, 2, 3, 4, 5, 7})));
+  REQUIRE(Hash(*full).size() == 32);
+
+  // byte boundaries do not matter, lengths do
+  ContentHash split, whole;
+  split.Update("abc", 3);
+  split.Update("defghijkl", 9);
+  whole.Update("abcdefghijkl", 12);
+  REQUIRE(split.Hex() == whole.Hex());
+  REQUIRE(HashKey("ab") != HashKey("abc"));
+}
+
+TEST_CASE("Tear Sheet Disk Cache") {
+  const auto dir =
+      std::filesystem::temp_directory_path() / "epoch_folio_disk_cache";
+  std::filesystem::remove_all(dir);
+
+  {
+    TearSheetDiskCache cache{dir.string()};
+    epoch_proto::TearSheet read;
+    REQUIRE_FALSE(cache.Get("a", read));
+
+    cache.Put("a", MakeSheet(3));
+    REQUIRE(cache.Get("a", read));
+    REQUIRE(read.tables().tables_size() == 3);
+
+    cache.Put("empty", epoch_proto::TearSheet{});
+    REQUIRE(cache.Get("empty", read));
+    REQUIRE(read.tables().tables_size() == 0);
+  }
+
+  SECTION("Frames are stored next to tear sheets") {
+    TearSheetDiskCache cache{dir.string()};
+    REQUIRE_FALSE(cache.GetFrame("frame"));
+
+    auto values = std::make_shared<arrow::ChunkedArray>(MakeDoubles({1, 2, 3}));
+    auto frame = epoch_frame::make_dataframe(
+        epoch_frame::factory::index::from_range(3), {values}, {"value"});
+    cache.PutFrame("frame", frame);
+    auto read = cache.GetFrame("frame");
+    REQUIRE(read);
+    REQUIRE(read->equals(frame));
+
+    // one key space, but a tear sheet entry is not a frame
+    epoch_proto::TearSheet sheet;
+    REQUIRE_FALSE(cache.Get("frame", sheet));
+    REQUIRE_FALSE(cache.GetFrame("a"));
+  }
+
+  SECTION("Least recently used entries are evicted") {
+    std::filesystem::remove_all(dir);
+    uint64_t entryBytes = 0;
+    {
+      TearSheetDiskCache cache{dir.string()};
+      for (auto key : {"a", "b", "c"}) {
+        cache.Put(key, MakeSheet(50));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+      entryBytes = cache.SizeBytes() / 3;
+      epoch_proto::TearSheet read;
+      // reading marks "a" as used, "b" is now the oldest
+      REQUIRE(cache.Get("a", read));
+    }
+
+    TearSheetDiskCache cache{dir.string(), entryBytes * 3 - 1};
+    REQUIRE(cache.SizeBytes() == entryBytes * 2);
+    epoch_proto::TearSheet read;
+    REQUIRE(cache.Get("a", read));
+    REQUIRE_FALSE(cache.Get("b", read));
+    REQUIRE(cache.Get("c", read));
+  }
+
+  std::filesystem::remove_all(dir);
+}
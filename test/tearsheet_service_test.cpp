@@ -0,0 +1,127 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "epoch_folio/tearsheet_service.h"
+#include <atomic>
+#include <catch.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace epoch_folio;
+
+namespace {
+TearSheetRequest MakeRequest(std::string const &path, uint8_t topK = 10) {
+  TearSheetRequest request;
+  request.sources.equity = TableSource{.path = path, .columns = {"equity"}};
+  request.options.topKPositions = topK;
+  return request;
+}
+} // namespace
+
+TEST_CASE("Tear Sheet Service") {
+  const auto path = (std::filesystem::temp_directory_path() /
+                     "epoch_folio_service.arrow")
+                        .string();
+  std::ofstream{path} << "placeholder";
+
+  std::atomic<int> builds{0};
+  std::atomic<bool> release{false};
+  auto builder = [&](TearSheetRequest const &) {
+    ++builds;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return epoch_proto::TearSheet{};
+  };
+
+  SECTION("Identical requests share one build") {
+    TearSheetService service{{.cacheEntries = 4, .workers = 2}, builder};
+    auto first = service.Build(MakeRequest(path));
+    auto second = service.Build(MakeRequest(path));
+    release = true;
+    REQUIRE(first.get() == second.get());
+    REQUIRE(builds == 1);
+
+    // served from the cache once done
+    REQUIRE(service.Build(MakeRequest(path)).get() == first.get());
+    REQUIRE(builds == 1);
+    REQUIRE(service.CacheSize() == 1);
+  }
+
+  SECTION("Options and inputs are part of the key") {
+    const auto key = TearSheetService::Key(MakeRequest(path));
+    REQUIRE(TearSheetService::Key(MakeRequest(path, 5)) != key);
+
+    std::ofstream{path, std::ios::app} << "more";
+    REQUIRE(TearSheetService::Key(MakeRequest(path)) != key);
+  }
+
+  SECTION("Least recently used entries are evicted") {
+    release = true;
+    TearSheetService service{{.cacheEntries = 2, .workers = 1}, builder};
+    service.Build(MakeRequest(path, 1)).get();
+    service.Build(MakeRequest(path, 2)).get();
+    service.Build(MakeRequest(path, 1)).get();
+    service.Build(MakeRequest(path, 3)).get();
+    REQUIRE(service.CacheSize() == 2);
+    REQUIRE(builds == 3);
+
+    service.Build(MakeRequest(path, 1)).get();
+    REQUIRE(builds == 3);
+    service.Build(MakeRequest(path, 2)).get();
+    REQUIRE(builds == 4);
+  }
+
+  SECTION("Pending builds are bounded") {
+    TearSheetService service{{.workers = 1, .maxPending = 1}, builder};
+    auto pending = service.Build(MakeRequest(path, 1));
+    REQUIRE_THROWS_AS(service.Build(MakeRequest(path, 2)), ServiceBusy);
+    release = true;
+    pending.get();
+  }
+
+  SECTION("Submitted requests are fetched by id") {
+    release = true;
+    TearSheetService service{{}, builder};
+    const auto id = service.Submit(MakeRequest(path));
+    REQUIRE_FALSE(service.Fetch("unknown"));
+    auto whole = service.Fetch(id);
+    REQUIRE(whole);
+    whole->get();
+    // a widget is a separate, narrower build
+    service.Fetch(id, "cumReturns")->get();
+    REQUIRE(builds == 2);
+  }
+
+  SECTION("A failed build keeps its error") {
+    std::atomic<int> failures{0};
+    auto failing = [&](TearSheetRequest const &) -> epoch_proto::TearSheet {
+      ++failures;
+      throw std::runtime_error("missing equity column");
+    };
+
+    TearSheetService service{{.workers = 1}, failing};
+    const auto id = service.Submit(MakeRequest(path));
+    auto first = service.Fetch(id);
+    REQUIRE(first);
+    REQUIRE_THROWS_WITH(first->get(), "missing equity column");
+
+    // polling answers with the error instead of building again
+    auto again = service.Fetch(id);
+    REQUIRE(again->wait_for(std::chrono::seconds{0}) ==
+            std::future_status::ready);
+    REQUIRE_THROWS_WITH(again->get(), "missing equity column");
+    REQUIRE(failures == 1);
+    REQUIRE(service.CacheSize() == 0);
+
+    TearSheetService retrying{
+        {.workers = 1, .failureTtl = std::chrono::milliseconds{0}}, failing};
+    REQUIRE_THROWS(retrying.Build(MakeRequest(path)).get());
+    REQUIRE_THROWS(retrying.Build(MakeRequest(path)).get());
+    REQUIRE(failures == 3);
+  }
+
+  std::filesystem::remove(path);
+}
@@ -1,11 +1,19 @@
 //
 // Created by adesola on 3/29/25.
 //
+#include "common/memory_tracker.h"
 #include "common_utils.h"
+#include "epoch_folio/batch_runner.h"
 #include "epoch_folio/tearsheet.h"
+#include "epoch_folio/tearsheet_cache.h"
+#include <algorithm>
+#include <arrow/util/byte_size.h>
 #include <catch.hpp>
 #include <epoch_frame/serialization.h>
 #include <filesystem>
+#include <fstream>
+#include <google/protobuf/util/message_differencer.h>
+#include <thread>
 
 TEST_CASE("Tearsheet") {
     using namespace epoch_folio;
@@ -86,6 +94,209 @@ TEST_CASE("Tearsheet") {
     std::filesystem::create_directories(output_dir);
 
     write_protobuf(test_result, output_dir + "/full_test_result.pb");
+
+    SECTION("Append matches a build over the full history") {
+      // the last 20 bars of returns and benchmark arrive as an append
+      const auto tail = 20;
+      auto head = [&](epoch_frame::Series const &series) {
+        return series.iloc({0, static_cast<int64_t>(series.size()) - tail});
+      };
+      auto last = [&](epoch_frame::Series const &series) {
+        return series.iloc(
+            {.start = static_cast<int64_t>(series.size()) - tail});
+      };
+
+      PortfolioTearSheetFactory appended{TearSheetDataOption{
+          head(test_returns), head(test_factor), cash, test_pos, test_txn,
+          round_trip, sector, false}};
+      (void)appended.MakeTearSheet(TearSheetOption{});
+
+      TearSheetDataOption delta;
+      delta.equity = last(test_returns);
+      delta.benchmark = last(test_factor);
+      appended.Append(delta);
+
+      REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+          appended.MakeTearSheet(TearSheetOption{}), test_result));
+    }
+
+    SECTION("Async builds run on the factory's arena") {
+      PortfolioTearSheetFactory factory{TearSheetDataOption{
+          test_returns, test_factor, cash, test_pos, test_txn, round_trip,
+          sector, false}};
+      CancellationToken cancelled;
+      cancelled.Cancel();
+      auto stopped = factory.MakeTearSheetAsync(TearSheetOption{}, cancelled);
+      std::vector<std::future<epoch_proto::TearSheet>> builds;
+      for (int i = 0; i < 4; ++i) {
+        builds.push_back(factory.MakeTearSheetAsync(TearSheetOption{}));
+      }
+      // dropped futures do not block
+      (void)factory.MakeTearSheetAsync(TearSheetOption{});
+
+      REQUIRE_THROWS_AS(stopped.get(), BuildCancelled);
+      for (auto &build : builds) {
+        REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+            build.get(), test_result));
+      }
+    }
+
+    SECTION("Append waits for async builds in flight") {
+      const auto tail = 20;
+      const TearSheetDataOption head{
+          test_returns.iloc(
+              {0, static_cast<int64_t>(test_returns.size()) - tail}),
+          test_factor.iloc(
+              {0, static_cast<int64_t>(test_factor.size()) - tail}),
+          cash, test_pos, test_txn, round_trip, sector, false};
+      const auto expected =
+          PortfolioTearSheetFactory{head}.MakeTearSheet(TearSheetOption{});
+
+      PortfolioTearSheetFactory factory{head};
+      // slow widgets keep the builds running while Append is called
+      auto slow = [](std::string const &, std::string const &,
+                     WidgetList const &) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      };
+      std::vector<std::future<epoch_proto::TearSheet>> builds;
+      for (int i = 0; i < 3; ++i) {
+        builds.push_back(factory.MakeTearSheetAsync(TearSheetOption{}, {},
+                                                    std::nullopt, slow));
+      }
+
+      TearSheetDataOption delta;
+      delta.equity = test_returns.iloc(
+          {.start = static_cast<int64_t>(test_returns.size()) - tail});
+      delta.benchmark = test_factor.iloc(
+          {.start = static_cast<int64_t>(test_factor.size()) - tail});
+      factory.Append(delta);
+
+      // every build finished over the inputs it was queued with
+      for (auto &build : builds) {
+        REQUIRE(build.wait_for(std::chrono::seconds{0}) ==
+                std::future_status::ready);
+        REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+            build.get(), expected));
+      }
+      REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+          factory.MakeTearSheet(TearSheetOption{}), test_result));
+    }
+
+    SECTION("A memory budget spills the largest input to a mapped file") {
+      auto bytes = [](epoch_frame::DataFrame const &frame) {
+        return static_cast<uint64_t>(
+            arrow::util::TotalBufferSize(*frame.table()) +
+            arrow::util::TotalBufferSize(*frame.index()->as_chunked_array()));
+      };
+      const std::vector<std::pair<uint8_t, uint64_t>> inputs{
+          {widget_inputs::Positions, bytes(test_pos)},
+          {widget_inputs::Transactions, bytes(test_txn)},
+          {widget_inputs::RoundTrips, bytes(round_trip)}};
+      const auto largest = std::ranges::max(inputs, {}, [](auto const &input) {
+                             return input.second;
+                           }).first;
+      uint64_t total = 0;
+      for (auto const &input : inputs) {
+        total += input.second;
+      }
+      // half of the budget is just under the inputs, so only the largest
+      // has to go
+      MemoryBudget budget{.bytes = 2 * total - 2};
+
+      PortfolioTearSheetFactory factory{TearSheetDataOption{
+          test_returns, test_factor, cash, test_pos, test_txn, round_trip,
+          sector, false}};
+      factory.UseMemoryBudget(budget);
+      REQUIRE((factory.SpilledInputs() & largest) != 0);
+
+      // the spill file is unlinked, its mapping stays until the factory goes
+      std::ifstream maps{"/proc/self/maps"};
+      bool mapped = false;
+      for (std::string line; std::getline(maps, line);) {
+        mapped = mapped || line.contains("epoch_folio_spill_");
+      }
+      REQUIRE(mapped);
+
+      // a build over the mapped inputs matches an unbounded one
+      REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+          factory.MakeTearSheet(TearSheetOption{}), test_result));
+    }
+
+    SECTION("Stored intermediates match a fresh build") {
+      const auto dir = std::filesystem::temp_directory_path() /
+                       "epoch_folio_intermediates";
+      std::filesystem::remove_all(dir);
+      const TearSheetDataOption data{test_returns, test_factor, cash,
+                                     test_pos,     test_txn,    round_trip,
+                                     sector,       false};
+
+      PortfolioTearSheetFactory first{data};
+      first.UseDiskCache(std::make_shared<TearSheetDiskCache>(dir.string()));
+      (void)first.MakeTearSheet(TearSheetOption{});
+      auto frames = 0;
+      for (auto const &entry : std::filesystem::directory_iterator{dir}) {
+        frames += entry.path().extension() == ".arrow";
+      }
+      // drawdowns, rolling volatility and sharpe, round trips
+      REQUIRE(frames == 4);
+
+      // other chart options miss the widgets but read the intermediates
+      TearSheetOption downsampled;
+      downsampled.maxChartPoints = 200;
+      PortfolioTearSheetFactory second{data};
+      second.UseDiskCache(std::make_shared<TearSheetDiskCache>(dir.string()));
+      REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+          second.MakeTearSheet(downsampled),
+          PortfolioTearSheetFactory{data}.MakeTearSheet(downsampled)));
+      std::filesystem::remove_all(dir);
+    }
+
+    SECTION("Concurrent builds share one memory tracker") {
+      BatchTearSheetOption batchOptions{.maxConcurrency = 4};
+      batchOptions.tearSheet.memoryTracker =
+          std::make_shared<TrackingMemoryPool>();
+      const std::vector<TearSheetDataOption> strategies(
+          4, TearSheetDataOption{test_returns, test_factor, cash, test_pos,
+                                 test_txn, round_trip, sector, false});
+
+      std::vector<bool> built(strategies.size(), false);
+      BatchTearSheetRunner{test_factor, batchOptions}.Run(
+          strategies, [&](size_t i, epoch_proto::TearSheet &&tearSheet) {
+            // the memory table follows the dashboard
+            built[i] = tearSheet.tables().tables_size() ==
+                       test_result.tables().tables_size() + 1;
+          });
+      REQUIRE(std::ranges::all_of(built, [](bool ok) { return ok; }));
+      REQUIRE_FALSE(batchOptions.tearSheet.memoryTracker->Report().empty());
+      REQUIRE(CurrentMemoryPool() == arrow::default_memory_pool());
+    }
+
+    SECTION("Batch matches standalone builds") {
+      // two strategies share the full index, the third one is shorter
+      auto strategy = [&](epoch_frame::Series const &returns) {
+        return TearSheetDataOption{returns,  test_factor, cash,   test_pos,
+                                   test_txn, round_trip,  sector, false};
+      };
+      const std::vector<TearSheetDataOption> strategies{
+          strategy(test_returns),
+          strategy(epoch_frame::Scalar{0.5} * test_returns),
+          strategy(test_returns.iloc(
+              {0, static_cast<int64_t>(test_returns.size()) - 20}))};
+
+      std::vector<epoch_proto::TearSheet> batch(strategies.size());
+      BatchTearSheetRunner{test_factor, {}}.Run(
+          strategies, [&](size_t i, epoch_proto::TearSheet &&tearSheet) {
+            batch[i].CopyFrom(tearSheet);
+          });
+
+      REQUIRE(google::protobuf::util::MessageDifferencer::Equals(batch[0],
+                                                                 test_result));
+      for (size_t i = 1; i < strategies.size(); ++i) {
+        REQUIRE(google::protobuf::util::MessageDifferencer::Equals(
+            batch[i], PortfolioTearSheetFactory{strategies[i]}.MakeTearSheet(
+                          TearSheetOption{})));
+      }
+    }
 }
 
 TEST_CASE("Tearsheet without benchmark") {
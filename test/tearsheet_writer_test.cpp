@@ -0,0 +1,142 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "epoch_folio/tearsheet_writer.h"
+#include <catch.hpp>
+#include <epoch_frame/factory/dataframe_factory.h>
+#include <epoch_frame/factory/date_offset_factory.h>
+#include <epoch_frame/factory/index_factory.h>
+#include <epoch_frame/factory/scalar_factory.h>
+#include <epoch_frame/factory/series_factory.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace epoch_folio;
+using epoch_core::TearSheetCompression;
+
+namespace {
+epoch_proto::TearSheet MakeSheet(int tables) {
+  epoch_proto::TearSheet sheet;
+  for (int i = 0; i < tables; ++i) {
+    sheet.mutable_tables()->add_tables();
+  }
+  sheet.mutable_charts()->add_charts();
+  return sheet;
+}
+} // namespace
+
+TEST_CASE("Tear Sheet Writer") {
+  const auto dir = std::filesystem::temp_directory_path();
+
+  for (auto compression :
+       {TearSheetCompression::None, TearSheetCompression::Gzip}) {
+    DYNAMIC_SECTION("compression " << static_cast<int>(compression)) {
+      const auto single = (dir / "epoch_folio_single.pb").string();
+      WriteTearSheet(MakeSheet(3), single, compression);
+      epoch_proto::TearSheet read;
+      ReadTearSheet(single, read, compression);
+      REQUIRE(read.tables().tables_size() == 3);
+
+      const auto path = (dir / "epoch_folio_container.efts").string();
+      std::filesystem::remove(path);
+      std::vector<uint64_t> offsets;
+      {
+        TearSheetContainerWriter writer{path, compression};
+        offsets.push_back(writer.Append(MakeSheet(1)));
+        offsets.push_back(writer.Append(epoch_proto::TearSheet{}));
+      }
+      {
+        // reopening appends after the existing records
+        TearSheetContainerWriter writer{path, compression};
+        offsets.push_back(writer.Append(MakeSheet(5)));
+      }
+
+      TearSheetContainerReader reader{path};
+      REQUIRE(reader.size() == 3);
+      REQUIRE(reader.Offsets() == offsets);
+      REQUIRE(reader.Read(0).tables().tables_size() == 1);
+      REQUIRE(reader.Read(1).tables().tables_size() == 0);
+
+      epoch_proto::TearSheet last;
+      reader.ReadAt(offsets[2], last);
+      REQUIRE(last.tables().tables_size() == 5);
+      REQUIRE(last.charts().charts_size() == 1);
+
+      auto other = compression == TearSheetCompression::None
+                       ? TearSheetCompression::Gzip
+                       : TearSheetCompression::None;
+      REQUIRE_THROWS(TearSheetContainerWriter{path, other});
+    }
+  }
+
+  SECTION("A torn record is ignored and overwritten") {
+    const auto path = (dir / "epoch_folio_torn.efts").string();
+    std::filesystem::remove(path);
+    {
+      TearSheetContainerWriter writer{path};
+      writer.Append(MakeSheet(2));
+    }
+    const auto complete = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, complete + 5);
+    REQUIRE(TearSheetContainerReader{path}.size() == 1);
+
+    {
+      // reopening drops the torn bytes before anything is appended
+      TearSheetContainerWriter writer{path};
+      REQUIRE(std::filesystem::file_size(path) == complete);
+      writer.Append(MakeSheet(4));
+    }
+    TearSheetContainerReader reader{path};
+    REQUIRE(reader.size() == 2);
+    REQUIRE(reader.Read(1).tables().tables_size() == 4);
+  }
+
+  SECTION("An unknown compression is rejected") {
+    const auto path = (dir / "epoch_folio_unknown.efts").string();
+    std::filesystem::remove(path);
+    {
+      TearSheetContainerWriter writer{path};
+      writer.Append(MakeSheet(1));
+    }
+    {
+      // the compression is the last byte of the 6 byte header
+      std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+      file.seekp(5);
+      file.put(char{0x7F});
+    }
+    REQUIRE_THROWS_AS(TearSheetContainerReader{path}, std::runtime_error);
+    REQUIRE_THROWS_AS(TearSheetContainerWriter{path}, std::runtime_error);
+  }
+}
+
+TEST_CASE("Widget Series IPC") {
+  using namespace epoch_frame;
+  using namespace epoch_frame::factory::scalar;
+  const auto path =
+      (std::filesystem::temp_directory_path() / "epoch_folio_series.arrow")
+          .string();
+
+  auto index = factory::index::date_range({.start = "2020-01-01"_date,
+                                           .periods = 4,
+                                           .offset = factory::offset::days(1)});
+  auto data = make_dataframe(
+      index,
+      std::vector{factory::array::make_array(
+                      std::vector<double>{1.0, 1.1, 1.2, 1.3}),
+                  factory::array::make_array(
+                      std::vector<double>{1.0, 0.9, 1.0, 1.1})},
+      {"Strategy", "Benchmark"});
+  WriteWidgetSeries({"cumReturns", "Strategy Benchmark", data}, path);
+
+  auto table = MapWidgetSeries(path);
+  REQUIRE(table->num_rows() == 4);
+  REQUIRE(table->ColumnNames() ==
+          std::vector<std::string>{"index", "Strategy", "Benchmark"});
+  REQUIRE(table->schema()->metadata()->Get("widget_id").ValueOrDie() ==
+          "cumReturns");
+  REQUIRE(table->column(0)->type()->id() == arrow::Type::TIMESTAMP);
+
+  auto strategy =
+      std::static_pointer_cast<arrow::DoubleArray>(table->column(1)->chunk(0));
+  REQUIRE(strategy->Value(3) == 1.3);
+}
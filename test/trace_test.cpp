@@ -0,0 +1,55 @@
+//
+// Created by adesola on 10/18/26.
+//
+#include "common/trace.h"
+#include <catch.hpp>
+#include <thread>
+
+using namespace epoch_folio;
+
+TEST_CASE("Trace Spans") {
+  trace::Drain();
+
+  SECTION("Disabled spans record nothing") {
+    trace::Enable(false);
+    { EPOCH_FOLIO_TRACE("ignored"); }
+    REQUIRE(trace::Drain().empty());
+  }
+
+  SECTION("Spans from every thread are drained in start order") {
+    trace::Enable();
+    {
+      trace::Span outer{"outer", "widget"};
+      outer.SetRows(42);
+      std::thread{[] { EPOCH_FOLIO_TRACE("worker"); }}.join();
+    }
+    trace::Enable(false);
+
+    const auto records = trace::Drain();
+    REQUIRE(records.size() == 2);
+    REQUIRE(records[0].name == "outer");
+    REQUIRE(records[0].category == "widget");
+    REQUIRE(records[0].rows == 42);
+    REQUIRE(records[1].name == "worker");
+    REQUIRE(records[1].rows == -1);
+    REQUIRE(records[0].threadId != records[1].threadId);
+    REQUIRE(records[0].wallNs >= records[1].wallNs);
+    REQUIRE(trace::Drain().empty());
+  }
+
+  SECTION("Chrome trace export") {
+    trace::SpanRecord record{.name = R"(say "hi")",
+                             .category = "folio",
+                             .startNs = 1500,
+                             .wallNs = 2000,
+                             .threadId = 3,
+                             .rows = 7};
+    const auto json = trace::ToChromeTrace({record});
+    REQUIRE(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+    REQUIRE(json.find(R"("name":"say \"hi\"")") != std::string::npos);
+    REQUIRE(json.find(R"("ph":"X","pid":1,"tid":3,"ts":1.500)") !=
+            std::string::npos);
+    REQUIRE(json.find(R"("rows":7)") != std::string::npos);
+    REQUIRE(trace::ToChromeTrace({}).ends_with("[]}"));
+  }
+}